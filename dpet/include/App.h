@@ -3,6 +3,10 @@
 #include <SDL.h>
 #include <memory>
 #include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <vector>
 #include "Utils.h"
 #include "Managers.h"
 
@@ -17,6 +21,10 @@ namespace DesktopPet {
  * - Audio Thread (Sensors): ASR/TTS
  * 
  * Communication via ThreadSafeQueue<AppEvent>
+ *
+ * Init only opens the window and loads scripts; the ASR stack and the LLM
+ * load on two loader threads while the pet is already on screen. Input that
+ * needs a model is queued and replayed once it is ready.
  */
 class App {
 public:
@@ -28,7 +36,21 @@ public:
     App& operator=(const App&) = delete;
     
     /**
-     * @brief Initialize the application
+     * @brief Choose the capture source (microphone by default); call before Init
+     */
+    void SetAudioSource(const AudioSourceConfig& config) { audioSource_ = config; }
+    
+    /**
+     * @brief ASR config file (default config/asr.ini) and the backend to use
+     *        from it (empty = the file's "backend"); call before Init
+     */
+    void SetAsrConfig(const std::string& path, const std::string& backend) {
+        asrConfigPath_ = path;
+        asrBackend_ = backend;
+    }
+    
+    /**
+     * @brief Open the window and start loading the models in the background
      */
     bool Init();
     
@@ -73,6 +95,43 @@ private:
      */
     void Cleanup();
     
+    enum class LoadState { Loading, Ready, Failed };
+    
+    /**
+     * @brief Loader threads: ASR, wake word, TTS and effects / the LLM
+     */
+    void LoadAudio(AsrConfig asrConfig);
+    void LoadLLM(std::string modelPath);
+    
+    /**
+     * @brief Start the audio and AI threads once their models are loaded (main thread, every frame)
+     */
+    void PollLoading();
+    
+    /**
+     * @brief Send a prompt to the AI thread, or hold it until the LLM is ready
+     */
+    void SubmitToAI(const std::string& prompt);
+    
+    /**
+     * @brief Show what is still loading in the pet's bubble
+     */
+    void ShowLoadingStatus();
+    
+    /**
+     * @brief Record a startup phase that began at startMs and ends now
+     */
+    void MarkPhase(const std::string& name, const std::string& thread, double startMs);
+    double StartupMs() const;
+    void PrintStartupTimeline();
+    
+    struct StartupPhase {
+        std::string name;
+        std::string thread;
+        double startMs;
+        double endMs;
+    };
+    
     // SDL resources
     SDL_Window* window_ = nullptr;
     SDL_Renderer* renderer_ = nullptr;
@@ -88,6 +147,25 @@ private:
     
     // Application state
     std::atomic<bool> running_{false};
+    AudioSourceConfig audioSource_;
+    std::string asrConfigPath_ = "config/asr.ini";
+    std::string asrBackend_;
+    
+    // Background model loading
+    std::thread audioLoader_;
+    std::thread llmLoader_;
+    std::atomic<LoadState> audioState_{LoadState::Loading};
+    std::atomic<LoadState> llmState_{LoadState::Loading};
+    bool audioStarted_ = false;                // Main thread only, like the pending lists
+    bool aiStarted_ = false;
+    std::vector<std::string> pendingPrompts_;  // Asked before the LLM was ready
+    std::vector<std::string> pendingSpeech_;   // Lines to speak once TTS is up
+    
+    // Startup timeline
+    std::chrono::steady_clock::time_point startupBegin_;
+    std::vector<StartupPhase> startupPhases_;
+    std::mutex startupMutex_;
+    bool firstFrameDrawn_ = false;
     
     // Window properties
     int windowWidth_ = 500;
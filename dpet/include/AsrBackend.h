@@ -0,0 +1,159 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// Forward declarations for sherpa-onnx ASR
+struct SherpaOnnxOfflineRecognizer;
+struct SherpaOnnxOfflineStream;
+struct SherpaOnnxOnlineRecognizer;
+
+namespace DesktopPet {
+
+enum class AsrBackendType {
+    SenseVoice,
+    Paraformer,
+    Whisper,
+    Moonshine,
+    Zipformer,            // Offline transducer
+    StreamingZipformer,   // Online transducer
+    StreamingParaformer
+};
+
+/**
+ * @brief Registry entry: the name used in config files and what modelDir holds
+ */
+struct AsrBackendInfo {
+    AsrBackendType type;
+    const char* name;
+    const char* files;
+    bool streaming;
+};
+
+/**
+ * @brief All backends AsrEngine can load
+ */
+const std::vector<AsrBackendInfo>& AsrBackends();
+
+/**
+ * @return The backend registered under name, or nullptr
+ */
+const AsrBackendInfo* FindAsrBackend(const std::string& name);
+const AsrBackendInfo& GetAsrBackend(AsrBackendType type);
+
+/**
+ * @brief Speech recognizer settings
+ *
+ * Files are looked up in modelDir using the names of the sherpa-onnx
+ * release archives; with int8 set, *.int8.onnx is taken when both ship.
+ */
+struct AsrConfig {
+    std::string name = "sense_voice";  // Config-file section, for logs and benchmarks
+    AsrBackendType type = AsrBackendType::SenseVoice;
+    std::string modelDir;
+    int numThreads = 2;                // Intra-op threads per decode
+    std::string provider = "cpu";      // cpu, cuda, coreml, ...
+    std::string language = "auto";     // SenseVoice and Whisper
+    bool int8 = false;
+    std::string decodingMethod = "greedy_search";
+    int sampleRate = 16000;
+    bool debug = false;
+};
+
+/**
+ * @brief The backends listed in an ASR config file
+ *
+ * INI format: a top-level "backend = <section>" picks the one to use;
+ * each [section] sets type (a registry name, defaults to the section
+ * name), model_dir, num_threads, provider, language, int8 and
+ * decoding_method. One backend type can appear in several sections with
+ * different settings. A relative model_dir is taken from the file's
+ * directory.
+ */
+struct AsrConfigFile {
+    std::string active;
+    std::vector<AsrConfig> backends;
+
+    const AsrConfig* Find(const std::string& name) const;
+    const AsrConfig* Active() const { return Find(active); }
+};
+
+/**
+ * @brief Parse an ASR config file; unknown keys and backend types are errors
+ */
+bool LoadAsrConfigFile(const std::string& path, AsrConfigFile& file);
+
+/**
+ * @brief Mono audio at AsrConfig::sampleRate, decoded as one stream
+ */
+struct AsrInput {
+    const float* samples;
+    size_t count;
+};
+
+/**
+ * @class AsrEngine
+ * @brief sherpa-onnx speech recognizer for any registered backend
+ *
+ * Offline backends decode each input as an offline stream. Streaming
+ * backends are fed the whole input at once and decoded until the stream
+ * is drained, so both kinds take the same finished recordings.
+ *
+ * Not thread-safe: call from one thread (the audio worker); Transcribe
+ * runs its own workers.
+ */
+class AsrEngine {
+public:
+    AsrEngine() = default;
+    ~AsrEngine();
+
+    // Disable copy
+    AsrEngine(const AsrEngine&) = delete;
+    AsrEngine& operator=(const AsrEngine&) = delete;
+
+    /**
+     * @brief Load the model
+     */
+    bool Init(const AsrConfig& config);
+
+    /**
+     * @brief Decode each input as its own stream
+     * @param texts Receives one transcript per input
+     * @param workers Streams decoded concurrently, each on numThreads
+     *        intra-op threads; 0 decodes them all in one batched call
+     */
+    bool Transcribe(const std::vector<AsrInput>& inputs, std::vector<std::string>& texts, size_t workers = 1);
+
+    /**
+     * @brief Create offline streams ahead of the next Transcribe
+     *
+     * A sherpa-onnx offline stream accepts one waveform, so streams can't
+     * be reset and reused; making them early keeps that off the critical
+     * path. Online streams are cheap and made per call.
+     */
+    void PrepareStreams(size_t count);
+
+    /**
+     * @brief Workers for decoding streams concurrently without oversubscribing the cores
+     */
+    size_t ConcurrentWorkers(size_t streams) const;
+
+    bool IsReady() const { return offline_ != nullptr || online_ != nullptr; }
+    bool IsStreaming() const { return online_ != nullptr; }
+    const AsrConfig& GetConfig() const { return config_; }
+
+private:
+    bool InitOffline();
+    bool InitOnline();
+    bool TranscribeOffline(const std::vector<AsrInput>& inputs, std::vector<std::string>& texts, size_t workers);
+    bool TranscribeOnline(const std::vector<AsrInput>& inputs, std::vector<std::string>& texts, size_t workers);
+    const SherpaOnnxOfflineStream* TakeStream();
+
+    const SherpaOnnxOfflineRecognizer* offline_ = nullptr;
+    const SherpaOnnxOnlineRecognizer* online_ = nullptr;
+    std::vector<const SherpaOnnxOfflineStream*> spareStreams_;
+    AsrConfig config_;
+};
+
+} // namespace DesktopPet
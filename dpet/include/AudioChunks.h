@@ -0,0 +1,297 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include "AudioDsp.h"
+
+namespace DesktopPet {
+
+/**
+ * @brief How pool chunks store samples
+ */
+enum class SampleEncoding {
+    Float32,     // As captured
+    Int16,       // Linear 16-bit PCM, half the memory
+    Companded16  // Square-root companded 16-bit (Dsp::CompandToInt16), finer steps for quiet speech
+};
+
+inline const char* SampleEncodingName(SampleEncoding encoding) {
+    switch (encoding) {
+        case SampleEncoding::Int16: return "int16";
+        case SampleEncoding::Companded16: return "companded16";
+        default: return "float32";
+    }
+}
+
+/**
+ * @class AudioChunkPool
+ * @brief Fixed set of equally sized sample chunks, allocated once
+ *
+ * Chunks are linked into utterances by index (see PooledAudio) and carry a
+ * reference count; a chunk goes back to the free list when its last view
+ * lets go. Acquire/Release never allocate but take a short lock, so chunks
+ * are taken off the realtime thread: the audio worker appends what the
+ * capture callback left in its ring. Samples are stored in the pool's
+ * SampleEncoding; PooledAudio converts on Append and CopyTo.
+ */
+class AudioChunkPool {
+public:
+    static constexpr size_t kChunkSamples = 4096;  // 256 ms at 16 kHz
+    static constexpr int32_t kNoChunk = -1;
+
+    explicit AudioChunkPool(size_t chunkCount, SampleEncoding encoding = SampleEncoding::Float32)
+        : encoding_(encoding), next_(chunkCount, kNoChunk), refs_(chunkCount) {
+        if (encoding_ == SampleEncoding::Float32) {
+            floats_.resize(chunkCount * kChunkSamples);
+        } else {
+            shorts_.resize(chunkCount * kChunkSamples);
+        }
+        free_.reserve(chunkCount);
+        for (size_t i = chunkCount; i > 0; --i) {
+            free_.push_back(static_cast<int32_t>(i - 1));
+        }
+    }
+
+    // Disable copy
+    AudioChunkPool(const AudioChunkPool&) = delete;
+    AudioChunkPool& operator=(const AudioChunkPool&) = delete;
+
+    /**
+     * @return A chunk with one reference, or kNoChunk when the pool is exhausted
+     */
+    int32_t Acquire() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_.empty()) {
+            ++exhausted_;
+            return kNoChunk;
+        }
+        int32_t chunk = free_.back();
+        free_.pop_back();
+        next_[chunk] = kNoChunk;
+        refs_[chunk].store(1, std::memory_order_relaxed);
+        return chunk;
+    }
+
+    void AddRef(int32_t chunk) {
+        refs_[chunk].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Release(int32_t chunk) {
+        if (refs_[chunk].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_.push_back(chunk);
+        }
+    }
+
+    /**
+     * @brief Store count samples at offset within a chunk, converting to the pool's encoding
+     */
+    void Write(int32_t chunk, size_t offset, const float* data, size_t count) {
+        size_t start = static_cast<size_t>(chunk) * kChunkSamples + offset;
+        switch (encoding_) {
+            case SampleEncoding::Float32: std::copy(data, data + count, &floats_[start]); break;
+            case SampleEncoding::Int16: Dsp::FloatToInt16(data, &shorts_[start], count); break;
+            case SampleEncoding::Companded16: Dsp::CompandToInt16(data, &shorts_[start], count); break;
+        }
+    }
+
+    /**
+     * @brief Read count samples at offset within a chunk as float
+     */
+    void Read(int32_t chunk, size_t offset, size_t count, float* out) const {
+        size_t start = static_cast<size_t>(chunk) * kChunkSamples + offset;
+        switch (encoding_) {
+            case SampleEncoding::Float32: std::copy(&floats_[start], &floats_[start] + count, out); break;
+            case SampleEncoding::Int16: Dsp::Int16ToFloat(&shorts_[start], out, count); break;
+            case SampleEncoding::Companded16: Dsp::ExpandInt16(&shorts_[start], out, count); break;
+        }
+    }
+
+    int32_t Next(int32_t chunk) const { return next_[chunk]; }
+    void Link(int32_t chunk, int32_t next) { next_[chunk] = next; }
+    bool IsShared(int32_t chunk) const { return refs_[chunk].load(std::memory_order_relaxed) > 1; }
+
+    SampleEncoding Encoding() const { return encoding_; }
+    size_t ChunkCount() const { return next_.size(); }
+    size_t StorageBytes() const { return floats_.size() * sizeof(float) + shorts_.size() * sizeof(int16_t); }
+    size_t FreeCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return free_.size();
+    }
+    /**
+     * @brief Number of times Acquire() found no free chunk
+     */
+    size_t ExhaustedCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return exhausted_;
+    }
+
+private:
+    SampleEncoding encoding_;
+    std::vector<float> floats_;    // Float32 storage
+    std::vector<int16_t> shorts_;  // 16-bit storage
+    std::vector<int32_t> next_;
+    std::vector<std::atomic<int32_t>> refs_;
+    std::vector<int32_t> free_;
+    size_t exhausted_ = 0;
+    mutable std::mutex mutex_;
+};
+
+/**
+ * @class PooledAudio
+ * @brief Move-only view of samples stored in pool chunks
+ *
+ * The owner appends; handing the audio on is a move, so samples are never
+ * copied between capture and their consumer. With a 16-bit pool, samples
+ * are converted once on Append and back to float on CopyTo, where a
+ * consumer needs them (ASR, echo cancellation). Share() makes a second view of
+ * the same chunks (for another reader); appending to a shared view is not
+ * allowed. A moved-from view is empty but stays attached to its pool.
+ */
+class PooledAudio {
+public:
+    PooledAudio() = default;
+    explicit PooledAudio(AudioChunkPool* pool) : pool_(pool) {}
+    ~PooledAudio() { Clear(); }
+
+    PooledAudio(PooledAudio&& other) noexcept
+        : pool_(other.pool_), head_(other.head_), tail_(other.tail_), size_(other.size_) {
+        other.Detach();
+    }
+    PooledAudio& operator=(PooledAudio&& other) noexcept {
+        if (this != &other) {
+            Clear();
+            pool_ = other.pool_;
+            head_ = other.head_;
+            tail_ = other.tail_;
+            size_ = other.size_;
+            other.Detach();
+        }
+        return *this;
+    }
+
+    // Disable copy
+    PooledAudio(const PooledAudio&) = delete;
+    PooledAudio& operator=(const PooledAudio&) = delete;
+
+    size_t Size() const { return size_; }
+    bool Empty() const { return size_ == 0; }
+
+    /**
+     * @brief Append samples, taking chunks from the pool as needed
+     * @return Samples appended; fewer than count when the pool is exhausted
+     */
+    size_t Append(const float* data, size_t count) {
+        if (!pool_) {
+            return 0;
+        }
+        size_t appended = 0;
+        while (appended < count) {
+            size_t offset = size_ % AudioChunkPool::kChunkSamples;
+            if (offset == 0) {
+                int32_t chunk = pool_->Acquire();
+                if (chunk == AudioChunkPool::kNoChunk) {
+                    break;
+                }
+                if (tail_ == AudioChunkPool::kNoChunk) {
+                    head_ = chunk;
+                } else {
+                    pool_->Link(tail_, chunk);
+                }
+                tail_ = chunk;
+            }
+            assert(!pool_->IsShared(tail_));
+            size_t n = std::min(count - appended, AudioChunkPool::kChunkSamples - offset);
+            pool_->Write(tail_, offset, data + appended, n);
+            appended += n;
+            size_ += n;
+        }
+        return appended;
+    }
+
+    /**
+     * @brief Copy [begin, begin + count) to out as float
+     * @return Samples copied
+     *
+     * Safe while the owner appends past the range, as long as the size was
+     * read under the same lock as the appends.
+     */
+    size_t CopyTo(size_t begin, size_t count, float* out) const {
+        size_t copied = 0;
+        ForEachSpan(begin, begin + count, [&](int32_t chunk, size_t offset, size_t n) {
+            pool_->Read(chunk, offset, n, out + copied);
+            copied += n;
+        });
+        return copied;
+    }
+
+    /**
+     * @brief Another view of the same samples (no copy)
+     */
+    PooledAudio Share() const {
+        PooledAudio view(pool_);
+        for (int32_t chunk = head_; chunk != AudioChunkPool::kNoChunk; chunk = pool_->Next(chunk)) {
+            pool_->AddRef(chunk);
+        }
+        view.head_ = head_;
+        view.tail_ = tail_;
+        view.size_ = size_;
+        return view;
+    }
+
+    /**
+     * @brief Drop this view's references; chunks with no other view return to the pool
+     */
+    void Clear() {
+        int32_t chunk = head_;
+        while (chunk != AudioChunkPool::kNoChunk) {
+            // Read the link first: the chunk may be reused once released
+            int32_t next = chunk == tail_ ? AudioChunkPool::kNoChunk : pool_->Next(chunk);
+            pool_->Release(chunk);
+            chunk = next;
+        }
+        head_ = tail_ = AudioChunkPool::kNoChunk;
+        size_ = 0;
+    }
+
+private:
+    /**
+     * @brief Call fn(chunk, offsetInChunk, count) for each contiguous run in [begin, end)
+     */
+    template<typename Fn>
+    void ForEachSpan(size_t begin, size_t end, Fn&& fn) const {
+        end = std::min(end, size_);
+        int32_t chunk = head_;
+        size_t chunkStart = 0;
+        while (chunk != AudioChunkPool::kNoChunk && chunkStart < end) {
+            size_t chunkEnd = chunkStart + AudioChunkPool::kChunkSamples;
+            if (chunkEnd > begin) {
+                size_t from = std::max(begin, chunkStart);
+                size_t to = std::min(end, chunkEnd);
+                fn(chunk, from - chunkStart, to - from);
+            }
+            if (chunkEnd >= end) {
+                break;  // Don't follow a link the owner may be writing
+            }
+            chunk = pool_->Next(chunk);
+            chunkStart = chunkEnd;
+        }
+    }
+
+    void Detach() {
+        head_ = tail_ = AudioChunkPool::kNoChunk;
+        size_ = 0;
+    }
+
+    AudioChunkPool* pool_ = nullptr;
+    int32_t head_ = AudioChunkPool::kNoChunk;
+    int32_t tail_ = AudioChunkPool::kNoChunk;
+    size_t size_ = 0;
+};
+
+} // namespace DesktopPet
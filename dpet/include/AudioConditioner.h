@@ -0,0 +1,113 @@
+#pragma once
+
+#include "AudioDsp.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace DesktopPet {
+
+/**
+ * @brief Which conditioning stages run, and their targets
+ */
+struct ConditionerConfig {
+    bool highPass = true;
+    float highPassHz = 80.0f;
+    bool noiseSuppression = true;
+    float maxSuppressionDb = 15.0f;   // Attenuation limit per bin, keeps speech natural
+    bool autoGain = true;
+    float targetDbfs = -20.0f;        // Speech level the AGC aims for
+    float maxGainDb = 24.0f;
+};
+
+/**
+ * @class AudioConditioner
+ * @brief Cleans up microphone audio before ASR
+ *
+ * Block-based chain: high-pass (removes DC and rumble), spectral noise
+ * suppression (Wiener gain over a tracked noise floor, 512-point STFT with
+ * 50% overlap) and automatic gain control. The FFT, windowing, gain and
+ * level kernels are the vectorized ones from Dsp; the biquad is a scalar
+ * recursion. Output is delayed by Latency() samples.
+ *
+ * Not thread-safe: call from one thread (the audio worker).
+ */
+class AudioConditioner {
+public:
+    struct Stats {
+        uint64_t blocks = 0;
+        double avgBlockUs = 0.0;
+        double maxBlockUs = 0.0;
+        double blockMs = 0.0;           // Audio per block, the realtime budget
+        float gainDb = 0.0f;            // Current AGC gain
+        float avgSuppressionDb = 0.0f;  // Mean attenuation over all bins and frames
+    };
+
+    explicit AudioConditioner(int sampleRate, const ConditionerConfig& config = ConditionerConfig());
+
+    // Disable copy
+    AudioConditioner(const AudioConditioner&) = delete;
+    AudioConditioner& operator=(const AudioConditioner&) = delete;
+
+    /**
+     * @brief Condition count samples; out may alias in
+     */
+    void Process(const float* in, float* out, size_t count);
+
+    /**
+     * @brief Clear filter and noise state; the AGC gain is kept between utterances
+     */
+    void Reset();
+
+    size_t BlockSize() const { return hop_; }
+    size_t Latency() const { return config_.noiseSuppression ? 2 * hop_ : hop_; }
+    const ConditionerConfig& Config() const { return config_; }
+    Stats GetStats() const;
+
+private:
+    void ProcessBlock();
+    void SuppressNoise();
+    void ApplyGain(float* block);
+
+    int sampleRate_;
+    ConditionerConfig config_;
+    size_t fftSize_;
+    size_t hop_;
+
+    // High-pass biquad (transposed direct form II)
+    float b0_ = 1.0f, b1_ = 0.0f, b2_ = 0.0f, a1_ = 0.0f, a2_ = 0.0f;
+    float z1_ = 0.0f, z2_ = 0.0f;
+
+    // Blocks: input collects hop_ samples while the previous result is read out
+    std::vector<float> input_;
+    std::vector<float> output_;
+    size_t fill_ = 0;
+
+    // Noise suppression
+    Dsp::ComplexFft fft_;
+    std::vector<float> window_;      // sqrt-Hann, used for analysis and synthesis
+    std::vector<float> frame_;       // Last fftSize_ input samples
+    std::vector<float> re_, im_;
+    std::vector<float> gains_;       // Per FFT bin, mirrored
+    std::vector<float> smoothed_;    // Smoothed power per bin
+    std::vector<float> noise_;       // Noise power estimate per bin
+    std::vector<float> previousGain_;
+    std::vector<float> previousPost_;
+    std::vector<float> overlap_;     // Second half of the previous synthesized frame
+    bool noiseInitialized_ = false;
+    float floorGain_;
+    float noiseRise_;
+
+    // AGC
+    float envelopeDb_ = -60.0f;
+    float gainDb_ = 0.0f;
+
+    // Stats
+    uint64_t blocks_ = 0;
+    uint64_t frames_ = 0;
+    double totalUs_ = 0.0;
+    double maxUs_ = 0.0;
+    double suppressionDbSum_ = 0.0;
+};
+
+} // namespace DesktopPet
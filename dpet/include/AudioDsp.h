@@ -0,0 +1,207 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace DesktopPet {
+
+/**
+ * @brief Vectorized audio kernels for realtime callbacks
+ *
+ * Compiled for AVX, SSE2 or NEON depending on the target flags, with a
+ * scalar fallback. None of them allocate or lock.
+ */
+namespace Dsp {
+
+/**
+ * @brief dst[i] += src[i] * gain
+ */
+void MixAdd(float* dst, const float* src, size_t count, float gain);
+
+/**
+ * @brief Clamp samples to [-limit, limit]
+ */
+void Clamp(float* data, size_t count, float limit = 1.0f);
+
+/**
+ * @brief Sum of a[i] * b[i]
+ */
+float Dot(const float* a, const float* b, size_t count);
+
+/**
+ * @brief dst[i] *= src[i]
+ */
+void Multiply(float* dst, const float* src, size_t count);
+
+/**
+ * @brief Scale by a gain moving linearly from startGain to endGain over the block
+ */
+void Ramp(float* data, size_t count, float startGain, float endGain);
+
+/**
+ * @brief Average interleaved frames down to mono (dst may alias src)
+ */
+void Downmix(const float* src, size_t frames, int channels, float* dst);
+
+/**
+ * @brief Float to 16-bit PCM, clamped to [-1, 1] and rounded
+ */
+void FloatToInt16(const float* src, int16_t* dst, size_t count);
+
+/**
+ * @brief 16-bit PCM back to float in [-1, 1]
+ */
+void Int16ToFloat(const int16_t* src, float* dst, size_t count);
+
+/**
+ * @brief Float to 16-bit with square-root companding: quiet audio gets
+ *        finer steps than linear PCM, full scale slightly coarser
+ */
+void CompandToInt16(const float* src, int16_t* dst, size_t count);
+
+/**
+ * @brief Inverse of CompandToInt16
+ */
+void ExpandInt16(const int16_t* src, float* dst, size_t count);
+
+/**
+ * @class LinearResampler
+ * @brief Streaming linear-interpolation rate converter
+ *
+ * Cheap enough for a realtime callback; no anti-alias filter, so it is meant
+ * for side signals (e.g. the echo reference), not for audio that is listened to.
+ */
+class LinearResampler {
+public:
+    void Configure(int inRate, int outRate) {
+        step_ = static_cast<double>(inRate) / outRate;
+        position_ = 0.0;
+        previous_ = 0.0f;
+    }
+
+    /**
+     * @brief Largest output count Process can produce for count input samples
+     */
+    size_t MaxOutput(size_t count) const { return static_cast<size_t>(count / step_) + 2; }
+
+    /**
+     * @brief Convert count input samples
+     * @param out Room for MaxOutput(count) samples
+     * @return Number of samples written
+     */
+    size_t Process(const float* in, size_t count, float* out);
+
+private:
+    double step_ = 1.0;
+    double position_ = 0.0;  // Next output position, relative to the previous input sample
+    float previous_ = 0.0f;
+};
+
+/**
+ * @class PolyphaseResampler
+ * @brief Streaming rational-ratio rate converter with a windowed-sinc filter
+ *
+ * For audio that is recognized or listened to (e.g. the microphone): the
+ * Kaiser-windowed low-pass removes everything above the lower Nyquist
+ * rate. Each output sample is one Dot over its filter phase. Tables are
+ * built in Configure(); Process does not allocate once the history has
+ * grown to the largest block.
+ */
+class PolyphaseResampler {
+public:
+    void Configure(int inRate, int outRate);
+
+    /**
+     * @brief Largest output count Process can produce for count input samples
+     */
+    size_t MaxOutput(size_t count) const { return count * up_ / down_ + 2; }
+
+    /**
+     * @brief Convert count input samples
+     * @param out Room for MaxOutput(count) samples
+     * @return Number of samples written
+     */
+    size_t Process(const float* in, size_t count, float* out);
+
+    /**
+     * @brief Filter group delay in output samples
+     */
+    double Delay() const { return delay_; }
+    size_t TapsPerPhase() const { return taps_; }
+
+private:
+    size_t up_ = 1;
+    size_t down_ = 1;
+    size_t taps_ = 0;
+    std::vector<float> phases_;   // up_ phases of taps_ coefficients, time-reversed
+    std::vector<float> history_;  // Input; the last taps_ - 1 samples are kept between calls
+    size_t position_ = 0;         // Input index of the next output's newest sample
+    size_t phase_ = 0;
+    double delay_ = 0.0;
+};
+
+/**
+ * @class ComplexFft
+ * @brief In-place radix-2 FFT on split real/imaginary arrays
+ *
+ * Twiddles are stored per stage so every butterfly pass runs over
+ * contiguous memory with the vectorized kernels. Tables are built in
+ * Configure(); transforms do not allocate.
+ */
+class ComplexFft {
+public:
+    /**
+     * @param size FFT length, a power of two
+     */
+    void Configure(size_t size);
+
+    size_t Size() const { return size_; }
+
+    void Forward(float* re, float* im) const;
+
+    /**
+     * @brief Inverse transform, scaled by 1/Size()
+     */
+    void Inverse(float* re, float* im) const;
+
+private:
+    size_t size_ = 0;
+    std::vector<uint32_t> bitReverse_;
+    std::vector<float> twiddleRe_, twiddleIm_;  // Stage with half-size h starts at index h - 1
+};
+
+/**
+ * @class PowerSpectrum
+ * @brief FFT of real frames, returning the one-sided power spectrum
+ */
+class PowerSpectrum {
+public:
+    /**
+     * @param size FFT length, a power of two
+     */
+    void Configure(size_t size);
+
+    size_t Size() const { return fft_.Size(); }
+    size_t Bins() const { return fft_.Size() / 2 + 1; }
+
+    /**
+     * @brief |X[k]|^2 for k = 0..Size()/2
+     * @param frame Size() samples (zero-pad shorter frames)
+     * @param power Room for Bins() values
+     */
+    void Compute(const float* frame, float* power);
+
+private:
+    ComplexFft fft_;
+    std::vector<float> re_, im_;
+};
+
+/**
+ * @brief Name of the instruction set the kernels were built for
+ */
+const char* SimdName();
+
+} // namespace Dsp
+
+} // namespace DesktopPet
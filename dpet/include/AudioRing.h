@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+namespace DesktopPet {
+
+/**
+ * @class SpscRing
+ * @brief Lock-free single-producer/single-consumer ring buffer
+ *
+ * Used to move samples between a realtime audio callback and a worker
+ * thread: neither side ever locks or allocates after construction.
+ * Capacity is rounded up to a power of two.
+ */
+template<typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        buffer_.resize(size);
+        mask_ = size - 1;
+    }
+
+    // Disable copy
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    size_t Capacity() const { return buffer_.size(); }
+
+    /**
+     * @brief Number of items ready to read (consumer side)
+     */
+    size_t ReadAvailable() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Free space (producer side)
+     */
+    size_t WriteAvailable() const {
+        return buffer_.size() - (head_.load(std::memory_order_relaxed) - tail_.load(std::memory_order_acquire));
+    }
+
+    /**
+     * @brief Write up to count items (producer only)
+     * @return Number of items written
+     */
+    size_t Write(const T* data, size_t count) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        count = std::min(count, buffer_.size() - (head - tail));
+
+        size_t start = head & mask_;
+        size_t first = std::min(count, buffer_.size() - start);
+        std::copy(data, data + first, buffer_.begin() + start);
+        std::copy(data + first, data + count, buffer_.begin());
+
+        head_.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * @brief Read up to count items (consumer only)
+     * @return Number of items read
+     */
+    size_t Read(T* data, size_t count) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t head = head_.load(std::memory_order_acquire);
+        count = std::min(count, head - tail);
+
+        size_t start = tail & mask_;
+        size_t first = std::min(count, buffer_.size() - start);
+        std::copy(buffer_.begin() + start, buffer_.begin() + start + first, data);
+        std::copy(buffer_.begin(), buffer_.begin() + (count - first), data + first);
+
+        tail_.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * @brief Drop up to count of the oldest items (consumer only)
+     * @return Number of items dropped
+     */
+    size_t Skip(size_t count) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t head = head_.load(std::memory_order_acquire);
+        count = std::min(count, head - tail);
+        tail_.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * @brief Drop everything currently buffered (consumer only)
+     */
+    void Discard() {
+        tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+private:
+    std::vector<T> buffer_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<size_t> head_{0};  // Written by producer
+    alignas(64) std::atomic<size_t> tail_{0};  // Written by consumer
+};
+
+} // namespace DesktopPet
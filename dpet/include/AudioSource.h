@@ -0,0 +1,177 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+
+struct ma_device;
+
+namespace DesktopPet {
+
+enum class AudioSourceType {
+    Device,  // Default capture device (miniaudio)
+    File,    // WAV file replayed in real time
+    Null     // Silence in real time, for machines without sound hardware
+};
+
+/**
+ * @brief Where AudioManager's capture comes from
+ */
+struct AudioSourceConfig {
+    AudioSourceType type = AudioSourceType::Device;
+    std::string path;    // File: WAV to replay
+    bool loop = false;   // File: start over at the end instead of continuing with silence
+};
+
+/**
+ * @brief Parse a source name: "device", "null" or a WAV path
+ */
+AudioSourceConfig ParseAudioSource(const std::string& spec);
+
+/**
+ * @class AudioSource
+ * @brief Delivers capture blocks: from a microphone, a WAV file or silence
+ *
+ * Blocks are interleaved float at SampleRate() x Channels(). A device calls
+ * back from its own audio thread; the file and null sources call back from
+ * a thread of their own every 10 ms, paced by the steady clock, so
+ * everything downstream (rings, wake-ups, timing stats) runs as with a
+ * microphone and a replayed session hears the same samples every run.
+ */
+class AudioSource {
+public:
+    using Callback = void (*)(void* user, const float* samples, unsigned int frameCount);
+
+    virtual ~AudioSource() = default;
+
+    /**
+     * @brief Prepare the source; 0 for rate or channels keeps the source's own format
+     */
+    virtual bool Open(int sampleRate, int channels, Callback callback, void* user) = 0;
+    virtual bool Start() = 0;
+    virtual void Stop() = 0;
+
+    virtual int SampleRate() const = 0;
+    virtual int Channels() const = 0;
+    virtual std::string Describe() const = 0;
+
+    /**
+     * @brief A replayed file has played to its end (always false for live sources)
+     */
+    virtual bool Finished() const { return false; }
+
+    static std::unique_ptr<AudioSource> Create(const AudioSourceConfig& config);
+};
+
+/**
+ * @class DeviceAudioSource
+ * @brief The default capture device
+ */
+class DeviceAudioSource : public AudioSource {
+public:
+    DeviceAudioSource() = default;
+    ~DeviceAudioSource() override;
+
+    // Disable copy
+    DeviceAudioSource(const DeviceAudioSource&) = delete;
+    DeviceAudioSource& operator=(const DeviceAudioSource&) = delete;
+
+    bool Open(int sampleRate, int channels, Callback callback, void* user) override;
+    bool Start() override;
+    void Stop() override;
+
+    int SampleRate() const override;
+    int Channels() const override;
+    std::string Describe() const override;
+
+private:
+    static void DataCallback(ma_device* device, void* output, const void* input, unsigned int frameCount);
+
+    ma_device* device_ = nullptr;
+    Callback callback_ = nullptr;
+    void* user_ = nullptr;
+};
+
+/**
+ * @class PacedAudioSource
+ * @brief Base for sources that generate their blocks on a real-time paced thread
+ *
+ * Derived classes call Stop() in their destructor, before the state Fill()
+ * reads goes away.
+ */
+class PacedAudioSource : public AudioSource {
+public:
+    ~PacedAudioSource() override;
+
+    bool Start() override;
+    void Stop() override;
+
+    int SampleRate() const override { return sampleRate_; }
+    int Channels() const override { return channels_; }
+
+protected:
+    /**
+     * @brief Fill frameCount frames of the next block
+     */
+    virtual void Fill(float* out, size_t frameCount) = 0;
+
+    void SetCallback(Callback callback, void* user) {
+        callback_ = callback;
+        user_ = user;
+    }
+
+    int sampleRate_ = 0;
+    int channels_ = 0;
+
+private:
+    void Run();
+
+    Callback callback_ = nullptr;
+    void* user_ = nullptr;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::vector<float> block_;
+};
+
+/**
+ * @class FileAudioSource
+ * @brief Replays a WAV file in real time, then silence (or from the start again)
+ */
+class FileAudioSource : public PacedAudioSource {
+public:
+    FileAudioSource(const std::string& path, bool loop) : path_(path), loop_(loop) {}
+    ~FileAudioSource() override { Stop(); }
+
+    bool Open(int sampleRate, int channels, Callback callback, void* user) override;
+    std::string Describe() const override;
+    bool Finished() const override { return finished_.load(std::memory_order_acquire); }
+
+protected:
+    void Fill(float* out, size_t frameCount) override;
+
+private:
+    std::string path_;
+    bool loop_;
+    std::vector<float> samples_;  // Whole file, interleaved, at the opened format
+    size_t position_ = 0;         // Frames played
+    std::atomic<bool> finished_{false};
+};
+
+/**
+ * @class NullAudioSource
+ * @brief Digital silence in real time (16 kHz mono unless a format is requested)
+ */
+class NullAudioSource : public PacedAudioSource {
+public:
+    ~NullAudioSource() override { Stop(); }
+
+    bool Open(int sampleRate, int channels, Callback callback, void* user) override;
+    std::string Describe() const override { return "null"; }
+
+protected:
+    void Fill(float* out, size_t frameCount) override;
+};
+
+} // namespace DesktopPet
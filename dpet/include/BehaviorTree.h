@@ -0,0 +1,308 @@
+#pragma once
+
+#include <sol/sol.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include "Utils.h"
+
+namespace DesktopPet {
+
+enum class BTStatus {
+    Success,
+    Failure,
+    Running
+};
+
+/**
+ * @class Blackboard
+ * @brief Shared state for behavior tree nodes
+ *
+ * Flags are one-shot stimuli set by the host ("click", "heard") and consumed
+ * by condition leaves, so reactions never need a Lua round trip.
+ */
+class Blackboard {
+public:
+    void SetFlag(const std::string& name) { flags_.insert(name); }
+    bool HasFlag(const std::string& name) const { return flags_.count(name) > 0; }
+
+    /**
+     * @brief Test and clear a flag
+     */
+    bool ConsumeFlag(const std::string& name) { return flags_.erase(name) > 0; }
+
+    void Clear() { flags_.clear(); }
+
+    /**
+     * @brief Seconds the tree has been ticking (for cooldowns)
+     */
+    double GetTime() const { return time_; }
+    void Advance(float deltaTime) { time_ += deltaTime; }
+
+private:
+    std::unordered_set<std::string> flags_;
+    double time_ = 0.0;
+};
+
+/**
+ * @brief Per-tick context passed down the tree
+ */
+struct BTContext {
+    float deltaTime = 0.0f;
+    Blackboard* blackboard = nullptr;
+    ThreadSafeQueue<AppEvent>* eventQueue = nullptr;
+};
+
+/**
+ * @class BTNode
+ * @brief Base class for behavior tree nodes
+ */
+class BTNode {
+public:
+    virtual ~BTNode() = default;
+
+    /**
+     * @brief Tick the node, calling OnEnter when it was not already running
+     */
+    BTStatus Tick(BTContext& ctx);
+
+    /**
+     * @brief Interrupt a running node (parent switched branches)
+     */
+    void Abort();
+
+    bool IsRunning() const { return running_; }
+
+protected:
+    virtual void OnEnter(BTContext& ctx) { (void)ctx; }
+    virtual BTStatus Update(BTContext& ctx) = 0;
+    virtual void OnAbort() {}
+
+private:
+    bool running_ = false;
+};
+
+using BTNodePtr = std::unique_ptr<BTNode>;
+
+// ----------------------------------------------------------------------------
+// Composites
+// ----------------------------------------------------------------------------
+
+class BTComposite : public BTNode {
+public:
+    void AddChild(BTNodePtr child) { children_.push_back(std::move(child)); }
+
+protected:
+    void OnEnter(BTContext& ctx) override { (void)ctx; current_ = 0; }
+    void OnAbort() override;
+
+    std::vector<BTNodePtr> children_;
+    size_t current_ = 0;
+};
+
+/**
+ * @brief Runs children in order until one fails; resumes the running child
+ */
+class BTSequence : public BTComposite {
+protected:
+    BTStatus Update(BTContext& ctx) override;
+};
+
+/**
+ * @brief Runs children in order until one succeeds; resumes the running child
+ */
+class BTSelector : public BTComposite {
+protected:
+    BTStatus Update(BTContext& ctx) override;
+};
+
+/**
+ * @brief Reactive selector - re-checks higher-priority children every tick
+ * and aborts a lower running child when one of them takes over
+ */
+class BTPriority : public BTComposite {
+protected:
+    BTStatus Update(BTContext& ctx) override;
+};
+
+// ----------------------------------------------------------------------------
+// Decorators
+// ----------------------------------------------------------------------------
+
+class BTDecorator : public BTNode {
+public:
+    explicit BTDecorator(BTNodePtr child) : child_(std::move(child)) {}
+
+protected:
+    void OnAbort() override { child_->Abort(); }
+
+    BTNodePtr child_;
+};
+
+class BTInverter : public BTDecorator {
+public:
+    using BTDecorator::BTDecorator;
+
+protected:
+    BTStatus Update(BTContext& ctx) override;
+};
+
+/**
+ * @brief Repeats the child count times (count < 0 repeats forever)
+ */
+class BTRepeat : public BTDecorator {
+public:
+    BTRepeat(BTNodePtr child, int count) : BTDecorator(std::move(child)), count_(count) {}
+
+protected:
+    void OnEnter(BTContext& ctx) override { (void)ctx; done_ = 0; }
+    BTStatus Update(BTContext& ctx) override;
+
+private:
+    int count_;
+    int done_ = 0;
+};
+
+/**
+ * @brief Fails without ticking the child until seconds have passed since
+ * the child last finished
+ */
+class BTCooldown : public BTDecorator {
+public:
+    BTCooldown(BTNodePtr child, float seconds) : BTDecorator(std::move(child)), seconds_(seconds) {}
+
+protected:
+    BTStatus Update(BTContext& ctx) override;
+
+private:
+    float seconds_;
+    double readyAt_ = 0.0;
+};
+
+// ----------------------------------------------------------------------------
+// Leaves
+// ----------------------------------------------------------------------------
+
+class BTWait : public BTNode {
+public:
+    explicit BTWait(float seconds) : seconds_(seconds) {}
+
+protected:
+    void OnEnter(BTContext& ctx) override { (void)ctx; elapsed_ = 0.0f; }
+    BTStatus Update(BTContext& ctx) override;
+
+private:
+    float seconds_;
+    float elapsed_ = 0.0f;
+};
+
+/**
+ * @brief Succeeds once per blackboard flag (consumes it)
+ */
+class BTFlag : public BTNode {
+public:
+    explicit BTFlag(std::string name) : name_(std::move(name)) {}
+
+protected:
+    BTStatus Update(BTContext& ctx) override;
+
+private:
+    std::string name_;
+};
+
+/**
+ * @brief Succeeds with the given probability
+ */
+class BTChance : public BTNode {
+public:
+    explicit BTChance(float probability) : probability_(probability) {}
+
+protected:
+    BTStatus Update(BTContext& ctx) override;
+
+private:
+    float probability_;
+};
+
+/**
+ * @brief Shows a bubble with one of the given lines (PetAPI pet.say);
+ * with voice set the line is also spoken (pet.speak)
+ */
+class BTSay : public BTNode {
+public:
+    BTSay(std::vector<std::string> lines, bool voice) : lines_(std::move(lines)), voice_(voice) {}
+
+protected:
+    BTStatus Update(BTContext& ctx) override;
+
+private:
+    std::vector<std::string> lines_;
+    bool voice_;
+};
+
+/**
+ * @brief Changes the pet expression (PetAPI pet.setExpression)
+ */
+class BTExpression : public BTNode {
+public:
+    explicit BTExpression(std::string expression) : expression_(std::move(expression)) {}
+
+protected:
+    BTStatus Update(BTContext& ctx) override;
+
+private:
+    std::string expression_;
+};
+
+/**
+ * @brief Calls a Lua function; return true/nil = success, false = failure,
+ * "running" = keep ticking
+ */
+class BTLuaAction : public BTNode {
+public:
+    explicit BTLuaAction(sol::protected_function func) : func_(std::move(func)) {}
+
+protected:
+    BTStatus Update(BTContext& ctx) override;
+
+private:
+    sol::protected_function func_;
+};
+
+/**
+ * @class BehaviorTree
+ * @brief Owns a tree and its blackboard; ticked once per frame
+ */
+class BehaviorTree {
+public:
+    /**
+     * @brief Build a tree from a Lua spec table (see bt.* helpers)
+     * @param error Set to a description when the spec is invalid
+     * @return Root node, or nullptr on error
+     */
+    static BTNodePtr Build(const sol::table& spec, std::string& error);
+
+    void SetRoot(BTNodePtr root);
+
+    /**
+     * @brief Detach the current root (aborted) so it can be restored later
+     */
+    BTNodePtr ReleaseRoot();
+
+    bool HasRoot() const { return root_ != nullptr; }
+    void Clear();
+
+    /**
+     * @brief Tick the tree; restarts it when the root finishes
+     */
+    void Tick(float deltaTime, ThreadSafeQueue<AppEvent>* eventQueue);
+
+    Blackboard& GetBlackboard() { return blackboard_; }
+
+private:
+    BTNodePtr root_;
+    Blackboard blackboard_;
+};
+
+} // namespace DesktopPet
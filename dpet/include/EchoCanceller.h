@@ -0,0 +1,106 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace DesktopPet {
+
+/**
+ * @class EchoCanceller
+ * @brief Removes the pet's own playback from the microphone signal
+ *
+ * Takes the microphone and the playback mix (the reference, resampled to
+ * the capture rate) and outputs the microphone with the echo subtracted.
+ * Uses SpeexDSP when built with DPET_HAVE_SPEEXDSP, otherwise a built-in
+ * time-domain two-path NLMS filter that stops adapting during double talk.
+ * Work per frame is fixed by the tail length, so CPU cost per block is
+ * bounded.
+ *
+ * Not thread-safe: call from one thread (the audio worker).
+ */
+class EchoCanceller {
+public:
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t doubleTalkFrames = 0;
+        double avgFrameUs = 0.0;
+        double maxFrameUs = 0.0;
+        float erleDb = 0.0f;  // Echo return loss enhancement while only the pet was talking
+    };
+
+    /**
+     * @param sampleRate Capture rate (mic and reference)
+     * @param frameMs Processing block length
+     * @param tailMs Longest echo path the filter can model
+     */
+    EchoCanceller(int sampleRate, int frameMs = 10, int tailMs = 128);
+    ~EchoCanceller();
+
+    // Disable copy
+    EchoCanceller(const EchoCanceller&) = delete;
+    EchoCanceller& operator=(const EchoCanceller&) = delete;
+
+    /**
+     * @brief Cancel echo from count samples
+     *
+     * Works in whole frames; a trailing partial frame is zero-padded, so
+     * streaming callers should pass multiples of FrameSize() until the end.
+     */
+    void Process(const float* mic, const float* reference, float* out, size_t count);
+
+    /**
+     * @brief Forget the learned echo path
+     */
+    void Reset();
+
+    size_t FrameSize() const { return frameSize_; }
+    const char* BackendName() const;
+    Stats GetStats() const;
+
+private:
+    void ProcessFrame(const float* mic, const float* reference, float* out);
+    /**
+     * @return true if the frame was treated as double talk (no adaptation)
+     */
+    bool ProcessFrameNlms(const float* mic, const float* reference, float* out,
+                          bool referenceActive, bool doubleTalk);
+
+    int sampleRate_;
+    size_t frameSize_;
+    size_t taps_;
+
+    // NLMS state: history_ holds the reference twice so the newest taps_
+    // samples are always contiguous at history_[position_]
+    std::vector<float> background_;  // Adapting filter
+    std::vector<float> foreground_;  // Filter used for the output
+    float backgroundEnergy_ = 0.0f;
+    float foregroundEnergy_ = 0.0f;
+    std::vector<float> history_;
+    size_t position_ = 0;
+    float historyEnergy_ = 0.0f;
+    std::vector<size_t> framePositions_;
+    std::vector<float> frameEnergies_;
+
+    // Double talk: per-frame reference peaks covering the filter tail (Geigel)
+    // and the usual residual/mic ratio of the output filter
+    std::vector<float> referencePeaks_;
+    size_t peakIndex_ = 0;
+    int holdFrames_ = 0;
+    float residualBaseline_ = 1.0f;
+
+    void* speex_ = nullptr;  // SpeexEchoState when built with SpeexDSP
+    std::vector<int16_t> micPcm_, refPcm_, outPcm_;
+
+    std::vector<float> padMic_, padRef_, padOut_;
+
+    // Stats
+    uint64_t frames_ = 0;
+    uint64_t doubleTalkFrames_ = 0;
+    double totalUs_ = 0.0;
+    double maxUs_ = 0.0;
+    double echoInEnergy_ = 0.0;
+    double echoOutEnergy_ = 0.0;
+};
+
+} // namespace DesktopPet
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "AudioDsp.h"
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace DesktopPet {
+
+/**
+ * @brief One analysis frame of the live capture stream
+ */
+struct FeatureFrame {
+    static constexpr size_t kMelBins = 80;
+
+    uint64_t index = 0;     // Frame number since the front-end started
+    int64_t endNs = 0;      // Estimated capture time of the frame's last sample (steady clock)
+    float energyDb = 0.0f;  // Frame level in dBFS
+    std::array<float, kMelBins> mel{};  // Log mel energies, ln(mean square) per band after pre-emphasis
+};
+
+/**
+ * @class FeatureRing
+ * @brief Recent feature frames, written once and read by any number of consumers
+ *
+ * Each consumer keeps its own FeatureRing::Reader; a reader that falls
+ * more than Capacity() frames behind skips ahead and counts the frames it
+ * missed. Writer and readers run on the same thread (the audio worker).
+ */
+class FeatureRing {
+public:
+    explicit FeatureRing(size_t capacity) : frames_(capacity) {}
+
+    size_t Capacity() const { return frames_.size(); }
+    uint64_t WriteIndex() const { return written_; }
+
+    /**
+     * @brief Slot for the next frame; Commit() makes it visible
+     */
+    FeatureFrame& Next() { return frames_[written_ % frames_.size()]; }
+    void Commit() { ++written_; }
+
+    class Reader {
+    public:
+        Reader() = default;
+        explicit Reader(const FeatureRing* ring) : ring_(ring), next_(ring->WriteIndex()) {}
+
+        /**
+         * @return The next unread frame, or nullptr when caught up
+         */
+        const FeatureFrame* Read() {
+            if (!ring_ || next_ >= ring_->written_) {
+                return nullptr;
+            }
+            if (ring_->written_ - next_ > ring_->frames_.size()) {
+                uint64_t oldest = ring_->written_ - ring_->frames_.size();
+                missed_ += oldest - next_;
+                next_ = oldest;
+            }
+            return &ring_->frames_[next_++ % ring_->frames_.size()];
+        }
+
+        uint64_t Missed() const { return missed_; }
+
+    private:
+        const FeatureRing* ring_ = nullptr;
+        uint64_t next_ = 0;
+        uint64_t missed_ = 0;
+    };
+
+    Reader NewReader() const { return Reader(this); }
+
+private:
+    std::vector<FeatureFrame> frames_;
+    uint64_t written_ = 0;
+};
+
+/**
+ * @class FeatureFrontend
+ * @brief Streaming log-mel front-end shared by the live-audio detectors
+ *
+ * Computes 25 ms / 10 ms frames once (Kaldi-style: DC removal,
+ * pre-emphasis, Povey window, 512-point FFT, 80 mel bands) into a
+ * FeatureRing, so each detector added on the always-listening path reads
+ * frames instead of running its own FFT.
+ */
+class FeatureFrontend {
+public:
+    explicit FeatureFrontend(int sampleRate, size_t ringFrames = 256);
+
+    // Disable copy
+    FeatureFrontend(const FeatureFrontend&) = delete;
+    FeatureFrontend& operator=(const FeatureFrontend&) = delete;
+
+    /**
+     * @brief Feed samples and compute every frame that completes
+     * @param endNs Capture time of the last sample
+     */
+    void Accept(const float* samples, size_t count, int64_t endNs);
+
+    /**
+     * @brief Forget buffered samples (frame numbering continues)
+     */
+    void Reset();
+
+    const FeatureRing& Frames() const { return ring_; }
+    int SampleRate() const { return sampleRate_; }
+
+    /**
+     * @brief First and one-past-last mel band whose centre lies in [lowHz, highHz)
+     */
+    void BandRange(float lowHz, float highHz, size_t& first, size_t& last) const;
+
+    /**
+     * @brief Compute time as a percentage of the audio duration (one core)
+     */
+    double CpuPercent() const;
+    void PrintStats() const;
+
+private:
+    struct MelFilter {
+        size_t firstBin = 0;
+        std::vector<float> weights;
+    };
+
+    void ComputeFrame(const float* samples, int64_t endNs);
+
+    int sampleRate_;
+    size_t frameLength_;
+    size_t frameShift_;
+    std::vector<float> window_;
+    std::vector<MelFilter> filters_;
+    std::vector<float> centresHz_;
+    float powerScale_ = 1.0f;
+
+    Dsp::PowerSpectrum fft_;
+    std::vector<float> pending_;  // Samples not yet consumed by a frame
+    size_t pendingCount_ = 0;
+    std::vector<float> frame_;
+    std::vector<float> power_;
+    FeatureRing ring_;
+
+    uint64_t samplesProcessed_ = 0;
+    double computeMs_ = 0.0;
+};
+
+} // namespace DesktopPet
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+// Forward declarations for sherpa-onnx keyword spotting
+struct SherpaOnnxKeywordSpotter;
+struct SherpaOnnxOnlineStream;
+
+namespace DesktopPet {
+
+/**
+ * @brief Wake-word model settings
+ *
+ * modelDir holds a sherpa-onnx streaming zipformer KWS release
+ * (encoder/decoder/joiner .onnx, tokens.txt, keywords.txt). Keywords must
+ * be tokenized for the model, e.g. with `sherpa-onnx-cli text2token`.
+ */
+struct KwsConfig {
+    std::string modelDir;
+    std::string keywordsFile;      // Empty = modelDir/keywords.txt
+    float keywordsThreshold = 0.25f;
+    float keywordsScore = 1.0f;
+    int sampleRate = 16000;
+    int numThreads = 1;
+};
+
+/**
+ * @class KeywordSpotter
+ * @brief Always-on wake-word detection on a streaming sherpa-onnx model
+ *
+ * Accept() is fed capture audio continuously; it computes features and
+ * decodes incrementally, and tracks how much CPU time that costs per
+ * second of audio.
+ */
+class KeywordSpotter {
+public:
+    KeywordSpotter() = default;
+    ~KeywordSpotter();
+
+    // Disable copy
+    KeywordSpotter(const KeywordSpotter&) = delete;
+    KeywordSpotter& operator=(const KeywordSpotter&) = delete;
+
+    bool Init(const KwsConfig& config);
+    bool IsReady() const { return spotter_ != nullptr; }
+
+    /**
+     * @brief Feed audio and decode what is ready
+     * @return The detected keyword, or empty
+     */
+    std::string Accept(const float* samples, size_t count);
+
+    /**
+     * @brief Drop buffered audio (e.g. after a recording used the microphone)
+     */
+    void Reset();
+
+    /**
+     * @brief Decode time as a percentage of the audio duration (one core)
+     */
+    double CpuPercent() const;
+
+    /**
+     * @brief Print audio processed, detections and CPU share
+     */
+    void PrintStats() const;
+
+private:
+    const SherpaOnnxKeywordSpotter* spotter_ = nullptr;
+    const SherpaOnnxOnlineStream* stream_ = nullptr;
+
+    int sampleRate_ = 16000;
+    size_t samplesProcessed_ = 0;
+    double computeMs_ = 0.0;
+    size_t detections_ = 0;
+    size_t nextReportSamples_ = 0;
+};
+
+} // namespace DesktopPet
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace DesktopPet {
+
+/**
+ * @struct LuaAllocStats
+ * @brief Allocation counters for a Lua state
+ */
+struct LuaAllocStats {
+    size_t bytesInUse = 0;          // Bytes currently owned by Lua
+    size_t peakBytes = 0;           // High-water mark of bytesInUse
+    size_t reservedBytes = 0;       // Bytes held in pool slabs (used or free)
+    uint64_t allocCount = 0;        // New blocks requested by Lua
+    uint64_t freeCount = 0;         // Blocks released by Lua
+    uint64_t reallocCount = 0;      // Resizes of existing blocks
+    uint64_t poolHits = 0;          // Requests served from a size-class pool
+    uint64_t largeAllocs = 0;       // Requests too big for the pools (malloc)
+    uint64_t slabRefills = 0;       // Times a pool had to grab a new slab
+    uint64_t failedAllocs = 0;      // Requests refused by the memory limit
+};
+
+/**
+ * @class LuaAllocator
+ * @brief lua_Alloc implementation backed by size-class pools
+ *
+ * Features:
+ * - Small blocks (<= 512 bytes) come from per-size-class free lists carved
+ *   out of 64 KB slabs, so table/closure/string churn never reaches malloc
+ * - Larger blocks fall through to malloc/realloc
+ * - Optional hard memory cap; growth beyond it fails like an OOM in Lua
+ *
+ * Lua always passes the old block size back to the allocator, so blocks
+ * carry no header and the size class is derived from osize on free.
+ * Not thread-safe: a Lua state is only ever used from one thread.
+ */
+class LuaAllocator {
+public:
+    LuaAllocator();
+    ~LuaAllocator();
+
+    // Disable copy (Lua holds a raw pointer to us)
+    LuaAllocator(const LuaAllocator&) = delete;
+    LuaAllocator& operator=(const LuaAllocator&) = delete;
+
+    /**
+     * @brief lua_Alloc entry point, ud must point to a LuaAllocator
+     */
+    static void* Alloc(void* ud, void* ptr, size_t osize, size_t nsize);
+
+    /**
+     * @brief Set hard memory cap in bytes (0 = unlimited)
+     */
+    void SetMemoryLimit(size_t bytes) { limit_ = bytes; }
+    size_t GetMemoryLimit() const { return limit_; }
+
+    /**
+     * @brief Get allocation statistics
+     */
+    const LuaAllocStats& GetStats() const { return stats_; }
+
+    /**
+     * @brief Reset event counters (keeps byte totals)
+     */
+    void ResetCounters();
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct Pool {
+        size_t blockSize = 0;
+        FreeBlock* freeList = nullptr;
+    };
+
+    static constexpr size_t kMaxSmallSize = 512;
+    static constexpr size_t kSlabSize = 64 * 1024;
+    static constexpr size_t kGranularity = 16;
+
+    void* Allocate(size_t size);
+    void Free(void* ptr, size_t size);
+    void* Reallocate(void* ptr, size_t osize, size_t nsize);
+
+    /**
+     * @brief Map a size to its pool index, or -1 for large blocks
+     */
+    int PoolIndex(size_t size) const;
+
+    void* AllocateFromPool(int index);
+    bool RefillPool(Pool& pool);
+
+    std::vector<Pool> pools_;
+    std::vector<int8_t> classLookup_;  // (size + 15) / 16 -> pool index
+    std::vector<void*> slabs_;
+    size_t limit_ = 0;
+    LuaAllocStats stats_;
+};
+
+} // namespace DesktopPet
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <chrono>
+#include <cstdint>
+
+struct lua_State;
+struct lua_Debug;
+
+namespace DesktopPet {
+
+/**
+ * @class LuaProfiler
+ * @brief Sampling profiler for Lua code driven by debug hooks
+ *
+ * Features:
+ * - Count mode: samples every N VM instructions (low overhead)
+ * - Line mode: samples on every new source line (exact per-line time)
+ * - Aggregates wall time per call stack, per function and per source line
+ * - Dumps folded stacks ("a;b;c <microseconds>") for flamegraph.pl/speedscope
+ *
+ * Time is only accumulated between BeginSlice()/EndSlice(), i.e. while the
+ * host is actually inside Lua, so idle frames do not inflate the numbers.
+ */
+class LuaProfiler {
+public:
+    enum class Mode {
+        Count,  // LUA_MASKCOUNT every instructionInterval instructions
+        Line    // LUA_MASKLINE
+    };
+
+    explicit LuaProfiler(int instructionInterval = 1000);
+    ~LuaProfiler();
+
+    // Disable copy (the hook keeps a pointer to us)
+    LuaProfiler(const LuaProfiler&) = delete;
+    LuaProfiler& operator=(const LuaProfiler&) = delete;
+
+    /**
+     * @brief Install the debug hook on a Lua state
+     */
+    void Start(lua_State* L, Mode mode = Mode::Count);
+
+    /**
+     * @brief Remove the debug hook (collected data is kept)
+     */
+    void Stop();
+
+    /**
+     * @brief Check if the hook is installed
+     */
+    bool IsRunning() const { return state_ != nullptr; }
+
+    /**
+     * @brief Discard all collected samples
+     */
+    void Reset();
+
+    /**
+     * @brief Mark entry into Lua from the host
+     * @param entry What the host calls (e.g. "onUpdate"), with an optional
+     *        detail (event type, file); a slice that ends before the first
+     *        hook is charged to "entry detail". Both must stay valid until
+     *        EndSlice; no string is built unless the profiler is running
+     */
+    void BeginSlice(const char* entry, const char* detail = nullptr);
+
+    /**
+     * @brief Mark return from Lua to the host
+     */
+    void EndSlice();
+
+    /**
+     * @brief Write folded stacks to a file
+     */
+    bool DumpFolded(const std::string& path) const;
+
+    /**
+     * @brief Human-readable top-N functions and lines by time
+     */
+    std::string Report(size_t topN = 10) const;
+
+private:
+    struct Entry {
+        uint64_t samples = 0;
+        double micros = 0.0;
+    };
+
+    static void Hook(lua_State* L, lua_Debug* ar);
+
+    /**
+     * @brief Capture the current stack and charge elapsed time to it
+     */
+    void Sample(lua_State* L);
+
+    /**
+     * @brief Charge time since the last sample to the current keys
+     */
+    void Charge(std::chrono::steady_clock::time_point now);
+
+    int instructionInterval_;
+    lua_State* state_ = nullptr;
+    bool inSlice_ = false;
+    const char* sliceEntry_ = nullptr;
+    const char* sliceDetail_ = nullptr;
+    std::chrono::steady_clock::time_point lastSample_;
+
+    // Keys of the most recent sample; time is charged to them
+    std::string currentStack_;
+    std::string currentFunction_;
+    std::string currentLine_;
+
+    std::unordered_map<std::string, Entry> stacks_;
+    std::unordered_map<std::string, Entry> functions_;
+    std::unordered_map<std::string, Entry> lines_;
+};
+
+} // namespace DesktopPet
@@ -8,12 +8,31 @@
 #include <memory>
 #include <vector>
 #include <mutex>
+#include <array>
+#include <iostream>
+#include <functional>
 #include "Utils.h"
+#include "AudioRing.h"
+#include "AudioChunks.h"
+#include "TtsEngine.h"
+#include "TtsCache.h"
+#include "SoundMixer.h"
+#include "EchoCanceller.h"
+#include "KeywordSpotter.h"
+#include "FeatureFrontend.h"
+#include "AudioConditioner.h"
+#include "PauseSplitter.h"
+#include "AsrBackend.h"
+#include "AudioSource.h"
+#include "AudioDsp.h"
 #include "ContextManager.h"
+#include "LuaAllocator.h"
+#include "LuaProfiler.h"
+#include "BehaviorTree.h"
+#include "ScriptWatcher.h"
 #include "chat_bubble.h"
 
-// Forward declarations for ASR and LLM
-struct SherpaOnnxOfflineRecognizer;
+// Forward declarations for audio and LLM
 struct ma_device;
 struct llama_model;
 struct llama_context;
@@ -21,6 +40,8 @@ struct llama_adapter_lora;
 
 namespace DesktopPet {
 
+class AudioManager;
+
 // Dialog history for LLM
 struct DialogTurn {
     std::string user_message;
@@ -125,6 +146,28 @@ public:
      */
     bool IsRunning() const { return running_; }
     
+    using TokenCallback = std::function<void(const std::string& piece)>;
+    
+    /**
+     * @brief Receive reply text as it is generated (called on the AI thread)
+     * @param onToken Called for each visible token piece
+     * @param onReplyEnd Called once the reply is complete
+     */
+    void SetStreamCallbacks(TokenCallback onToken, std::function<void()> onReplyEnd) {
+        onToken_ = std::move(onToken);
+        onReplyEnd_ = std::move(onReplyEnd);
+    }
+    
+    /**
+     * @brief Stop the reply being generated (thread-safe)
+     * 
+     * Cancels the prompt the AI thread has taken, whether it is still
+     * waiting to start, decoding the prompt or generating (checked before
+     * every token); the partial reply is still ended through onReplyEnd
+     * but not sent to Lua. Prompts taken later are not affected.
+     */
+    void CancelGeneration();
+    
 private:
     /**
      * @brief AI thread loop
@@ -134,7 +177,7 @@ private:
     /**
      * @brief Process AI thinking with real LLM
      */
-    std::string ChatWithLLM(const std::string& input);
+    std::string ChatWithLLM(const std::string& input, uint64_t turn);
     
     /**
      * @brief Cleanup LLM resources
@@ -145,6 +188,12 @@ private:
     std::atomic<bool> running_{false};
     ThreadSafeQueue<AppEvent>* inputQueue_ = nullptr;
     ThreadSafeQueue<AppEvent>* outputQueue_ = nullptr;
+    TokenCallback onToken_;
+    std::function<void()> onReplyEnd_;
+    std::atomic<uint64_t> turn_{0};           // Prompts taken off the queue so far
+    std::atomic<uint64_t> cancelledTurn_{0};  // Turns up to this one are cancelled
+    std::atomic<int64_t> cancelRequestNs_{0};
+    bool lastReplyCancelled_ = false;  // AI thread only
     
     // LLM resources
     llama_model* llama_model_ = nullptr;
@@ -161,7 +210,7 @@ private:
  */
 class ScriptRunner {
 public:
-    ScriptRunner() = default;
+    ScriptRunner();
     ~ScriptRunner() = default;
     
     /**
@@ -182,6 +231,108 @@ public:
      */
     bool LoadFile(const std::string& path);
     
+    /**
+     * @brief Call a global Lua function if it exists (e.g. onUpdate)
+     * @return false if the function is missing or raised an error
+     */
+    template<typename... Args>
+    bool CallFunction(const std::string& name, Args&&... args) {
+        if (!initialized_) {
+            return false;
+        }
+        sol::protected_function func = lua_[name];
+        if (!func.valid()) {
+            return false;
+        }
+        profiler_.BeginSlice(name.c_str());
+        sol::protected_function_result result = func(std::forward<Args>(args)...);
+        profiler_.EndSlice();
+        if (!result.valid()) {
+            sol::error err = result;
+            std::cerr << "[ScriptRunner] Error in " << name << ": " << err.what() << std::endl;
+            return false;
+        }
+        return true;
+    }
+    
+    /**
+     * @brief Set hard cap on Lua heap size in bytes (0 = unlimited)
+     */
+    void SetMemoryLimit(size_t bytes) { allocator_.SetMemoryLimit(bytes); }
+    
+    /**
+     * @brief Get Lua heap allocation statistics
+     */
+    const LuaAllocStats& GetAllocStats() const { return allocator_.GetStats(); }
+    
+    /**
+     * @brief Reset allocation event counters
+     */
+    void ResetAllocCounters() { allocator_.ResetCounters(); }
+    
+    /**
+     * @brief Enable/disable the sampling profiler (also sys.profile from Lua)
+     */
+    void SetProfiling(bool enable, LuaProfiler::Mode mode = LuaProfiler::Mode::Count);
+    
+    /**
+     * @brief Get the Lua profiler (for reports and folded-stack dumps)
+     */
+    LuaProfiler& GetProfiler() { return profiler_; }
+    
+    /**
+     * @brief Tick the behavior tree installed by bt.run (called each frame)
+     */
+    void TickBehavior(float deltaTime);
+    
+    /**
+     * @brief Raise a one-shot stimulus for the behavior tree (e.g. "click")
+     */
+    void SetBehaviorFlag(const std::string& name) { behavior_.GetBlackboard().SetFlag(name); }
+    
+    /**
+     * @brief Check if a script installed a behavior tree
+     */
+    bool HasBehavior() const { return behavior_.HasRoot(); }
+    
+    /**
+     * @brief Watch every file loaded with LoadFile and recompile on change
+     */
+    bool EnableHotReload();
+    
+    /**
+     * @brief Swap in recompiled scripts (call at a frame boundary)
+     * 
+     * The new chunk runs with the old globals snapshotted. It replaces only
+     * the events.on handlers registered by the same file; the behavior tree
+     * changes only if the chunk calls bt.run or bt.stop. If it fails
+     * everything is restored, so a broken save never leaves the pet
+     * half-reloaded. On success onReload(oldState) is
+     * called, where oldState is the result of the old onSaveState() or the
+     * old global `state` table.
+     */
+    void PollReload();
+    
+    /**
+     * @brief Deliver an event to handlers registered with events.on(type, fn)
+     * 
+     * Handlers are called as fn(payload, typeName) without compiling any
+     * Lua source.
+     */
+    void Dispatch(const AppEvent& event);
+    
+    /**
+     * @brief Check if any Lua handler is subscribed to an event type
+     */
+    bool HasSubscribers(EventType type) const {
+        return !subscriptions_[static_cast<size_t>(type)].empty();
+    }
+    
+    /**
+     * @brief Give scripts access to audio (pet.playSound)
+     */
+    void SetAudioManager(AudioManager* audio) { audioManager_ = audio; }
+    
     /**
      * @brief Get Lua state (for advanced operations)
      */
@@ -193,9 +344,66 @@ private:
      */
     void BindFunctions();
     
+    /**
+     * @brief Bind bt.* behavior tree constructors
+     */
+    void BindBehaviorTree();
+    
+    /**
+     * @brief Bind events.on/off subscription API
+     */
+    void BindEvents();
+    
+    /**
+     * @brief Apply subscribe/unsubscribe requests made during Dispatch
+     */
+    void FlushPendingSubscriptions();
+    
+    /**
+     * @brief Run a recompiled chunk, rolling back on error
+     */
+    bool ApplyReload(const CompiledScript& script);
+    
+    /**
+     * @brief Install a new behavior tree root (bt.run/bt.stop)
+     */
+    void ReplaceBehavior(BTNodePtr root);
+    
+    struct Subscription {
+        int id = 0;
+        sol::protected_function handler;
+        std::string owner;  // Script file that registered it (empty for RunScript)
+    };
+    
+    // Allocator must outlive the Lua state, so it is declared first
+    LuaAllocator allocator_;
     sol::state lua_;
+    // Profiler and behavior tree reference lua_, so they are declared
+    // after it (destroyed first)
+    LuaProfiler profiler_;
+    BehaviorTree behavior_;
+    
+    // Lua handlers per event type; changes made from inside a handler are
+    // deferred until the dispatch finishes so iteration stays valid
+    std::array<std::vector<Subscription>, EVENT_TYPE_COUNT> subscriptions_;
+    std::vector<std::pair<EventType, Subscription>> pendingSubscriptions_;
+    std::vector<int> pendingUnsubscriptions_;
+    int nextSubscriptionId_ = 1;
+    bool dispatching_ = false;
+    
+    // Hot reload: the watcher thread compiles, the main thread swaps
+    std::vector<std::string> loadedFiles_;
+    std::mutex reloadMutex_;
+    std::vector<CompiledScript> pendingReloads_;
+    std::atomic<bool> reloadReady_{false};
+    std::string currentChunk_;    // File being loaded; owns the handlers it registers
+    bool reloading_ = false;
+    bool treeReplaced_ = false;   // The reloading chunk called bt.run/bt.stop
+    BTNodePtr replacedTree_;      // Tree it replaced, kept for rollback
+    ScriptWatcher watcher_;  // Last: its thread writes pendingReloads_
     bool initialized_ = false;
     ThreadSafeQueue<AppEvent>* eventQueue_ = nullptr;
+    AudioManager* audioManager_ = nullptr;
 };
 
 /**
@@ -208,9 +416,22 @@ public:
     ~AudioManager();
     
     /**
-     * @brief Initialize ASR recognizer
+     * @brief Initialize ASR recognizer and open the microphone
+     */
+    bool InitializeRecognizer(const AsrConfig& config);
+    bool InitializeRecognizer(const std::string& modelDir);  // SenseVoice
+    
+    /**
+     * @brief Load the ASR model only, without a microphone (offline tools)
+     */
+    bool LoadRecognizer(const AsrConfig& config);
+    bool LoadRecognizer(const std::string& modelDir);  // SenseVoice
+    
+    /**
+     * @brief Transcribe SAMPLE_RATE mono audio through the capture storage
+     *        encoding, as a recording would be (offline tools)
      */
-    bool InitializeRecognizer(const std::string& modelDir);
+    std::string TranscribeSamples(const float* samples, size_t count);
     
     /**
      * @brief Start the audio thread
@@ -245,30 +466,216 @@ public:
 
     /**
      * @brief Set/get recording timeout in seconds (default 5s)
+     *
+     * Set before InitializeRecognizer: capture storage is sized from it.
      */
     void SetRecordingSeconds(int seconds) { recording_seconds_ = seconds; }
     int GetRecordingSeconds() const { return recording_seconds_; }
     
     /**
-     * @brief Play TTS audio
+     * @brief Open the microphone at its own rate and channel count (default)
+     *
+     * The audio thread then downmixes and resamples to SAMPLE_RATE, which
+     * keeps the conversion out of the realtime callback. false asks the
+     * device layer for SAMPLE_RATE mono directly. Set before InitializeRecognizer.
+     */
+    void SetNativeCapture(bool native) { nativeCapture_ = native; }
+    
+    /**
+     * @brief Capture from the microphone (default), a WAV file replayed in
+     *        real time, or silence. Set before InitializeRecognizer.
+     */
+    void SetAudioSource(const AudioSourceConfig& config) { sourceConfig_ = config; }
+    
+    /**
+     * @brief A replayed session file has played to its end
+     */
+    bool AudioSourceFinished() const { return captureSource_ && captureSource_->Finished(); }
+    
+    /**
+     * @brief Sample format of stored recordings (default float32)
+     *
+     * The 16-bit encodings halve capture memory and the bandwidth of
+     * every copy; audio is converted back to float where it is consumed.
+     * Set before InitializeRecognizer.
+     */
+    void SetCaptureEncoding(SampleEncoding encoding) { captureEncoding_ = encoding; }
+    
+    /**
+     * @brief Split long recordings at pauses and decode the parts concurrently (default on)
+     */
+    void SetSegmentedDecoding(bool enable) { segmentedDecoding_ = enable; }
+    
+    /**
+     * @brief Decode a synthetic buffer when the model loads (default on)
+     *
+     * The first decode pays ONNX Runtime's lazy setup and arena growth;
+     * warming up moves that cost from the first voice turn to startup.
+     * Set before InitializeRecognizer.
+     */
+    void SetRecognizerWarmup(bool enable) { recognizerWarmup_ = enable; }
+    
+    /**
+     * @brief Decode latency of the first transcription and of the ones after it
+     */
+    void PrintAsrStats() const;
+    
+    /**
+     * @brief Load the TTS model and open the playback device
+     * 
+     * Without a TTS model Speak/FeedSpeech only log the text.
+     */
+    bool InitializeTTS(const TtsConfig& config);
+    
+    /**
+     * @brief Check if TTS is available
+     */
+    bool HasTTS() const { return tts_ != nullptr; }
+    
+    /**
+     * @brief Put a phrase cache in front of synthesis (call before Start)
+     * @param diskDir Directory for persisted clips (empty = memory only)
+     * @param phraseListPath Phrases synthesized while idle at startup
+     * @param memoryBytes In-memory LRU budget
+     */
+    void EnableSpeechCache(const std::string& diskDir, const std::string& phraseListPath,
+                           size_t memoryBytes = 16 * 1024 * 1024);
+    
+    /**
+     * @brief Speak a complete text (queued behind any current speech)
+     * 
+     * Used for scripted lines, which are also persisted to the disk cache.
      */
     void Speak(const std::string& text);
     
+    /**
+     * @brief Stream reply text to TTS; each finished sentence is synthesized
+     * while the rest of the reply is still being generated
+     */
+    void FeedSpeech(const std::string& piece);
+    
+    /**
+     * @brief End of the streamed reply: speak the remainder
+     */
+    void FlushSpeech();
+    
+    /**
+     * @brief Load sound effects and mix them into the playback device
+     * 
+     * Call after InitializeTTS so both share the device at the TTS rate.
+     */
+    bool InitializeSoundEffects(const std::string& soundDir);
+    
+    /**
+     * @brief Play a preloaded sound effect (main thread only)
+     * @return false if the sound is not loaded
+     */
+    bool PlayEffect(const std::string& name, float gain = 1.0f);
+    
+    /**
+     * @brief Cancel the pet's own playback from recordings before ASR
+     * 
+     * The playback mix is resampled to the capture rate in the playback
+     * callback and used as the echo reference. Call after the playback
+     * device is open (InitializeTTS / InitializeSoundEffects).
+     * @param tailMs Longest speaker-to-microphone echo path to model
+     */
+    bool EnableEchoCancellation(int tailMs = 128);
+    
+    /**
+     * @brief Condition recordings before ASR (high-pass, noise suppression, AGC)
+     * 
+     * Runs on the audio thread after echo cancellation, alongside the
+     * recording. Call after InitializeRecognizer.
+     */
+    bool EnableConditioning(const ConditionerConfig& config = ConditionerConfig());
+    
+    /**
+     * @brief Keep the microphone open and start a recording on a wake word
+     * 
+     * The keyword spotter runs on the audio thread; the recording it starts
+     * ends at the first pause instead of waiting for SPACE. Call after
+     * InitializeRecognizer.
+     */
+    bool EnableWakeWord(const KwsConfig& config);
+    
+    /**
+     * @brief Listen while the pet is speaking and interrupt it when the user talks
+     * 
+     * The microphone stays open during replies; sustained speech louder than
+     * the pet's own output silences playback at once, drops queued sentences,
+     * calls onBargeIn (e.g. to cancel the LLM turn) and records the new
+     * utterance until the user pauses.
+     * @param onBargeIn Called on the audio thread after output is silenced
+     */
+    void EnableBargeIn(std::function<void()> onBargeIn);
+    
+    /**
+     * @brief True while a reply is streaming, queued for synthesis or playing
+     */
+    bool IsSpeaking() const;
+    
 private:
     /**
      * @brief Audio thread loop (ASR listening)
      */
     void ThreadLoop();
     
+    enum class RecordMode {
+        Manual,      // Fresh capture until SPACE or timeout
+        UntilPause,  // Fresh capture until the user pauses (wake word)
+        Continue     // Keep the audio since a barge-in, until the user pauses
+    };
+    
     /**
      * @brief Record and transcribe audio
      */
-    std::string RecordAndTranscribe();
+    std::string RecordAndTranscribe(RecordMode mode = RecordMode::Manual);
+    
+    /**
+     * @brief Start/stop the capture device if its state differs (audio thread)
+     */
+    bool SetCaptureRunning(bool run);
     
     /**
-     * @brief Transcribe audio data
+     * @brief Drain the capture ring: convert to SAMPLE_RATE mono, store it
+     *        (pre-roll or recording), then run the feature front-end, the
+     *        voice activity detector and (when not recording) the keyword spotter
+     * @return The wake word heard, or empty
      */
-    std::string TranscribeAudio(const std::vector<float>& audioData);
+    std::string ProcessCapture();
+    
+    /**
+     * @brief Append converted capture to the pre-roll or the current recording
+     */
+    void StoreCapture(const float* samples, size_t count);
+    
+    /**
+     * @brief Callback cost and capture-to-audio-thread delay
+     */
+    void PrintCaptureStats() const;
+    
+    /**
+     * @brief Speech-band level against an adaptive noise floor, per feature frame
+     */
+    void UpdateVoiceActivity();
+    
+    /**
+     * @brief Process new capture; record when the keyword spotter hears the wake word
+     */
+    void ListenForWakeWord();
+    
+    /**
+     * @brief Run echo cancellation and conditioning over newly captured audio
+     * @param cleaned Processed audio so far
+     * @param flush Also process a trailing partial frame and drain the conditioner (end of recording)
+     */
+    void ProcessRecording(PooledAudio& cleaned, bool flush);
+    
+    /**
+     * @brief Transcribe audio data; its chunks are released once fed to the recognizer
+     */
+    std::string TranscribeAudio(PooledAudio audioData);
     
     /**
      * @brief Cleanup ASR resources
@@ -276,23 +683,192 @@ private:
     void CleanupRecognizer();
     
     /**
-     * @brief Audio callback for miniaudio
+     * @brief Decode noise once so the first real transcription runs warm
+     */
+    void WarmUpRecognizer();
+    
+    /**
+     * @brief Create streams for the next transcription (enough for a split
+     *        recording) while the user is still speaking
+     */
+    void PrepareStreams();
+    
+    /**
+     * @brief Capture callback, called by the AudioSource with each block
+     */
+    static void AudioCallback(void* user, const float* samples, unsigned int frameCount);
+    
+    /**
+     * @brief Playback callback: drains the speech ring and mixes sound
+     * effects (never blocks)
+     */
+    static void PlaybackCallback(ma_device* pDevice, void* pOutput, 
+                                 const void* pInput, unsigned int frameCount);
+    
+    /**
+     * @brief Open and start the playback device
      */
-    static void AudioCallback(ma_device* pDevice, void* pOutput, 
-                             const void* pInput, unsigned int frameCount);
+    bool InitializePlayback(int sampleRate);
+    
+    /**
+     * @brief Synthesis thread loop (one sentence at a time)
+     */
+    void SynthesisLoop();
+    
+    /**
+     * @brief Start the time-to-first-audio clock unless a turn is in progress
+     */
+    void MarkTurnStart();
+    
+    /**
+     * @brief Watch the (always running) microphone for barge-in while the pet speaks
+     */
+    void UpdateMonitoring();
+    
+    /**
+     * @brief Wake the audio thread to re-check IsSpeaking (any thread, incl. callbacks)
+     */
+    void NotifySpeakingChanged();
+    
+    /**
+     * @brief Drop the interrupted turn and capture the user's utterance
+     */
+    void HandleBargeIn();
+    
+    /**
+     * @brief Energy gate against the pet's own output (capture callback)
+     * @param samples Device-format block, any rate and channel count
+     */
+    void DetectVoice(const float* samples, unsigned int sampleCount, bool monitoring);
+    
+    struct SpeechItem {
+        std::string text;
+        bool endOfTurn = false;
+        bool persist = false;  // Keep in the disk cache (scripted lines)
+        uint32_t epoch = 0;    // Items from before a barge-in are dropped
+    };
+    
+    /**
+     * @brief Get PCM for a sentence from the cache or by synthesizing it
+     * @param synthMs Set to the synthesis time (0 on a cache hit)
+     */
+    PcmClipPtr SynthesizeCached(const std::string& text, bool persist, double& synthMs);
     
     std::thread thread_;
     std::atomic<bool> running_{false};
     std::atomic<bool> recording_{false};
     std::atomic<bool> trigger_recording_{false};
+    WakeEvent audioEvent_;  // Wakes the audio thread; it never polls
     ThreadSafeQueue<AppEvent>* outputQueue_ = nullptr;
     int recording_seconds_ = DEFAULT_RECORDING_SECONDS;
     
     // ASR resources
-    const SherpaOnnxOfflineRecognizer* recognizer_ = nullptr;
-    ma_device* audio_device_ = nullptr;
+    std::unique_ptr<AsrEngine> asr_;  // Audio thread only once started
+    PauseSplitter pauseSplitter_{SAMPLE_RATE};
+    bool segmentedDecoding_ = true;
+    bool recognizerWarmup_ = true;
+    double warmupMs_ = 0.0;
+    double firstAsrMs_ = 0.0;
+    double firstAsrRtf_ = 0.0;
+    double laterAsrMsTotal_ = 0.0;
+    double laterAsrRtfTotal_ = 0.0;
+    uint64_t asrCalls_ = 0;
+    AudioSourceConfig sourceConfig_;
+    std::unique_ptr<AudioSource> captureSource_;
+    bool captureRunning_ = false;  // Audio thread only
     std::vector<float> audio_buffer_;
     std::mutex buffer_mutex_;
+    
+    // TTS: AI thread -> speechQueue_ -> synthesis thread -> ring -> playback callback
+    std::unique_ptr<TtsEngine> tts_;
+    std::thread ttsThread_;
+    ThreadSafeQueue<SpeechItem> speechQueue_;
+    SentenceSplitter splitter_;  // Fed from the AI thread only
+    std::unique_ptr<TtsCache> ttsCache_;
+    std::vector<std::string> prewarmPhrases_;  // Synthesis thread only once started
+    std::unique_ptr<SpscRing<float>> playbackRing_;
+    ma_device* playback_device_ = nullptr;
+    int playbackRate_ = 0;
+    
+    // Sound effects: published to the callback once fully loaded
+    std::unique_ptr<SoundMixer> mixer_;
+    std::atomic<SoundMixer*> activeMixer_{nullptr};
+    
+    // Time-to-first-audio measurement (steady_clock nanoseconds)
+    std::atomic<int64_t> turnStartNs_{0};
+    std::atomic<int64_t> firstAudioNs_{0};
+    std::atomic<bool> awaitingFirstAudio_{false};
+    
+    // Live audio: capture callback -> captureRing_ (device rate and channels)
+    // -> audio thread, which converts to SAMPLE_RATE mono, stores it, computes
+    // features once for its detectors and feeds the wake word
+    bool nativeCapture_ = true;
+    int captureRate_ = SAMPLE_RATE;
+    int captureChannels_ = CHANNELS;
+    std::unique_ptr<SpscRing<float>> captureRing_;
+    std::atomic<SpscRing<float>*> activeCaptureRing_{nullptr};
+    size_t captureSignalSamples_ = 0;  // Queued samples that wake the audio thread
+    Dsp::PolyphaseResampler captureResampler_;
+    std::vector<float> nativeChunk_, convertedChunk_, referenceChunk_;  // Audio thread scratch
+    std::unique_ptr<FeatureFrontend> frontend_;
+    FeatureRing::Reader vadReader_;
+    size_t vadFirstBand_ = 0;
+    size_t vadLastBand_ = 0;
+    float noiseFloorDb_ = 0.0f;
+    std::unique_ptr<KeywordSpotter> keywordSpotter_;
+    
+    // Capture cost: the callback records its own time, the audio thread how
+    // long samples waited for it
+    std::atomic<uint64_t> callbackCount_{0};
+    std::atomic<int64_t> callbackNsTotal_{0};
+    std::atomic<int64_t> callbackNsMax_{0};
+    std::atomic<int64_t> lastCaptureNs_{0};
+    std::atomic<uint64_t> captureOverruns_{0};  // Blocks dropped on a full ring
+    double deliveryMsTotal_ = 0.0;
+    double deliveryMsMax_ = 0.0;
+    uint64_t deliveries_ = 0;
+    
+    // Capture storage: the callback appends to pool chunks, utterances are
+    // moved to ASR; asrInput_ is reserved once for the longest recording
+    std::unique_ptr<AudioChunkPool> capturePool_;
+    SampleEncoding captureEncoding_ = SampleEncoding::Float32;
+    std::vector<float> asrInput_;
+    size_t reportedExhausted_ = 0;
+    
+    // Echo cancellation: playback callback -> referenceRing_ (16 kHz) ->
+    // capture callback pairs it with each mic block -> pairedReferenceRing_ ->
+    // audio thread stores it next to the converted mic and cancels
+    std::unique_ptr<EchoCanceller> echoCanceller_;
+    std::unique_ptr<SpscRing<float>> referenceRing_;
+    std::unique_ptr<SpscRing<float>> pairedReferenceRing_;
+    uint64_t referenceRemainder_ = 0;  // Capture callback only
+    std::atomic<SpscRing<float>*> activeReference_{nullptr};
+    Dsp::LinearResampler referenceResampler_;  // Playback callback only
+    std::vector<float> micFrame_, referenceFrame_, cleanedFrame_;  // Audio thread scratch
+    
+    // Conditioning of the recording (audio thread only)
+    std::unique_ptr<AudioConditioner> conditioner_;
+    size_t recordingProcessed_ = 0;  // Captured samples already processed
+    size_t conditionerSkip_ = 0;     // Delay-line output still to drop
+    
+    // Barge-in: capture callback detects, playback callback mutes, audio thread acts
+    std::function<void()> onBargeIn_;
+    bool bargeInEnabled_ = false;
+    bool playbackActive_ = false;  // Playback callback only
+    std::atomic<bool> monitoring_{false};
+    std::atomic<bool> bargeInDetected_{false};
+    std::atomic<bool> outputMuted_{false};
+    std::atomic<bool> replyActive_{false};    // AI thread is streaming a reply
+    std::atomic<bool> discardReply_{false};   // Rest of the interrupted reply is ignored
+    std::atomic<bool> synthesizing_{false};
+    std::atomic<uint32_t> speechEpoch_{0};
+    std::atomic<float> playbackLevel_{0.0f};  // Decaying peak of the output RMS
+    std::atomic<int64_t> lastVoiceNs_{0};
+    std::atomic<int64_t> voiceOnsetNs_{0};
+    std::atomic<int64_t> bargeInNs_{0};
+    std::atomic<int64_t> silencedNs_{0};
+    int64_t pendingOnsetNs_ = 0;  // Capture callback only
+    int64_t lastLoudNs_ = 0;      // Capture callback only
 };
 
 } // namespace DesktopPet
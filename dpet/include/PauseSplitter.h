@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+namespace DesktopPet {
+
+/**
+ * @brief When and how finely a recording is split
+ */
+struct SplitConfig {
+    float minRecordingSeconds = 6.0f;  // Shorter recordings are decoded whole
+    float minSegmentSeconds = 2.0f;    // Segments shorter than this lose too much context
+    int minPauseMs = 200;              // Silence that may be cut
+    float marginDb = 10.0f;            // Frames this far above the floor are speech
+    size_t maxSegments = 4;
+};
+
+/**
+ * @brief Samples [begin, end) of a recording
+ */
+struct SpeechSegment {
+    size_t begin = 0;
+    size_t end = 0;
+};
+
+/**
+ * @class PauseSplitter
+ * @brief Cuts a long recording at pauses so its parts can be decoded in parallel
+ *
+ * 10 ms frame levels are compared with the recording's own noise floor (a
+ * low percentile), so the same margin works for quiet and noisy input.
+ * Cuts go in the middle of a pause; segments come back in order and cover
+ * the whole recording.
+ */
+class PauseSplitter {
+public:
+    explicit PauseSplitter(int sampleRate, const SplitConfig& config = SplitConfig());
+
+    std::vector<SpeechSegment> Split(const float* samples, size_t count) const;
+
+    const SplitConfig& Config() const { return config_; }
+
+private:
+    int sampleRate_;
+    SplitConfig config_;
+};
+
+} // namespace DesktopPet
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+namespace DesktopPet {
+
+class MappedFile;
+
+/**
+ * @class PcmClip
+ * @brief Immutable mono float PCM, owned or viewed from a memory-mapped file
+ *
+ * Shared between caches and the audio callback via shared_ptr, so evicting a
+ * clip never frees samples that are still playing.
+ */
+class PcmClip {
+public:
+    static std::shared_ptr<const PcmClip> FromSamples(std::vector<float> samples, int sampleRate) {
+        auto clip = std::shared_ptr<PcmClip>(new PcmClip());
+        clip->owned_ = std::move(samples);
+        clip->data_ = clip->owned_.data();
+        clip->size_ = clip->owned_.size();
+        clip->sampleRate_ = sampleRate;
+        return clip;
+    }
+
+    static std::shared_ptr<const PcmClip> FromMapping(std::shared_ptr<const MappedFile> mapping,
+                                                      const float* data, size_t size, int sampleRate) {
+        auto clip = std::shared_ptr<PcmClip>(new PcmClip());
+        clip->mapping_ = std::move(mapping);
+        clip->data_ = data;
+        clip->size_ = size;
+        clip->sampleRate_ = sampleRate;
+        return clip;
+    }
+
+    const float* Data() const { return data_; }
+    size_t Size() const { return size_; }
+    int SampleRate() const { return sampleRate_; }
+    bool IsMapped() const { return mapping_ != nullptr; }
+
+private:
+    PcmClip() = default;
+
+    std::vector<float> owned_;
+    std::shared_ptr<const MappedFile> mapping_;
+    const float* data_ = nullptr;
+    size_t size_ = 0;
+    int sampleRate_ = 0;
+};
+
+using PcmClipPtr = std::shared_ptr<const PcmClip>;
+
+} // namespace DesktopPet
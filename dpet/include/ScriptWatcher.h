@@ -0,0 +1,85 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <filesystem>
+#include <map>
+
+namespace DesktopPet {
+
+/**
+ * @brief Result of compiling a changed script on the watcher thread
+ */
+struct CompiledScript {
+    std::string path;
+    std::string bytecode;   // lua_dump output, empty on error
+    std::string error;      // Syntax error message, empty on success
+};
+
+/**
+ * @class ScriptWatcher
+ * @brief Watches Lua script files and recompiles them in the background
+ *
+ * Uses inotify on Linux and directory change notifications on Windows, so
+ * the thread sleeps until a file is written. Bursts of events from one save
+ * are coalesced before compiling. Compilation happens in a scratch Lua
+ * state; only the bytecode is handed over, so loading it on the main thread
+ * at a frame boundary is cheap.
+ */
+class ScriptWatcher {
+public:
+    using Callback = std::function<void(CompiledScript&&)>;
+
+    ScriptWatcher() = default;
+    ~ScriptWatcher();
+
+    // Disable copy
+    ScriptWatcher(const ScriptWatcher&) = delete;
+    ScriptWatcher& operator=(const ScriptWatcher&) = delete;
+
+    /**
+     * @brief Start watching files
+     * @param paths Script files to watch
+     * @param onCompiled Called on the watcher thread after each recompile
+     */
+    bool Start(const std::vector<std::string>& paths, Callback onCompiled);
+
+    /**
+     * @brief Stop the watcher thread
+     */
+    void Stop();
+
+    bool IsRunning() const { return running_; }
+
+    /**
+     * @brief Compile a Lua file to bytecode without running it
+     */
+    static CompiledScript Compile(const std::string& path);
+
+private:
+    void ThreadLoop();
+
+    /**
+     * @brief Block until a watched file changes or Stop() is called
+     * @return Paths of changed files (empty when stopping)
+     */
+    std::vector<std::string> WaitForChanges();
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::vector<std::string> paths_;
+    Callback onCompiled_;
+
+    // Platform handles (inotify/eventfd on Linux, change + stop events on Windows)
+    int notifyFd_ = -1;
+    int wakeFd_ = -1;
+    std::map<int, std::string> watchedDirectories_;  // inotify watch descriptor -> directory
+    std::vector<void*> changeHandles_;
+    void* stopEvent_ = nullptr;
+    std::vector<std::filesystem::file_time_type> lastWrite_;
+};
+
+} // namespace DesktopPet
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <array>
+#include <atomic>
+#include <unordered_map>
+#include <cstdint>
+#include "AudioRing.h"
+#include "PcmClip.h"
+
+namespace DesktopPet {
+
+/**
+ * @class SoundMixer
+ * @brief Sound-effect voices mixed inside the playback callback
+ *
+ * Sounds are decoded to float PCM at the device rate when loaded. Trigger()
+ * only pushes a small command into a lock-free ring; the callback starts the
+ * voice at its next period and mixes all active voices with SIMD. The audio
+ * thread never allocates or locks.
+ *
+ * Threading: Load* before the mixer is handed to the callback, Trigger from
+ * one thread (the main thread), Mix from the audio callback.
+ */
+class SoundMixer {
+public:
+    static constexpr size_t kMaxVoices = 16;
+
+    explicit SoundMixer(int sampleRate) : sampleRate_(sampleRate) {}
+
+    // Disable copy
+    SoundMixer(const SoundMixer&) = delete;
+    SoundMixer& operator=(const SoundMixer&) = delete;
+
+    /**
+     * @brief Decode a sound file (wav/mp3/flac) into memory
+     */
+    bool Load(const std::string& name, const std::string& path);
+
+    /**
+     * @brief Load every sound in a directory, named by file stem
+     * @return Number of sounds loaded
+     */
+    size_t LoadDirectory(const std::string& dir);
+
+    bool HasSound(const std::string& name) const { return names_.count(name) > 0; }
+
+    /**
+     * @brief Start a sound (main thread)
+     * @return false if the sound is unknown or the command ring is full
+     */
+    bool Trigger(const std::string& name, float gain = 1.0f);
+
+    /**
+     * @brief Add active voices into out (audio callback)
+     */
+    void Mix(float* out, size_t frames);
+
+    /**
+     * @brief Print trigger counts and trigger-to-callback latency
+     */
+    void PrintStats() const;
+
+private:
+    struct Command {
+        uint32_t sound;
+        float gain;
+        int64_t triggerNs;
+    };
+
+    struct Voice {
+        const float* data = nullptr;
+        size_t size = 0;
+        size_t position = 0;
+        float gain = 0.0f;
+        bool active = false;
+    };
+
+    void StartVoice(const Command& command);
+
+    int sampleRate_;
+    std::vector<PcmClipPtr> sounds_;
+    std::unordered_map<std::string, uint32_t> names_;
+
+    SpscRing<Command> commands_{64};
+    std::array<Voice, kMaxVoices> voices_;
+
+    // Written by the callback, read for stats
+    std::atomic<uint64_t> started_{0};
+    std::atomic<uint64_t> stolen_{0};
+    std::atomic<int64_t> latencySumNs_{0};
+    std::atomic<int64_t> latencyMaxNs_{0};
+    uint64_t dropped_ = 0;
+};
+
+} // namespace DesktopPet
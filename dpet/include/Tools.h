@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace DesktopPet {
+
+/**
+ * @brief Developer tools - headless benchmarks and offline tests
+ *
+ * Invoked as `dpet_tricore <command> [args...]`; each command runs without
+ * creating a window and returns a process exit code.
+ */
+namespace Tools {
+
+/**
+ * @brief Check whether argv[1] names a tool command
+ */
+bool IsToolCommand(const std::string& name);
+
+/**
+ * @brief Run a tool command
+ * @param args Command name followed by its arguments
+ * @return Process exit code
+ */
+int Run(const std::vector<std::string>& args);
+
+} // namespace Tools
+
+} // namespace DesktopPet
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include "PcmClip.h"
+
+namespace DesktopPet {
+
+/**
+ * @class TtsCache
+ * @brief Synthesized phrase cache keyed by (voice, speed, normalized text)
+ *
+ * A byte-bounded in-memory LRU sits in front of an optional on-disk store
+ * with one file per phrase. Disk entries are memory-mapped on lookup and
+ * played straight from the mapping, so a repeated line costs no synthesis
+ * and no copy. Thread-safe.
+ */
+class TtsCache {
+public:
+    /**
+     * @param memoryBytes LRU budget for PCM held in memory
+     * @param diskDir Directory for persisted clips (empty = memory only)
+     */
+    explicit TtsCache(size_t memoryBytes = 16 * 1024 * 1024, std::string diskDir = "");
+
+    /**
+     * @brief Build a cache key; text is trimmed and whitespace runs collapsed
+     */
+    static std::string MakeKey(const std::string& voice, float speed, const std::string& text);
+
+    /**
+     * @brief Find a clip in memory, then on disk
+     * @return nullptr on miss
+     */
+    PcmClipPtr Lookup(const std::string& key);
+
+    /**
+     * @brief Insert a clip
+     * @param persist Also write it to the disk store (scripted/prewarmed lines)
+     */
+    void Store(const std::string& key, const PcmClipPtr& clip, bool persist);
+
+    struct Stats {
+        size_t memoryHits = 0;
+        size_t diskHits = 0;
+        size_t misses = 0;
+        size_t entries = 0;
+        size_t memoryBytes = 0;
+    };
+
+    Stats GetStats() const;
+
+private:
+    struct Entry {
+        std::string key;
+        PcmClipPtr clip;
+    };
+
+    void InsertLocked(const std::string& key, const PcmClipPtr& clip);
+    std::string DiskPath(const std::string& key) const;
+    PcmClipPtr LoadFromDisk(const std::string& key) const;
+    bool SaveToDisk(const std::string& key, const PcmClip& clip) const;
+
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_;  // Most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    size_t memoryBudget_;
+    size_t memoryUsed_ = 0;
+    std::string diskDir_;
+
+    Stats stats_;
+};
+
+/**
+ * @brief Read a phrase list (one phrase per line, '#' comments)
+ */
+std::vector<std::string> LoadPhraseList(const std::string& path);
+
+} // namespace DesktopPet
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Forward declaration for sherpa-onnx TTS
+struct SherpaOnnxOfflineTts;
+
+namespace DesktopPet {
+
+enum class TtsModelType {
+    Vits,       // VITS / MeloTTS
+    Matcha,     // Matcha acoustic model + vocoder
+    Kokoro
+};
+
+/**
+ * @brief Text-to-speech model settings
+ *
+ * Files are looked up in modelDir using the names of the sherpa-onnx
+ * release archives (model.onnx, tokens.txt, lexicon.txt, ...).
+ */
+struct TtsConfig {
+    TtsModelType type = TtsModelType::Vits;
+    std::string modelDir;
+    int speakerId = 0;
+    float speed = 1.0f;
+    int numThreads = 2;
+};
+
+/**
+ * @class TtsEngine
+ * @brief sherpa-onnx offline TTS wrapper (one sentence per call)
+ */
+class TtsEngine {
+public:
+    TtsEngine() = default;
+    ~TtsEngine();
+
+    // Disable copy
+    TtsEngine(const TtsEngine&) = delete;
+    TtsEngine& operator=(const TtsEngine&) = delete;
+
+    /**
+     * @brief Load the TTS model
+     */
+    bool Init(const TtsConfig& config);
+
+    /**
+     * @brief Synthesize text (blocking)
+     * @param samples Receives mono float PCM at GetSampleRate()
+     */
+    bool Synthesize(const std::string& text, std::vector<float>& samples);
+
+    int GetSampleRate() const { return sampleRate_; }
+    bool IsReady() const { return tts_ != nullptr; }
+    const TtsConfig& GetConfig() const { return config_; }
+
+    /**
+     * @brief Identify the voice (model + speaker) for cache keys
+     */
+    std::string VoiceId() const;
+
+private:
+    const SherpaOnnxOfflineTts* tts_ = nullptr;
+    TtsConfig config_;
+    int sampleRate_ = 0;
+};
+
+/**
+ * @class SentenceSplitter
+ * @brief Cuts a streamed LLM reply into sentences for synthesis
+ *
+ * Splits on sentence-final punctuation (CJK and ASCII) and newlines. The
+ * first clause of a reply is also cut at a comma once it is long enough,
+ * so speech can start before the first full sentence is generated.
+ */
+class SentenceSplitter {
+public:
+    /**
+     * @param firstClauseBytes Comma split threshold for the first segment
+     * @param maxClauseBytes Comma split threshold afterwards
+     */
+    explicit SentenceSplitter(size_t firstClauseBytes = 18, size_t maxClauseBytes = 120)
+        : firstClauseBytes_(firstClauseBytes), maxClauseBytes_(maxClauseBytes) {}
+
+    /**
+     * @brief Append a token piece
+     * @param sentences Receives every segment completed by this piece
+     */
+    void Feed(const std::string& piece, std::vector<std::string>& sentences);
+
+    /**
+     * @brief End of reply: return the remaining text and reset
+     */
+    std::string Flush();
+
+    /**
+     * @brief Split a complete text in one go
+     */
+    static std::vector<std::string> Split(const std::string& text);
+
+private:
+    void Emit(size_t end, std::vector<std::string>& sentences);
+
+    std::string pending_;
+    size_t scanned_ = 0;
+    size_t emitted_ = 0;
+    size_t firstClauseBytes_;
+    size_t maxClauseBytes_;
+};
+
+} // namespace DesktopPet
@@ -3,8 +3,12 @@
 #include <queue>
 #include <mutex>
 #include <condition_variable>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
 #include <string>
 #include <optional>
+#include <cctype>
 
 namespace DesktopPet {
 
@@ -106,6 +110,66 @@ private:
     bool shutdown_ = false;
 };
 
+/**
+ * @brief Auto-reset event: wakes one waiting thread, remembered until consumed
+ *
+ * Signal() sets an atomic flag and posts an OS wakeup (SetEvent on Windows,
+ * a byte on a non-blocking pipe elsewhere); it takes no lock and never
+ * blocks, so realtime audio callbacks may call it. Repeated signals before
+ * the waiter runs coalesce into one.
+ */
+class WakeEvent {
+public:
+    WakeEvent();
+    ~WakeEvent();
+    
+    // Disable copy
+    WakeEvent(const WakeEvent&) = delete;
+    WakeEvent& operator=(const WakeEvent&) = delete;
+    
+    void Signal();
+    
+    /**
+     * @brief Block until signaled
+     */
+    void Wait() {
+        while (!signaled_.exchange(false, std::memory_order_acquire)) {
+            Block(-1);
+        }
+    }
+    
+    /**
+     * @brief Block until signaled or the deadline passes
+     * @return true if signaled
+     */
+    template<typename Clock, typename Duration>
+    bool WaitUntil(const std::chrono::time_point<Clock, Duration>& deadline) {
+        while (!signaled_.exchange(false, std::memory_order_acquire)) {
+            auto remaining = deadline - Clock::now();
+            if (remaining <= Duration::zero()) {
+                return false;
+            }
+            // Round up so the wait doesn't end just short of the deadline
+            auto ms = std::chrono::ceil<std::chrono::milliseconds>(remaining).count();
+            Block(static_cast<int>(std::min<long long>(ms, 60000)));
+        }
+        return true;
+    }
+    
+private:
+    /**
+     * @brief Sleep until the OS wakeup is posted or timeoutMs passes (-1 = no timeout)
+     */
+    void Block(int timeoutMs);
+    
+    std::atomic<bool> signaled_{false};
+#ifdef _WIN32
+    void* event_ = nullptr;
+#else
+    int pipe_[2] = {-1, -1};
+#endif
+};
+
 // Event types for cross-thread communication
 enum class EventType {
     AUDIO_INPUT,    // Audio input received from microphone
@@ -113,9 +177,50 @@ enum class EventType {
     EXEC_LUA,       // Execute Lua script
     UI_UPDATE,      // Update UI (e.g., change expression)
     SHOW_BUBBLE,    // Show chat bubble with message
-    SHUTDOWN        // Shutdown signal
+    TOKEN_DELTA,    // Streamed LLM output piece
+    SPEAK,          // Speak a line with TTS (scripted, cacheable)
+    SHUTDOWN,       // Shutdown signal
+    COUNT           // Number of event types (not an event)
 };
 
+constexpr size_t EVENT_TYPE_COUNT = static_cast<size_t>(EventType::COUNT);
+
+/**
+ * @brief Get the name of an event type (as used by Lua events.on)
+ */
+inline const char* EventTypeName(EventType type) {
+    switch (type) {
+        case EventType::AUDIO_INPUT: return "AUDIO_INPUT";
+        case EventType::AI_THINK:    return "AI_THINK";
+        case EventType::EXEC_LUA:    return "EXEC_LUA";
+        case EventType::UI_UPDATE:   return "UI_UPDATE";
+        case EventType::SHOW_BUBBLE: return "SHOW_BUBBLE";
+        case EventType::TOKEN_DELTA: return "TOKEN_DELTA";
+        case EventType::SPEAK:       return "SPEAK";
+        case EventType::SHUTDOWN:    return "SHUTDOWN";
+        default:                     return "UNKNOWN";
+    }
+}
+
+/**
+ * @brief Parse an event type name (case-insensitive)
+ * @return false if the name is unknown
+ */
+inline bool ParseEventType(const std::string& name, EventType& type) {
+    std::string upper = name;
+    for (char& c : upper) {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+    for (size_t i = 0; i < EVENT_TYPE_COUNT; ++i) {
+        EventType candidate = static_cast<EventType>(i);
+        if (upper == EventTypeName(candidate)) {
+            type = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
 // Application event structure
 struct AppEvent {
     EventType type;
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace DesktopPet {
+
+/**
+ * @brief The WAV files of a corpus, as the tools and the batch demo read it
+ *
+ * A directory is searched recursively for .wav files (extension in any case)
+ * and sorted by path; a single .wav is itself; anything else is a manifest
+ * with one path per line, relative to the manifest's directory, where lines
+ * starting with # are comments.
+ */
+std::vector<std::string> CollectWavFiles(const std::string& input);
+
+/**
+ * @brief Decode an audio file to mono float at sampleRate (replaces samples)
+ */
+bool LoadWavMono(const std::string& path, int sampleRate, std::vector<float>& samples);
+
+/**
+ * @brief Nearest-rank percentile (p in 0..1) of values, 0 if empty
+ */
+double Percentile(std::vector<double> values, double p);
+
+} // namespace DesktopPet
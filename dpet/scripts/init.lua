@@ -3,14 +3,27 @@
 
 print("=== Desktop Pet Lua Script Initialized ===")
 
+-- Data that should survive a hot reload lives in `state`
+state = state or { clicks = 0 }
+
+-- Called after the script is hot-reloaded; oldState is the previous
+-- `state` table (or whatever the old onSaveState() returned)
+function onReload(oldState)
+    if oldState then
+        state = oldState
+    end
+    pet.log("Script reloaded (clicks so far: " .. state.clicks .. ")")
+end
+
 -- Called when pet starts
 function onInit()
     pet.log("Pet is starting up!")
-    pet.say("你好！我是桌面宠物~")
+    pet.speak("你好！我是桌面宠物~")
 end
 
 -- Called when user clicks on the pet
 function onClick(x, y)
+    state.clicks = state.clicks + 1
     pet.log("Clicked at: " .. x .. ", " .. y)
     
     -- Random greetings
@@ -23,7 +36,7 @@ function onClick(x, y)
     }
     
     local index = math.random(1, #greetings)
-    pet.say(greetings[index])
+    pet.speak(greetings[index])
 end
 
 -- Called on key press
@@ -68,6 +81,42 @@ ESC - 退出]]
     pet.showMessage(helpText)
 end
 
+-- Behavior tree: ticked natively every frame, only the active branch runs.
+-- Higher entries in bt.priority interrupt lower ones (e.g. a click cuts an
+-- idle animation short).
+bt.run(bt.priority{
+    -- React to clicks without asking the LLM
+    bt.sequence{
+        bt.flag("click"),
+        bt.expression("happy"),
+        bt.speak({"你好呀！", "需要什么帮助吗？", "喵~", "点我干嘛？", "别戳我！"}),
+        bt.wait(2.0),
+        bt.expression("idle"),
+    },
+    -- Look attentive while a voice request is being answered
+    bt.sequence{
+        bt.flag("heard"),
+        bt.expression("thinking"),
+        bt.wait(1.5),
+        bt.expression("idle"),
+    },
+    -- Idle loop: occasionally stretch or doze off
+    bt.sequence{
+        bt.wait(20.0),
+        bt.selector{
+            bt.sequence{ bt.chance(0.3), bt.expression("sleepy"), bt.wait(5.0) },
+            bt.sequence{ bt.chance(0.5), bt.expression("stretch"), bt.wait(2.0) },
+        },
+        bt.expression("idle"),
+    },
+})
+
+-- Event subscriptions: handlers receive (payload, typeName) directly,
+-- no Lua source is generated or compiled per event
+events.on("AUDIO_INPUT", function(text)
+    pet.log("Heard: " .. text)
+end)
+
 -- Example: Schedule a greeting after startup
 -- (In real use, you'd implement a timer system)
 pet.log("Initialization complete!")
@@ -2,6 +2,9 @@
 #include <SDL_image.h>
 #include <SDL_syswm.h>
 #include <iostream>
+#include <iomanip>
+#include <filesystem>
+#include <algorithm>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -9,15 +12,23 @@
 
 namespace DesktopPet {
 
+namespace {
+
+constexpr size_t kMaxPendingPrompts = 4;  // Prompts held while the LLM loads
+
+} // namespace
+
 App::~App() {
     Shutdown();
 }
 
 bool App::Init() {
+    startupBegin_ = std::chrono::steady_clock::now();
     std::cout << "=== Desktop Pet Tri-Core Architecture ===" << std::endl;
     std::cout << "Initializing..." << std::endl;
     
     // Initialize SDL
+    double phaseStart = StartupMs();
     if (!InitSDL()) {
         return false;
     }
@@ -39,55 +50,237 @@ bool App::Init() {
         std::cerr << "[App] Failed to load pet texture" << std::endl;
         return false;
     }
+    MarkPhase("window", "main", phaseStart);
     
     // Initialize Script Runner
+    phaseStart = StartupMs();
     if (!scriptRunner_->Init(&eventQueue_)) {
         std::cerr << "[App] Failed to initialize ScriptRunner" << std::endl;
         return false;
     }
     
-    // Initialize ASR
-    std::string asrModelDir = "F:/ollama/model/SenseVoidSmall-onnx-official";
-    std::cout << "[App] Initializing ASR..." << std::endl;
-    if (!audioManager_->InitializeRecognizer(asrModelDir)) {
-        std::cerr << "[App] Failed to initialize ASR" << std::endl;
-        return false;
+    // Load pet script (behavior tree, callbacks); optional
+    if (scriptRunner_->LoadFile("scripts/init.lua")) {
+        scriptRunner_->CallFunction("onInit");
+        scriptRunner_->EnableHotReload();
     }
+    MarkPhase("scripts", "main", phaseStart);
+    
+    // ASR: the backend from the config file, SenseVoice without one. A bad
+    // config is reported now rather than after the window is up
+    AsrConfig asrConfig;
+    asrConfig.modelDir = "F:/ollama/model/SenseVoidSmall-onnx-official";
+    if (std::filesystem::exists(asrConfigPath_) || !asrBackend_.empty()) {
+        AsrConfigFile asrFile;
+        if (!LoadAsrConfigFile(asrConfigPath_, asrFile)) {
+            return false;
+        }
+        const AsrConfig* selected = asrBackend_.empty() ? asrFile.Active() : asrFile.Find(asrBackend_);
+        if (!selected) {
+            std::cerr << "[App] No ASR backend \"" << asrBackend_ << "\" in " << asrConfigPath_ << std::endl;
+            return false;
+        }
+        asrConfig = *selected;
+    }
+    audioManager_->SetAudioSource(audioSource_);
     
-    // Initialize LLM
     // std::string llmModelPath = "F:/ollama/model/qwen2.5_7b_q4k/qwen2.5-7b-instruct-q4_k_m-00001-of-00002.gguf";
     std::string llmModelPath = "F:/ollama/model/qwen2.5_7b_q4k/qwen2.5-3b-instruct-q4_k_m.gguf";
-    std::cout << "[App] Initializing LLM..." << std::endl;
-    if (!aiEngine_->InitializeLLM(llmModelPath)) {
-        std::cerr << "[App] Failed to initialize LLM" << std::endl;
-        return false;
-    }
     
-    // Start AI Engine thread
-    std::cout << "[App] eventQueue_ address: " << &eventQueue_ << std::endl;
-    aiEngine_->Start(&eventQueue_, &eventQueue_);
+    // Load the models while the pet is already on screen; PollLoading
+    // starts the audio and AI threads as each side becomes ready
+    uiManager_->SetExpression("loading");
+    ShowLoadingStatus();
+    audioLoader_ = std::thread(&App::LoadAudio, this, asrConfig);
+    llmLoader_ = std::thread(&App::LoadLLM, this, llmModelPath);
     
-    // Start Audio Manager thread
-    audioManager_->Start(&eventQueue_);
-    
-    std::cout << "[App] Initialization complete" << std::endl;
+    std::cout << "[App] Window ready, loading models in the background" << std::endl;
     std::cout << "Architecture:" << std::endl;
     std::cout << "  - Main Thread: UI rendering + Lua execution" << std::endl;
-    std::cout << "  - Logic Thread: LLM (Qwen2.5-7B)" << std::endl;
-    std::cout << "  - Audio Thread: ASR (SenseVoice)" << std::endl;
+    std::cout << "  - Logic Thread: LLM (" << std::filesystem::path(llmModelPath).stem().string() << ")" << std::endl;
+    std::cout << "  - Audio Thread: ASR (" << asrConfig.name << ") + TTS synthesis" << std::endl;
     std::cout << std::endl;
     std::cout << "Controls:" << std::endl;
     std::cout << "  - SPACE: Start/Stop voice recording (max 5s)" << std::endl;
+    std::cout << "  - Wake word: start a recording hands-free (ends at a pause)" << std::endl;
     std::cout << "  - H: Test hello message" << std::endl;
     std::cout << "  - T: Test time query" << std::endl;
     std::cout << "  - ESC: Exit" << std::endl;
     std::cout << "  - Drag with mouse to move pet" << std::endl;
-    std::cout << "  - Logic Thread: AI thinking" << std::endl;
-    std::cout << "  - Audio Thread: ASR/TTS simulation" << std::endl;
+    std::cout << "  Messages sent while the models load are answered once they are ready" << std::endl;
     
     return true;
 }
 
+void App::LoadAudio(AsrConfig asrConfig) {
+    double phaseStart = StartupMs();
+    std::cout << "[App] Initializing ASR..." << std::endl;
+    if (!audioManager_->InitializeRecognizer(asrConfig)) {
+        std::cerr << "[App] Failed to initialize ASR" << std::endl;
+        audioState_ = LoadState::Failed;
+        return;
+    }
+    MarkPhase("asr (" + asrConfig.name + ")", "audio loader", phaseStart);
+    
+    // Wake word (optional: SPACE still starts a recording)
+    phaseStart = StartupMs();
+    KwsConfig kwsConfig;
+    kwsConfig.modelDir = "F:/ollama/model/sherpa-onnx-kws-zipformer-wenetspeech-3.3M-2024-01-01";
+    if (!audioManager_->EnableWakeWord(kwsConfig)) {
+        std::cout << "[App] Wake word unavailable, press SPACE to talk" << std::endl;
+    }
+    MarkPhase("wake word", "audio loader", phaseStart);
+    
+    // Initialize TTS (optional: without a voice model replies are only shown)
+    phaseStart = StartupMs();
+    TtsConfig ttsConfig;
+    ttsConfig.type = TtsModelType::Vits;
+    ttsConfig.modelDir = "F:/ollama/model/vits-melo-tts-zh_en";
+    std::cout << "[App] Initializing TTS..." << std::endl;
+    if (audioManager_->InitializeTTS(ttsConfig)) {
+        // Repeated pet lines play from cache instead of competing with the LLM for CPU
+        audioManager_->EnableSpeechCache("cache/tts", "scripts/phrases.txt");
+    } else {
+        std::cerr << "[App] TTS unavailable, continuing without speech" << std::endl;
+    }
+    MarkPhase("tts", "audio loader", phaseStart);
+    
+    // Sound effects share the playback device with TTS
+    phaseStart = StartupMs();
+    audioManager_->InitializeSoundEffects("assets/sounds");
+    
+    // Keep the pet's own voice and sounds out of what ASR hears
+    audioManager_->EnableEchoCancellation();
+    // Even out distant, quiet or noisy speech before it reaches ASR
+    audioManager_->EnableConditioning();
+    
+    // Talking over the pet stops its speech and the reply being generated
+    // (a no-op until the LLM is loaded and generating)
+    audioManager_->EnableBargeIn([this]() { aiEngine_->CancelGeneration(); });
+    MarkPhase("effects + dsp", "audio loader", phaseStart);
+    
+    audioState_ = LoadState::Ready;
+}
+
+void App::LoadLLM(std::string modelPath) {
+    double phaseStart = StartupMs();
+    std::cout << "[App] Initializing LLM..." << std::endl;
+    if (!aiEngine_->InitializeLLM(modelPath)) {
+        std::cerr << "[App] Failed to initialize LLM" << std::endl;
+        llmState_ = LoadState::Failed;
+        return;
+    }
+    MarkPhase("llm", "llm loader", phaseStart);
+    llmState_ = LoadState::Ready;
+}
+
+void App::PollLoading() {
+    if (aiStarted_ && audioStarted_) {
+        return;
+    }
+    
+    // Either model was required before; keep failing the same way
+    if (audioState_ == LoadState::Failed || llmState_ == LoadState::Failed) {
+        std::cerr << "[App] Model loading failed, exiting" << std::endl;
+        running_ = false;
+        return;
+    }
+    
+    if (!audioStarted_ && audioState_ == LoadState::Ready) {
+        audioLoader_.join();
+        scriptRunner_->SetAudioManager(audioManager_.get());
+        audioManager_->Start(&eventQueue_);
+        audioStarted_ = true;
+        for (const auto& line : pendingSpeech_) {
+            audioManager_->Speak(line);
+        }
+        pendingSpeech_.clear();
+        std::cout << "[App] Audio ready after " << static_cast<int>(StartupMs()) << " ms" << std::endl;
+        if (!aiStarted_) {
+            ShowLoadingStatus();
+        }
+    }
+    
+    // The AI thread starts last: replies are spoken through the audio side
+    if (!aiStarted_ && audioStarted_ && llmState_ == LoadState::Ready) {
+        llmLoader_.join();
+        
+        // Speak replies sentence by sentence while they are generated (without
+        // TTS this still tells the audio thread when the pet is replying)
+        aiEngine_->SetStreamCallbacks(
+            [this](const std::string& piece) { audioManager_->FeedSpeech(piece); },
+            [this]() { audioManager_->FlushSpeech(); });
+        
+        // Start AI Engine thread
+        aiEngine_->Start(&eventQueue_, &eventQueue_);
+        aiStarted_ = true;
+        MarkPhase("ready", "main", 0.0);
+        
+        uiManager_->SetExpression("idle");
+        if (pendingPrompts_.empty()) {
+            uiManager_->ShowBubble("准备好啦！");
+        }
+        for (const auto& prompt : pendingPrompts_) {
+            eventQueue_.push(AppEvent(EventType::AI_THINK, prompt));
+        }
+        pendingPrompts_.clear();
+        
+        std::cout << "[App] Initialization complete" << std::endl;
+        PrintStartupTimeline();
+    }
+}
+
+void App::SubmitToAI(const std::string& prompt) {
+    if (aiStarted_) {
+        eventQueue_.push(AppEvent(EventType::AI_THINK, prompt));
+        return;
+    }
+    
+    // Keep the latest few; a burst of clicks shouldn't become a backlog of replies
+    if (pendingPrompts_.size() >= kMaxPendingPrompts) {
+        pendingPrompts_.erase(pendingPrompts_.begin());
+    }
+    pendingPrompts_.push_back(prompt);
+    std::cout << "[App] LLM still loading, queued: " << prompt << std::endl;
+    uiManager_->ShowBubble("等我一下，我还在醒过来...");
+}
+
+void App::ShowLoadingStatus() {
+    if (audioStarted_) {
+        uiManager_->ShowBubble("耳朵准备好了，脑子还在加载...");
+    } else {
+        uiManager_->ShowBubble("正在加载模型...");
+    }
+}
+
+double App::StartupMs() const {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupBegin_).count();
+}
+
+void App::MarkPhase(const std::string& name, const std::string& thread, double startMs) {
+    double endMs = StartupMs();
+    std::lock_guard<std::mutex> lock(startupMutex_);
+    startupPhases_.push_back({name, thread, startMs, endMs});
+}
+
+void App::PrintStartupTimeline() {
+    std::lock_guard<std::mutex> lock(startupMutex_);
+    std::sort(startupPhases_.begin(), startupPhases_.end(),
+        [](const StartupPhase& a, const StartupPhase& b) { return a.startMs < b.startMs; });
+    
+    std::cout << "[App] Startup timeline (ms since launch):" << std::endl;
+    std::cout << "  " << std::left << std::setw(24) << "phase" << std::setw(14) << "thread"
+              << std::right << std::setw(8) << "start" << std::setw(8) << "end" << std::setw(8) << "took" << std::endl;
+    std::cout << std::fixed << std::setprecision(0);
+    for (const auto& phase : startupPhases_) {
+        std::cout << "  " << std::left << std::setw(24) << phase.name << std::setw(14) << phase.thread
+                  << std::right << std::setw(8) << phase.startMs << std::setw(8) << phase.endMs
+                  << std::setw(8) << (phase.endMs - phase.startMs) << std::endl;
+    }
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6);
+}
+
 bool App::InitSDL() {
 #ifdef _WIN32
     // Enable UTF-8 console output
@@ -191,6 +384,7 @@ void App::ProcessEvents() {
     static bool isDragging = false;
     static int dragOffsetX = 0;
     static int dragOffsetY = 0;
+    static bool dragSoundPlayed = false;
     
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
@@ -204,7 +398,10 @@ void App::ProcessEvents() {
                     running_ = false;
                 } else if (event.key.keysym.sym == SDLK_SPACE) {
                     // Toggle recording: start or stop
-                    if (audioManager_) {
+                    if (!audioStarted_) {
+                        std::cout << "[App] ASR still loading, recording not started" << std::endl;
+                        ShowLoadingStatus();
+                    } else if (audioManager_) {
                         if (audioManager_->IsRecording()) {
                             std::cout << "[App] Stopping recording..." << std::endl;
                             audioManager_->StopRecording();
@@ -215,10 +412,10 @@ void App::ProcessEvents() {
                     }
                 } else if (event.key.keysym.sym == SDLK_h) {
                     // Manual test: say hello
-                    eventQueue_.push(AppEvent(EventType::AI_THINK, "hello"));
+                    SubmitToAI("hello");
                 } else if (event.key.keysym.sym == SDLK_t) {
                     // Manual test: ask time
-                    eventQueue_.push(AppEvent(EventType::AI_THINK, "what time is it"));
+                    SubmitToAI("what time is it");
                 }
                 break;
                 
@@ -227,8 +424,17 @@ void App::ProcessEvents() {
                     isDragging = true;
                     dragOffsetX = event.button.x;
                     dragOffsetY = event.button.y;
+                    dragSoundPlayed = false;
                     std::cout << "[App] Pet clicked" << std::endl;
-                    eventQueue_.push(AppEvent(EventType::AI_THINK, "user clicked me"));
+                    if (audioStarted_) {
+                        audioManager_->PlayEffect("click");
+                    }
+                    if (scriptRunner_->HasBehavior()) {
+                        // Reactions are handled natively by the behavior tree
+                        scriptRunner_->SetBehaviorFlag("click");
+                    } else {
+                        SubmitToAI("user clicked me");
+                    }
                 }
                 break;
                 
@@ -240,6 +446,10 @@ void App::ProcessEvents() {
                 
             case SDL_MOUSEMOTION:
                 if (isDragging) {
+                    if (!dragSoundPlayed && audioStarted_) {
+                        audioManager_->PlayEffect("drag");
+                        dragSoundPlayed = true;
+                    }
                     int mouseX, mouseY;
                     SDL_GetGlobalMouseState(&mouseX, &mouseY);
                     int newX = mouseX - dragOffsetX;
@@ -269,7 +479,15 @@ void App::ProcessAppEvents() {
         eventCount++;
         AppEvent event = eventOpt.value();
         
-        std::cout << "[App] Processing event #" << eventCount << ", type: " << static_cast<int>(event.type) << std::endl;
+        // Script subscribers (events.on) see every event before C++ handling
+        scriptRunner_->Dispatch(event);
+        
+        // Token deltas arrive once per generated token; keep the log readable
+        if (event.type == EventType::TOKEN_DELTA) {
+            continue;
+        }
+        
+        std::cout << "[App] Processing event #" << eventCount << ", type: " << EventTypeName(event.type) << std::endl;
         
         switch (event.type) {
             case EventType::EXEC_LUA:
@@ -279,6 +497,10 @@ void App::ProcessAppEvents() {
                 
             case EventType::UI_UPDATE:
                 uiManager_->HandleEvent(event);
+                // Expression changes play the sound of the same name, if any
+                if (audioStarted_) {
+                    audioManager_->PlayEffect(event.payload);
+                }
                 break;
                 
             case EventType::SHOW_BUBBLE:
@@ -286,10 +508,19 @@ void App::ProcessAppEvents() {
                 uiManager_->ShowBubble(event.payload);
                 break;
                 
+            case EventType::SPEAK:
+                if (audioStarted_) {
+                    audioManager_->Speak(event.payload);
+                } else {
+                    pendingSpeech_.push_back(event.payload);
+                }
+                break;
+                
             case EventType::AUDIO_INPUT:
                 std::cout << "[App] Audio input received: " << event.payload << std::endl;
+                scriptRunner_->SetBehaviorFlag("heard");
                 // Forward to AI for processing
-                eventQueue_.push(AppEvent(EventType::AI_THINK, event.payload));
+                SubmitToAI(event.payload);
                 break;
                 
             case EventType::SHUTDOWN:
@@ -303,11 +534,22 @@ void App::ProcessAppEvents() {
 }
 
 void App::Update(float deltaTime) {
+    PollLoading();
+    
+    // Frame boundary: swap in scripts recompiled by the watcher
+    scriptRunner_->PollReload();
+    
     uiManager_->Update(deltaTime);
+    scriptRunner_->TickBehavior(deltaTime);
 }
 
 void App::Render() {
     uiManager_->Render();
+    
+    if (!firstFrameDrawn_) {
+        firstFrameDrawn_ = true;
+        MarkPhase("first frame", "main", 0.0);
+    }
 }
 
 void App::Shutdown() {
@@ -319,6 +561,17 @@ void App::Shutdown() {
     
     running_ = false;
     
+    // A model load can't be interrupted; wait for it so nothing outlives the managers
+    if (audioLoader_.joinable() || llmLoader_.joinable()) {
+        std::cout << "[App] Waiting for model loading to finish..." << std::endl;
+        if (audioLoader_.joinable()) {
+            audioLoader_.join();
+        }
+        if (llmLoader_.joinable()) {
+            llmLoader_.join();
+        }
+    }
+    
     // Stop threads
     if (aiEngine_) {
         aiEngine_->Stop();
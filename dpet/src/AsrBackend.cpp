@@ -0,0 +1,548 @@
+#include "../include/AsrBackend.h"
+#include "sherpa-onnx/c-api/c-api.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace DesktopPet {
+
+namespace {
+
+const std::vector<AsrBackendInfo> kBackends = {
+    {AsrBackendType::SenseVoice, "sense_voice", "model.onnx, tokens.txt", false},
+    {AsrBackendType::Paraformer, "paraformer", "model.onnx, tokens.txt", false},
+    {AsrBackendType::Whisper, "whisper", "<size>-encoder.onnx, <size>-decoder.onnx, <size>-tokens.txt", false},
+    {AsrBackendType::Moonshine, "moonshine", "preprocess.onnx, encode.onnx, uncached_decode.onnx, cached_decode.onnx, tokens.txt", false},
+    {AsrBackendType::Zipformer, "zipformer", "encoder*.onnx, decoder*.onnx, joiner*.onnx, tokens.txt", false},
+    {AsrBackendType::StreamingZipformer, "streaming_zipformer", "encoder*.onnx, decoder*.onnx, joiner*.onnx, tokens.txt", true},
+    {AsrBackendType::StreamingParaformer, "streaming_paraformer", "encoder.onnx, decoder.onnx, tokens.txt", true},
+};
+
+constexpr int kFeatureDim = 80;
+constexpr int kMaxActivePaths = 4;
+constexpr float kOnlineTailSeconds = 0.3f;  // Silence after the input, so a streaming model emits its last tokens
+
+/**
+ * @brief The .onnx file for role in dir ("encoder" matches encoder-epoch-99-avg-1.onnx and tiny-encoder.onnx)
+ */
+std::string FindOnnx(const std::string& dir, const std::string& role, bool int8) {
+    std::string plain, quantized;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        std::string name = entry.path().filename().string();
+        if (entry.path().extension() != ".onnx") {
+            continue;
+        }
+        if (name.rfind(role, 0) != 0 && name.find("-" + role) == std::string::npos) {
+            continue;
+        }
+        std::string& slot = name.find(".int8.") != std::string::npos ? quantized : plain;
+        // Directory order is unspecified; take the first name so runs agree
+        if (slot.empty() || entry.path().string() < slot) {
+            slot = entry.path().string();
+        }
+    }
+    if (int8) {
+        return quantized.empty() ? plain : quantized;
+    }
+    return plain.empty() ? quantized : plain;
+}
+
+/**
+ * @brief tokens.txt, or the prefixed one Whisper releases ship (tiny-tokens.txt)
+ */
+std::string FindTokens(const std::string& dir) {
+    std::string path = dir + "/tokens.txt";
+    if (fs::exists(path)) {
+        return path;
+    }
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() > 10 && name.compare(name.size() - 10, 10, "tokens.txt") == 0) {
+            return entry.path().string();
+        }
+    }
+    return "";
+}
+
+std::string Trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+bool ParseBool(const std::string& value) {
+    return value == "1" || value == "true" || value == "yes" || value == "on";
+}
+
+/**
+ * @brief Call fn(i) for each i in [0, count) on up to workers threads, the caller being one of them
+ */
+template<typename Fn>
+void ForEachConcurrently(size_t count, size_t workers, Fn&& fn) {
+    std::atomic<size_t> next{0};
+    auto run = [&]() {
+        for (size_t i = next++; i < count; i = next++) {
+            fn(i);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < std::min(workers, count); ++i) {
+        threads.emplace_back(run);
+    }
+    run();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+} // namespace
+
+// ============================================================================
+// Registry and config file
+// ============================================================================
+
+const std::vector<AsrBackendInfo>& AsrBackends() {
+    return kBackends;
+}
+
+const AsrBackendInfo* FindAsrBackend(const std::string& name) {
+    for (const AsrBackendInfo& info : kBackends) {
+        if (name == info.name) {
+            return &info;
+        }
+    }
+    return nullptr;
+}
+
+const AsrBackendInfo& GetAsrBackend(AsrBackendType type) {
+    for (const AsrBackendInfo& info : kBackends) {
+        if (info.type == type) {
+            return info;
+        }
+    }
+    return kBackends.front();
+}
+
+const AsrConfig* AsrConfigFile::Find(const std::string& name) const {
+    for (const AsrConfig& config : backends) {
+        if (config.name == name) {
+            return &config;
+        }
+    }
+    return nullptr;
+}
+
+bool LoadAsrConfigFile(const std::string& path, AsrConfigFile& file) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "[AsrBackend] Cannot open " << path << std::endl;
+        return false;
+    }
+
+    file = AsrConfigFile();
+    std::vector<bool> typed;  // Per section: type given, or the name is a backend
+    int lineNumber = 0;
+    auto fail = [&](const std::string& message) {
+        std::cerr << "[AsrBackend] " << path << ":" << lineNumber << ": " << message << std::endl;
+        return false;
+    };
+
+    std::string line;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        line = Trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+
+        if (line.front() == '[') {
+            if (line.back() != ']') {
+                return fail("expected [section]");
+            }
+            AsrConfig config;
+            config.name = Trim(line.substr(1, line.size() - 2));
+            if (file.Find(config.name)) {
+                return fail("duplicate section " + config.name);
+            }
+            const AsrBackendInfo* info = FindAsrBackend(config.name);
+            if (info) {
+                config.type = info->type;
+            }
+            file.backends.push_back(config);
+            typed.push_back(info != nullptr);
+            continue;
+        }
+
+        size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            return fail("expected key = value");
+        }
+        std::string key = Trim(line.substr(0, equals));
+        std::string value = Trim(line.substr(equals + 1));
+
+        if (file.backends.empty()) {
+            if (key != "backend") {
+                return fail("unknown key " + key);
+            }
+            file.active = value;
+            continue;
+        }
+
+        AsrConfig& config = file.backends.back();
+        if (key == "type") {
+            const AsrBackendInfo* info = FindAsrBackend(value);
+            if (!info) {
+                return fail("unknown backend type " + value);
+            }
+            config.type = info->type;
+            typed.back() = true;
+        } else if (key == "model_dir") {
+            // Relative to the config file, so a config can ship next to its models
+            fs::path dir = fs::u8path(value);
+            config.modelDir = dir.is_absolute() ? value : (fs::path(path).parent_path() / dir).string();
+        } else if (key == "num_threads") {
+            config.numThreads = std::max(1, std::atoi(value.c_str()));
+        } else if (key == "provider") {
+            config.provider = value;
+        } else if (key == "language") {
+            config.language = value;
+        } else if (key == "int8") {
+            config.int8 = ParseBool(value);
+        } else if (key == "decoding_method") {
+            config.decodingMethod = value;
+        } else {
+            return fail("unknown key " + key);
+        }
+    }
+
+    for (size_t i = 0; i < file.backends.size(); ++i) {
+        if (!typed[i]) {
+            std::cerr << "[AsrBackend] " << path << ": [" << file.backends[i].name
+                      << "] needs a type (not a backend name)" << std::endl;
+            return false;
+        }
+    }
+    if (file.active.empty() && !file.backends.empty()) {
+        file.active = file.backends.front().name;
+    }
+    if (!file.Active()) {
+        std::cerr << "[AsrBackend] " << path << ": backend \"" << file.active << "\" has no section" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// AsrEngine
+// ============================================================================
+
+AsrEngine::~AsrEngine() {
+    for (const SherpaOnnxOfflineStream* stream : spareStreams_) {
+        SherpaOnnxDestroyOfflineStream(stream);
+    }
+    spareStreams_.clear();
+    if (offline_) {
+        SherpaOnnxDestroyOfflineRecognizer(offline_);
+        offline_ = nullptr;
+    }
+    if (online_) {
+        SherpaOnnxDestroyOnlineRecognizer(online_);
+        online_ = nullptr;
+    }
+}
+
+bool AsrEngine::Init(const AsrConfig& config) {
+    config_ = config;
+    const AsrBackendInfo& info = GetAsrBackend(config.type);
+    std::cout << "[AsrEngine] Loading " << config.name << " (" << info.name << ", " << config.numThreads
+              << " threads, " << config.provider << ") from " << config.modelDir << std::endl;
+
+    bool loaded = info.streaming ? InitOnline() : InitOffline();
+    if (!loaded) {
+        std::cerr << "[AsrEngine] " << info.name << " expects " << info.files << std::endl;
+    }
+    return loaded;
+}
+
+bool AsrEngine::InitOffline() {
+    const std::string& dir = config_.modelDir;
+    bool int8 = config_.int8;
+
+    // Strings must outlive SherpaOnnxCreateOfflineRecognizer
+    std::string model, encoder, decoder, joiner, cachedDecoder;
+    std::string tokens = FindTokens(dir);
+    std::string language = config_.language;
+
+    SherpaOnnxOfflineRecognizerConfig asrConfig;
+    memset(&asrConfig, 0, sizeof(asrConfig));
+
+    bool found = false;
+    switch (config_.type) {
+        case AsrBackendType::SenseVoice:
+            model = FindOnnx(dir, "model", int8);
+            asrConfig.model_config.sense_voice.model = model.c_str();
+            asrConfig.model_config.sense_voice.language = language.c_str();
+            asrConfig.model_config.sense_voice.use_itn = 1;
+            found = !model.empty();
+            break;
+
+        case AsrBackendType::Paraformer:
+            model = FindOnnx(dir, "model", int8);
+            asrConfig.model_config.paraformer.model = model.c_str();
+            found = !model.empty();
+            break;
+
+        case AsrBackendType::Whisper:
+            encoder = FindOnnx(dir, "encoder", int8);
+            decoder = FindOnnx(dir, "decoder", int8);
+            // Whisper detects the language itself when given none
+            if (language == "auto") {
+                language.clear();
+            }
+            asrConfig.model_config.whisper.encoder = encoder.c_str();
+            asrConfig.model_config.whisper.decoder = decoder.c_str();
+            asrConfig.model_config.whisper.language = language.c_str();
+            asrConfig.model_config.whisper.task = "transcribe";
+            asrConfig.model_config.whisper.tail_paddings = -1;
+            found = !encoder.empty() && !decoder.empty();
+            break;
+
+        case AsrBackendType::Moonshine:
+            model = FindOnnx(dir, "preprocess", int8);
+            encoder = FindOnnx(dir, "encode", int8);
+            decoder = FindOnnx(dir, "uncached_decode", int8);
+            cachedDecoder = FindOnnx(dir, "cached_decode", int8);
+            asrConfig.model_config.moonshine.preprocessor = model.c_str();
+            asrConfig.model_config.moonshine.encoder = encoder.c_str();
+            asrConfig.model_config.moonshine.uncached_decoder = decoder.c_str();
+            asrConfig.model_config.moonshine.cached_decoder = cachedDecoder.c_str();
+            found = !model.empty() && !encoder.empty() && !decoder.empty() && !cachedDecoder.empty();
+            break;
+
+        case AsrBackendType::Zipformer:
+            encoder = FindOnnx(dir, "encoder", int8);
+            decoder = FindOnnx(dir, "decoder", int8);
+            joiner = FindOnnx(dir, "joiner", int8);
+            asrConfig.model_config.transducer.encoder = encoder.c_str();
+            asrConfig.model_config.transducer.decoder = decoder.c_str();
+            asrConfig.model_config.transducer.joiner = joiner.c_str();
+            found = !encoder.empty() && !decoder.empty() && !joiner.empty();
+            break;
+
+        default:
+            break;
+    }
+
+    if (!found || tokens.empty()) {
+        std::cerr << "[AsrEngine] Model or tokens file missing in " << dir << std::endl;
+        return false;
+    }
+
+    asrConfig.feat_config.sample_rate = config_.sampleRate;
+    asrConfig.feat_config.feature_dim = kFeatureDim;
+    asrConfig.model_config.tokens = tokens.c_str();
+    asrConfig.model_config.num_threads = config_.numThreads;
+    asrConfig.model_config.provider = config_.provider.c_str();
+    asrConfig.model_config.debug = config_.debug ? 1 : 0;
+    asrConfig.decoding_method = config_.decodingMethod.c_str();
+    asrConfig.max_active_paths = kMaxActivePaths;
+
+    offline_ = SherpaOnnxCreateOfflineRecognizer(&asrConfig);
+    if (!offline_) {
+        std::cerr << "[AsrEngine] ASR model load failed" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool AsrEngine::InitOnline() {
+    const std::string& dir = config_.modelDir;
+    bool int8 = config_.int8;
+
+    // Strings must outlive SherpaOnnxCreateOnlineRecognizer
+    std::string encoder = FindOnnx(dir, "encoder", int8);
+    std::string decoder = FindOnnx(dir, "decoder", int8);
+    std::string joiner;
+    std::string tokens = FindTokens(dir);
+
+    SherpaOnnxOnlineRecognizerConfig asrConfig;
+    memset(&asrConfig, 0, sizeof(asrConfig));
+
+    bool found = !encoder.empty() && !decoder.empty();
+    if (config_.type == AsrBackendType::StreamingZipformer) {
+        joiner = FindOnnx(dir, "joiner", int8);
+        asrConfig.model_config.transducer.encoder = encoder.c_str();
+        asrConfig.model_config.transducer.decoder = decoder.c_str();
+        asrConfig.model_config.transducer.joiner = joiner.c_str();
+        found = found && !joiner.empty();
+    } else {
+        asrConfig.model_config.paraformer.encoder = encoder.c_str();
+        asrConfig.model_config.paraformer.decoder = decoder.c_str();
+    }
+
+    if (!found || tokens.empty()) {
+        std::cerr << "[AsrEngine] Model or tokens file missing in " << dir << std::endl;
+        return false;
+    }
+
+    asrConfig.feat_config.sample_rate = config_.sampleRate;
+    asrConfig.feat_config.feature_dim = kFeatureDim;
+    asrConfig.model_config.tokens = tokens.c_str();
+    asrConfig.model_config.num_threads = config_.numThreads;
+    asrConfig.model_config.provider = config_.provider.c_str();
+    asrConfig.model_config.debug = config_.debug ? 1 : 0;
+    asrConfig.decoding_method = config_.decodingMethod.c_str();
+    asrConfig.max_active_paths = kMaxActivePaths;
+    asrConfig.enable_endpoint = 0;  // Inputs are whole recordings, already cut
+
+    online_ = SherpaOnnxCreateOnlineRecognizer(&asrConfig);
+    if (!online_) {
+        std::cerr << "[AsrEngine] ASR model load failed" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void AsrEngine::PrepareStreams(size_t count) {
+    if (!offline_) {
+        return;
+    }
+    while (spareStreams_.size() < count) {
+        const SherpaOnnxOfflineStream* stream = SherpaOnnxCreateOfflineStream(offline_);
+        if (!stream) {
+            break;
+        }
+        spareStreams_.push_back(stream);
+    }
+}
+
+const SherpaOnnxOfflineStream* AsrEngine::TakeStream() {
+    if (spareStreams_.empty()) {
+        return SherpaOnnxCreateOfflineStream(offline_);
+    }
+    const SherpaOnnxOfflineStream* stream = spareStreams_.back();
+    spareStreams_.pop_back();
+    return stream;
+}
+
+size_t AsrEngine::ConcurrentWorkers(size_t streams) const {
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    size_t threads = static_cast<size_t>(std::max(1, config_.numThreads));
+    return std::min(streams, std::max<size_t>(1, cores / threads));
+}
+
+bool AsrEngine::Transcribe(const std::vector<AsrInput>& inputs, std::vector<std::string>& texts, size_t workers) {
+    texts.assign(inputs.size(), std::string());
+    if (!IsReady()) {
+        return false;
+    }
+    if (inputs.empty()) {
+        return true;
+    }
+    return online_ ? TranscribeOnline(inputs, texts, workers) : TranscribeOffline(inputs, texts, workers);
+}
+
+bool AsrEngine::TranscribeOffline(const std::vector<AsrInput>& inputs, std::vector<std::string>& texts, size_t workers) {
+    std::vector<const SherpaOnnxOfflineStream*> streams;
+    for (const AsrInput& input : inputs) {
+        const SherpaOnnxOfflineStream* stream = TakeStream();
+        if (!stream) {
+            std::cerr << "[AsrEngine] Failed to create stream" << std::endl;
+            break;
+        }
+        SherpaOnnxAcceptWaveformOffline(stream, config_.sampleRate, input.samples, static_cast<int32_t>(input.count));
+        streams.push_back(stream);
+    }
+
+    bool complete = streams.size() == inputs.size();
+    if (complete) {
+        if (workers == 0) {
+            SherpaOnnxDecodeMultipleOfflineStreams(offline_, streams.data(), static_cast<int32_t>(streams.size()));
+        } else {
+            // The recognizer's sessions are safe to run concurrently
+            ForEachConcurrently(streams.size(), workers, [&](size_t i) {
+                SherpaOnnxDecodeOfflineStream(offline_, streams[i]);
+            });
+        }
+    }
+
+    for (size_t i = 0; i < streams.size(); ++i) {
+        if (complete) {
+            const SherpaOnnxOfflineRecognizerResult* result = SherpaOnnxGetOfflineStreamResult(streams[i]);
+            if (result && result->text) {
+                texts[i] = result->text;
+            }
+            SherpaOnnxDestroyOfflineRecognizerResult(result);
+        }
+        SherpaOnnxDestroyOfflineStream(streams[i]);
+    }
+    return complete;
+}
+
+bool AsrEngine::TranscribeOnline(const std::vector<AsrInput>& inputs, std::vector<std::string>& texts, size_t workers) {
+    std::vector<float> tail(static_cast<size_t>(config_.sampleRate * kOnlineTailSeconds), 0.0f);
+
+    std::vector<const SherpaOnnxOnlineStream*> streams;
+    for (const AsrInput& input : inputs) {
+        const SherpaOnnxOnlineStream* stream = SherpaOnnxCreateOnlineStream(online_);
+        if (!stream) {
+            std::cerr << "[AsrEngine] Failed to create stream" << std::endl;
+            break;
+        }
+        SherpaOnnxOnlineStreamAcceptWaveform(stream, config_.sampleRate, input.samples, static_cast<int32_t>(input.count));
+        SherpaOnnxOnlineStreamAcceptWaveform(stream, config_.sampleRate, tail.data(), static_cast<int32_t>(tail.size()));
+        SherpaOnnxOnlineStreamInputFinished(stream);
+        streams.push_back(stream);
+    }
+
+    bool complete = streams.size() == inputs.size();
+    if (complete) {
+        if (workers == 0) {
+            // Batch the streams that still have frames until all are drained
+            std::vector<const SherpaOnnxOnlineStream*> ready;
+            do {
+                ready.clear();
+                for (const SherpaOnnxOnlineStream* stream : streams) {
+                    if (SherpaOnnxIsOnlineStreamReady(online_, stream)) {
+                        ready.push_back(stream);
+                    }
+                }
+                if (!ready.empty()) {
+                    SherpaOnnxDecodeMultipleOnlineStreams(online_, ready.data(), static_cast<int32_t>(ready.size()));
+                }
+            } while (!ready.empty());
+        } else {
+            ForEachConcurrently(streams.size(), workers, [&](size_t i) {
+                while (SherpaOnnxIsOnlineStreamReady(online_, streams[i])) {
+                    SherpaOnnxDecodeOnlineStream(online_, streams[i]);
+                }
+            });
+        }
+    }
+
+    for (size_t i = 0; i < streams.size(); ++i) {
+        if (complete) {
+            const SherpaOnnxOnlineRecognizerResult* result = SherpaOnnxGetOnlineStreamResult(online_, streams[i]);
+            if (result && result->text) {
+                texts[i] = result->text;
+            }
+            SherpaOnnxDestroyOnlineRecognizerResult(result);
+        }
+        SherpaOnnxDestroyOnlineStream(streams[i]);
+    }
+    return complete;
+}
+
+} // namespace DesktopPet
@@ -0,0 +1,197 @@
+#include "../include/AudioConditioner.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace DesktopPet {
+
+namespace {
+
+constexpr size_t kFftSize = 512;            // 32 ms at 16 kHz
+constexpr float kPowerSmoothing = 0.7f;     // For noise tracking only
+constexpr float kNoiseRiseDbPerSecond = 3.0f;
+constexpr float kPriorSmoothing = 0.98f;    // Decision-directed a priori SNR
+constexpr float kAgcGateDbfs = -50.0f;      // Quieter blocks don't move the AGC
+constexpr float kAgcAttack = 0.5f;          // Envelope tracking per block, rising level
+constexpr float kAgcRelease = 0.02f;        // Falling level
+constexpr float kAgcMaxUpDb = 0.5f;         // Gain change per block, so noise isn't pumped up
+constexpr float kAgcMaxDownDb = 3.0f;
+constexpr float kAgcMinGainDb = -12.0f;
+constexpr float kMinPower = 1e-12f;
+
+float DbToGain(float db) {
+    return std::pow(10.0f, db / 20.0f);
+}
+
+} // namespace
+
+AudioConditioner::AudioConditioner(int sampleRate, const ConditionerConfig& config)
+    : sampleRate_(sampleRate), config_(config), fftSize_(kFftSize), hop_(kFftSize / 2) {
+    // RBJ cookbook Butterworth high-pass
+    const double pi = 3.14159265358979323846;
+    double w0 = 2.0 * pi * config_.highPassHz / sampleRate_;
+    double alpha = std::sin(w0) / (2.0 * std::sqrt(0.5));
+    double cosW0 = std::cos(w0);
+    double a0 = 1.0 + alpha;
+    b0_ = static_cast<float>((1.0 + cosW0) / 2.0 / a0);
+    b1_ = static_cast<float>(-(1.0 + cosW0) / a0);
+    b2_ = b0_;
+    a1_ = static_cast<float>(-2.0 * cosW0 / a0);
+    a2_ = static_cast<float>((1.0 - alpha) / a0);
+
+    input_.assign(hop_, 0.0f);
+    output_.assign(hop_, 0.0f);
+
+    fft_.Configure(fftSize_);
+    window_.resize(fftSize_);
+    for (size_t i = 0; i < fftSize_; ++i) {
+        window_[i] = static_cast<float>(std::sqrt(0.5 - 0.5 * std::cos(2.0 * pi * i / fftSize_)));
+    }
+    frame_.assign(fftSize_, 0.0f);
+    re_.resize(fftSize_);
+    im_.resize(fftSize_);
+    gains_.assign(fftSize_, 1.0f);
+    size_t bins = fftSize_ / 2 + 1;
+    smoothed_.assign(bins, 0.0f);
+    noise_.assign(bins, 0.0f);
+    previousGain_.assign(bins, 1.0f);
+    previousPost_.assign(bins, 1.0f);
+    overlap_.assign(hop_, 0.0f);
+    floorGain_ = DbToGain(-config_.maxSuppressionDb);
+    noiseRise_ = std::pow(10.0f, kNoiseRiseDbPerSecond * hop_ / sampleRate_ / 10.0f);
+}
+
+void AudioConditioner::Reset() {
+    z1_ = z2_ = 0.0f;
+    std::fill(input_.begin(), input_.end(), 0.0f);
+    std::fill(output_.begin(), output_.end(), 0.0f);
+    fill_ = 0;
+    std::fill(frame_.begin(), frame_.end(), 0.0f);
+    std::fill(overlap_.begin(), overlap_.end(), 0.0f);
+    std::fill(previousGain_.begin(), previousGain_.end(), 1.0f);
+    std::fill(previousPost_.begin(), previousPost_.end(), 1.0f);
+    noiseInitialized_ = false;
+}
+
+void AudioConditioner::Process(const float* in, float* out, size_t count) {
+    size_t done = 0;
+    while (done < count) {
+        size_t n = std::min(count - done, hop_ - fill_);
+        for (size_t i = 0; i < n; ++i) {
+            float x = in[done + i];
+            if (config_.highPass) {
+                float y = b0_ * x + z1_;
+                z1_ = b1_ * x - a1_ * y + z2_;
+                z2_ = b2_ * x - a2_ * y;
+                x = y;
+            }
+            // Read the previous block's result before its slot is reused
+            // (in and out may be the same buffer)
+            out[done + i] = output_[fill_ + i];
+            input_[fill_ + i] = x;
+        }
+        fill_ += n;
+        done += n;
+        if (fill_ == hop_) {
+            ProcessBlock();
+            fill_ = 0;
+        }
+    }
+}
+
+void AudioConditioner::ProcessBlock() {
+    auto start = std::chrono::steady_clock::now();
+
+    if (config_.noiseSuppression) {
+        SuppressNoise();
+    } else {
+        std::copy(input_.begin(), input_.end(), output_.begin());
+    }
+    if (config_.autoGain) {
+        ApplyGain(output_.data());
+    }
+    Dsp::Clamp(output_.data(), hop_);
+
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    ++blocks_;
+    totalUs_ += us;
+    maxUs_ = std::max(maxUs_, us);
+}
+
+void AudioConditioner::SuppressNoise() {
+    // Slide the analysis frame by one block
+    std::copy(frame_.begin() + hop_, frame_.end(), frame_.begin());
+    std::copy(input_.begin(), input_.end(), frame_.begin() + (fftSize_ - hop_));
+
+    std::copy(frame_.begin(), frame_.end(), re_.begin());
+    Dsp::Multiply(re_.data(), window_.data(), fftSize_);
+    std::fill(im_.begin(), im_.end(), 0.0f);
+    fft_.Forward(re_.data(), im_.data());
+
+    size_t bins = fftSize_ / 2 + 1;
+    double suppressionDb = 0.0;
+    for (size_t k = 0; k < bins; ++k) {
+        float power = std::max(re_[k] * re_[k] + im_[k] * im_[k], kMinPower);
+        smoothed_[k] = noiseInitialized_ ? kPowerSmoothing * smoothed_[k] + (1.0f - kPowerSmoothing) * power : power;
+
+        // Minimum tracking: follow drops at once, creep up slowly so the
+        // estimate recovers when the room gets louder but ignores speech
+        if (!noiseInitialized_ || smoothed_[k] < noise_[k]) {
+            noise_[k] = smoothed_[k];
+        } else {
+            noise_[k] *= noiseRise_;
+        }
+
+        float post = power / noise_[k];
+        float prior = kPriorSmoothing * previousGain_[k] * previousGain_[k] * previousPost_[k]
+                      + (1.0f - kPriorSmoothing) * std::max(post - 1.0f, 0.0f);
+        float gain = std::max(prior / (1.0f + prior), floorGain_);
+        previousGain_[k] = gain;
+        previousPost_[k] = post;
+        gains_[k] = gain;
+        if (k > 0 && k < fftSize_ / 2) {
+            gains_[fftSize_ - k] = gain;
+        }
+        suppressionDb -= 20.0 * std::log10(gain);
+    }
+    noiseInitialized_ = true;
+    suppressionDbSum_ += suppressionDb / bins;
+    ++frames_;
+
+    Dsp::Multiply(re_.data(), gains_.data(), fftSize_);
+    Dsp::Multiply(im_.data(), gains_.data(), fftSize_);
+    fft_.Inverse(re_.data(), im_.data());
+    Dsp::Multiply(re_.data(), window_.data(), fftSize_);
+
+    // Overlap-add: sqrt-Hann analysis x synthesis sums to one at 50% overlap
+    std::copy(overlap_.begin(), overlap_.end(), output_.begin());
+    Dsp::MixAdd(output_.data(), re_.data(), hop_, 1.0f);
+    std::copy(re_.begin() + hop_, re_.end(), overlap_.begin());
+}
+
+void AudioConditioner::ApplyGain(float* block) {
+    float levelDb = 10.0f * std::log10(Dsp::Dot(block, block, hop_) / hop_ + kMinPower);
+    float startGain = DbToGain(gainDb_);
+
+    if (levelDb > kAgcGateDbfs) {
+        float tracking = levelDb > envelopeDb_ ? kAgcAttack : kAgcRelease;
+        envelopeDb_ += tracking * (levelDb - envelopeDb_);
+        float desired = std::max(kAgcMinGainDb, std::min(config_.maxGainDb, config_.targetDbfs - envelopeDb_));
+        gainDb_ += std::max(-kAgcMaxDownDb, std::min(kAgcMaxUpDb, desired - gainDb_));
+    }
+
+    Dsp::Ramp(block, hop_, startGain, DbToGain(gainDb_));
+}
+
+AudioConditioner::Stats AudioConditioner::GetStats() const {
+    Stats stats;
+    stats.blocks = blocks_;
+    stats.avgBlockUs = blocks_ > 0 ? totalUs_ / blocks_ : 0.0;
+    stats.maxBlockUs = maxUs_;
+    stats.blockMs = hop_ * 1000.0 / sampleRate_;
+    stats.gainDb = gainDb_;
+    stats.avgSuppressionDb = frames_ > 0 ? static_cast<float>(suppressionDbSum_ / frames_) : 0.0f;
+    return stats;
+}
+
+} // namespace DesktopPet
@@ -0,0 +1,585 @@
+#include "../include/AudioDsp.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define DPET_DSP_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DPET_DSP_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DPET_DSP_NEON 1
+#endif
+
+namespace DesktopPet {
+namespace Dsp {
+
+void MixAdd(float* dst, const float* src, size_t count, float gain) {
+    size_t i = 0;
+#if defined(DPET_DSP_AVX)
+    const __m256 g = _mm256_set1_ps(gain);
+    for (; i + 8 <= count; i += 8) {
+        __m256 d = _mm256_loadu_ps(dst + i);
+        __m256 s = _mm256_loadu_ps(src + i);
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(d, _mm256_mul_ps(s, g)));
+    }
+#elif defined(DPET_DSP_SSE)
+    const __m128 g = _mm_set1_ps(gain);
+    for (; i + 4 <= count; i += 4) {
+        __m128 d = _mm_loadu_ps(dst + i);
+        __m128 s = _mm_loadu_ps(src + i);
+        _mm_storeu_ps(dst + i, _mm_add_ps(d, _mm_mul_ps(s, g)));
+    }
+#elif defined(DPET_DSP_NEON)
+    const float32x4_t g = vdupq_n_f32(gain);
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(dst + i, vmlaq_f32(vld1q_f32(dst + i), vld1q_f32(src + i), g));
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] += src[i] * gain;
+    }
+}
+
+void Clamp(float* data, size_t count, float limit) {
+    size_t i = 0;
+#if defined(DPET_DSP_AVX)
+    const __m256 hi = _mm256_set1_ps(limit);
+    const __m256 lo = _mm256_set1_ps(-limit);
+    for (; i + 8 <= count; i += 8) {
+        __m256 v = _mm256_loadu_ps(data + i);
+        _mm256_storeu_ps(data + i, _mm256_max_ps(lo, _mm256_min_ps(hi, v)));
+    }
+#elif defined(DPET_DSP_SSE)
+    const __m128 hi = _mm_set1_ps(limit);
+    const __m128 lo = _mm_set1_ps(-limit);
+    for (; i + 4 <= count; i += 4) {
+        __m128 v = _mm_loadu_ps(data + i);
+        _mm_storeu_ps(data + i, _mm_max_ps(lo, _mm_min_ps(hi, v)));
+    }
+#elif defined(DPET_DSP_NEON)
+    const float32x4_t hi = vdupq_n_f32(limit);
+    const float32x4_t lo = vdupq_n_f32(-limit);
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(data + i, vmaxq_f32(lo, vminq_f32(hi, vld1q_f32(data + i))));
+    }
+#endif
+    for (; i < count; ++i) {
+        data[i] = std::max(-limit, std::min(limit, data[i]));
+    }
+}
+
+float Dot(const float* a, const float* b, size_t count) {
+    size_t i = 0;
+    float sum = 0.0f;
+#if defined(DPET_DSP_AVX)
+    __m256 acc = _mm256_setzero_ps();
+    for (; i + 8 <= count; i += 8) {
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, acc);
+    for (float lane : lanes) {
+        sum += lane;
+    }
+#elif defined(DPET_DSP_SSE)
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, acc);
+    sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(DPET_DSP_NEON)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (; i + 4 <= count; i += 4) {
+        acc = vmlaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+    }
+    sum = vgetq_lane_f32(acc, 0) + vgetq_lane_f32(acc, 1) + vgetq_lane_f32(acc, 2) + vgetq_lane_f32(acc, 3);
+#endif
+    for (; i < count; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+void Multiply(float* dst, const float* src, size_t count) {
+    size_t i = 0;
+#if defined(DPET_DSP_AVX)
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(dst + i), _mm256_loadu_ps(src + i)));
+    }
+#elif defined(DPET_DSP_SSE)
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(dst + i), _mm_loadu_ps(src + i)));
+    }
+#elif defined(DPET_DSP_NEON)
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(dst + i, vmulq_f32(vld1q_f32(dst + i), vld1q_f32(src + i)));
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] *= src[i];
+    }
+}
+
+void Ramp(float* data, size_t count, float startGain, float endGain) {
+    if (count == 0) {
+        return;
+    }
+    const float step = (endGain - startGain) / count;
+    size_t i = 0;
+#if defined(DPET_DSP_AVX)
+    __m256 gain = _mm256_add_ps(_mm256_set1_ps(startGain),
+                                _mm256_mul_ps(_mm256_set1_ps(step), _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7)));
+    const __m256 advance = _mm256_set1_ps(step * 8);
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(data + i, _mm256_mul_ps(_mm256_loadu_ps(data + i), gain));
+        gain = _mm256_add_ps(gain, advance);
+    }
+#elif defined(DPET_DSP_SSE)
+    __m128 gain = _mm_add_ps(_mm_set1_ps(startGain), _mm_mul_ps(_mm_set1_ps(step), _mm_setr_ps(0, 1, 2, 3)));
+    const __m128 advance = _mm_set1_ps(step * 4);
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(data + i, _mm_mul_ps(_mm_loadu_ps(data + i), gain));
+        gain = _mm_add_ps(gain, advance);
+    }
+#elif defined(DPET_DSP_NEON)
+    const float lanes[4] = {0.0f, 1.0f, 2.0f, 3.0f};
+    float32x4_t gain = vmlaq_n_f32(vdupq_n_f32(startGain), vld1q_f32(lanes), step);
+    const float32x4_t advance = vdupq_n_f32(step * 4);
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(data + i, vmulq_f32(vld1q_f32(data + i), gain));
+        gain = vaddq_f32(gain, advance);
+    }
+#endif
+    for (; i < count; ++i) {
+        data[i] *= startGain + step * i;
+    }
+}
+
+void Downmix(const float* src, size_t frames, int channels, float* dst) {
+    if (channels == 1) {
+        if (dst != src) {
+            std::copy(src, src + frames, dst);
+        }
+        return;
+    }
+    size_t i = 0;
+    if (channels == 2) {
+#if defined(DPET_DSP_AVX) || defined(DPET_DSP_SSE)
+        const __m128 half = _mm_set1_ps(0.5f);
+        for (; i + 4 <= frames; i += 4) {
+            __m128 a = _mm_loadu_ps(src + 2 * i);
+            __m128 b = _mm_loadu_ps(src + 2 * i + 4);
+            __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_add_ps(left, right), half));
+        }
+#elif defined(DPET_DSP_NEON)
+        for (; i + 4 <= frames; i += 4) {
+            float32x4x2_t lr = vld2q_f32(src + 2 * i);
+            vst1q_f32(dst + i, vmulq_n_f32(vaddq_f32(lr.val[0], lr.val[1]), 0.5f));
+        }
+#endif
+    }
+    // Frames are written in order and frame i reads from index i * channels
+    // onwards, so an in-place downmix never overwrites unread input
+    const float scale = 1.0f / channels;
+    for (; i < frames; ++i) {
+        float sum = 0.0f;
+        for (int c = 0; c < channels; ++c) {
+            sum += src[i * channels + c];
+        }
+        dst[i] = sum * scale;
+    }
+}
+
+namespace {
+
+constexpr float kInt16Scale = 32767.0f;
+
+template<bool Companded>
+void EncodeInt16(const float* src, int16_t* dst, size_t count) {
+    size_t i = 0;
+#if defined(DPET_DSP_AVX)
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 minusOne = _mm256_set1_ps(-1.0f);
+    const __m256 scale = _mm256_set1_ps(kInt16Scale);
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_max_ps(minusOne, _mm256_min_ps(one, _mm256_loadu_ps(src + i)));
+        if (Companded) {
+            __m256 sign = _mm256_and_ps(x, signMask);
+            x = _mm256_or_ps(sign, _mm256_sqrt_ps(_mm256_andnot_ps(signMask, x)));
+        }
+        __m256i v = _mm256_cvtps_epi32(_mm256_mul_ps(x, scale));
+        __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extractf128_si256(v, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+    }
+#elif defined(DPET_DSP_SSE)
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 minusOne = _mm_set1_ps(-1.0f);
+    const __m128 scale = _mm_set1_ps(kInt16Scale);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    for (; i + 8 <= count; i += 8) {
+        __m128 a = _mm_max_ps(minusOne, _mm_min_ps(one, _mm_loadu_ps(src + i)));
+        __m128 b = _mm_max_ps(minusOne, _mm_min_ps(one, _mm_loadu_ps(src + i + 4)));
+        if (Companded) {
+            a = _mm_or_ps(_mm_and_ps(a, signMask), _mm_sqrt_ps(_mm_andnot_ps(signMask, a)));
+            b = _mm_or_ps(_mm_and_ps(b, signMask), _mm_sqrt_ps(_mm_andnot_ps(signMask, b)));
+        }
+        __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(a, scale)), _mm_cvtps_epi32(_mm_mul_ps(b, scale)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+    }
+#elif defined(DPET_DSP_NEON)
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t minusOne = vdupq_n_f32(-1.0f);
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    const float32x4_t minusHalf = vdupq_n_f32(-0.5f);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t x = vmaxq_f32(minusOne, vminq_f32(one, vld1q_f32(src + i)));
+        uint32x4_t negative = vcltq_f32(x, zero);
+        if (Companded) {
+#if defined(__aarch64__)
+            float32x4_t root = vsqrtq_f32(vabsq_f32(x));
+            x = vbslq_f32(negative, vnegq_f32(root), root);
+#else
+            break;  // No vector square root: the scalar loop finishes
+#endif
+        }
+        // vcvtq truncates; round half away from zero
+        float32x4_t scaled = vmlaq_n_f32(vbslq_f32(negative, minusHalf, half), x, kInt16Scale);
+        vst1_s16(dst + i, vqmovn_s32(vcvtq_s32_f32(scaled)));
+    }
+#endif
+    for (; i < count; ++i) {
+        float x = std::max(-1.0f, std::min(1.0f, src[i]));
+        if (Companded) {
+            x = std::copysign(std::sqrt(std::fabs(x)), x);
+        }
+        dst[i] = static_cast<int16_t>(std::lrint(x * kInt16Scale));
+    }
+}
+
+template<bool Companded>
+void DecodeInt16(const int16_t* src, float* dst, size_t count) {
+    size_t i = 0;
+    const float scale = 1.0f / kInt16Scale;
+#if defined(DPET_DSP_AVX)
+    const __m256 s = _mm256_set1_ps(scale);
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i lo = _mm_cvtepi16_epi32(v);  // SSE4.1, part of every AVX target
+        __m128i hi = _mm_cvtepi16_epi32(_mm_srli_si128(v, 8));
+        __m256i wide = _mm256_insertf128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        __m256 y = _mm256_mul_ps(_mm256_cvtepi32_ps(wide), s);
+        if (Companded) {
+            y = _mm256_mul_ps(y, _mm256_andnot_ps(signMask, y));
+        }
+        _mm256_storeu_ps(dst + i, y);
+    }
+#elif defined(DPET_DSP_SSE)
+    const __m128 s = _mm_set1_ps(scale);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        // Sign-extend by placing each value in the top half and shifting down
+        __m128 a = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)), s);
+        __m128 b = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)), s);
+        if (Companded) {
+            a = _mm_mul_ps(a, _mm_andnot_ps(signMask, a));
+            b = _mm_mul_ps(b, _mm_andnot_ps(signMask, b));
+        }
+        _mm_storeu_ps(dst + i, a);
+        _mm_storeu_ps(dst + i + 4, b);
+    }
+#elif defined(DPET_DSP_NEON)
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t y = vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vld1_s16(src + i))), scale);
+        if (Companded) {
+            y = vmulq_f32(y, vabsq_f32(y));
+        }
+        vst1q_f32(dst + i, y);
+    }
+#endif
+    for (; i < count; ++i) {
+        float y = src[i] * scale;
+        dst[i] = Companded ? y * std::fabs(y) : y;
+    }
+}
+
+} // namespace
+
+void FloatToInt16(const float* src, int16_t* dst, size_t count) {
+    EncodeInt16<false>(src, dst, count);
+}
+
+void Int16ToFloat(const int16_t* src, float* dst, size_t count) {
+    DecodeInt16<false>(src, dst, count);
+}
+
+void CompandToInt16(const float* src, int16_t* dst, size_t count) {
+    EncodeInt16<true>(src, dst, count);
+}
+
+void ExpandInt16(const int16_t* src, float* dst, size_t count) {
+    DecodeInt16<true>(src, dst, count);
+}
+
+size_t LinearResampler::Process(const float* in, size_t count, float* out) {
+    size_t written = 0;
+    for (size_t i = 0; i < count; ++i) {
+        float current = in[i];
+        while (position_ <= 1.0) {
+            out[written++] = previous_ + (current - previous_) * static_cast<float>(position_);
+            position_ += step_;
+        }
+        position_ -= 1.0;
+        previous_ = current;
+    }
+    return written;
+}
+
+namespace {
+
+/**
+ * @brief Zeroth-order modified Bessel function, for the Kaiser window
+ */
+double BesselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < 1e-12 * sum) {
+            break;
+        }
+    }
+    return sum;
+}
+
+size_t Gcd(size_t a, size_t b) {
+    while (b != 0) {
+        size_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+} // namespace
+
+void PolyphaseResampler::Configure(int inRate, int outRate) {
+    // Passband edge as a share of the lower Nyquist rate, zero crossings on
+    // each side of the sinc and Kaiser beta (~80 dB stopband)
+    const double rolloff = 0.92;
+    const int zeroCrossings = 12;
+    const double beta = 8.0;
+    const double pi = 3.14159265358979323846;
+
+    size_t g = Gcd(static_cast<size_t>(inRate), static_cast<size_t>(outRate));
+    up_ = static_cast<size_t>(outRate) / g;
+    down_ = static_cast<size_t>(inRate) / g;
+
+    // Prototype filter at inRate * up_, cut off at the lower of the two Nyquist rates
+    double cutoff = rolloff * 0.5 / std::max(up_, down_);  // Cycles per upsampled sample
+    size_t halfLength = static_cast<size_t>(std::ceil(zeroCrossings / (2.0 * cutoff)));
+    size_t length = 2 * halfLength + 1;
+    taps_ = (length + up_ - 1) / up_;
+    taps_ = (taps_ + 7) / 8 * 8;  // Whole vectors for Dot
+
+    std::vector<double> prototype(taps_ * up_, 0.0);
+    for (size_t n = 0; n < length; ++n) {
+        double t = static_cast<double>(n) - halfLength;
+        double sinc = t == 0.0 ? 1.0 : std::sin(2.0 * pi * cutoff * t) / (2.0 * pi * cutoff * t);
+        double r = t / halfLength;
+        double window = BesselI0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / BesselI0(beta);
+        prototype[n] = sinc * window;
+    }
+
+    // Split into phases; each is normalized to unity DC gain so the phases
+    // match exactly and there is no ripple at the output rate
+    phases_.assign(taps_ * up_, 0.0f);
+    for (size_t p = 0; p < up_; ++p) {
+        double sum = 0.0;
+        for (size_t k = 0; k < taps_; ++k) {
+            sum += prototype[p + k * up_];
+        }
+        for (size_t k = 0; k < taps_; ++k) {
+            phases_[p * taps_ + (taps_ - 1 - k)] = static_cast<float>(prototype[p + k * up_] / sum);
+        }
+    }
+
+    history_.assign(taps_ - 1, 0.0f);
+    position_ = taps_ - 1;
+    phase_ = 0;
+    delay_ = static_cast<double>(halfLength) / down_;
+}
+
+size_t PolyphaseResampler::Process(const float* in, size_t count, float* out) {
+    history_.insert(history_.end(), in, in + count);
+
+    size_t written = 0;
+    while (position_ < history_.size()) {
+        out[written++] = Dot(&phases_[phase_ * taps_], &history_[position_ + 1 - taps_], taps_);
+        phase_ += down_;
+        position_ += phase_ / up_;
+        phase_ %= up_;
+    }
+
+    // Keep the samples the next output still reaches back to
+    size_t consumed = position_ + 1 - taps_;
+    consumed = std::min(consumed, history_.size());
+    history_.erase(history_.begin(), history_.begin() + consumed);
+    position_ -= consumed;
+    return written;
+}
+
+namespace {
+
+/**
+ * @brief Radix-2 butterflies: t = b * w; b = a - t; a = a + t (split complex)
+ */
+void Butterflies(float* aRe, float* aIm, float* bRe, float* bIm,
+                 const float* wRe, const float* wIm, size_t count) {
+    size_t i = 0;
+#if defined(DPET_DSP_AVX)
+    for (; i + 8 <= count; i += 8) {
+        __m256 br = _mm256_loadu_ps(bRe + i), bi = _mm256_loadu_ps(bIm + i);
+        __m256 wr = _mm256_loadu_ps(wRe + i), wi = _mm256_loadu_ps(wIm + i);
+        __m256 tr = _mm256_sub_ps(_mm256_mul_ps(br, wr), _mm256_mul_ps(bi, wi));
+        __m256 ti = _mm256_add_ps(_mm256_mul_ps(br, wi), _mm256_mul_ps(bi, wr));
+        __m256 ar = _mm256_loadu_ps(aRe + i), ai = _mm256_loadu_ps(aIm + i);
+        _mm256_storeu_ps(bRe + i, _mm256_sub_ps(ar, tr));
+        _mm256_storeu_ps(bIm + i, _mm256_sub_ps(ai, ti));
+        _mm256_storeu_ps(aRe + i, _mm256_add_ps(ar, tr));
+        _mm256_storeu_ps(aIm + i, _mm256_add_ps(ai, ti));
+    }
+#elif defined(DPET_DSP_SSE)
+    for (; i + 4 <= count; i += 4) {
+        __m128 br = _mm_loadu_ps(bRe + i), bi = _mm_loadu_ps(bIm + i);
+        __m128 wr = _mm_loadu_ps(wRe + i), wi = _mm_loadu_ps(wIm + i);
+        __m128 tr = _mm_sub_ps(_mm_mul_ps(br, wr), _mm_mul_ps(bi, wi));
+        __m128 ti = _mm_add_ps(_mm_mul_ps(br, wi), _mm_mul_ps(bi, wr));
+        __m128 ar = _mm_loadu_ps(aRe + i), ai = _mm_loadu_ps(aIm + i);
+        _mm_storeu_ps(bRe + i, _mm_sub_ps(ar, tr));
+        _mm_storeu_ps(bIm + i, _mm_sub_ps(ai, ti));
+        _mm_storeu_ps(aRe + i, _mm_add_ps(ar, tr));
+        _mm_storeu_ps(aIm + i, _mm_add_ps(ai, ti));
+    }
+#elif defined(DPET_DSP_NEON)
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t br = vld1q_f32(bRe + i), bi = vld1q_f32(bIm + i);
+        float32x4_t wr = vld1q_f32(wRe + i), wi = vld1q_f32(wIm + i);
+        float32x4_t tr = vmlsq_f32(vmulq_f32(br, wr), bi, wi);
+        float32x4_t ti = vmlaq_f32(vmulq_f32(br, wi), bi, wr);
+        float32x4_t ar = vld1q_f32(aRe + i), ai = vld1q_f32(aIm + i);
+        vst1q_f32(bRe + i, vsubq_f32(ar, tr));
+        vst1q_f32(bIm + i, vsubq_f32(ai, ti));
+        vst1q_f32(aRe + i, vaddq_f32(ar, tr));
+        vst1q_f32(aIm + i, vaddq_f32(ai, ti));
+    }
+#endif
+    for (; i < count; ++i) {
+        float tr = bRe[i] * wRe[i] - bIm[i] * wIm[i];
+        float ti = bRe[i] * wIm[i] + bIm[i] * wRe[i];
+        bRe[i] = aRe[i] - tr;
+        bIm[i] = aIm[i] - ti;
+        aRe[i] += tr;
+        aIm[i] += ti;
+    }
+}
+
+} // namespace
+
+void ComplexFft::Configure(size_t size) {
+    size_ = size;
+    size_t bits = 0;
+    while ((size_t(1) << bits) < size) {
+        ++bits;
+    }
+    bitReverse_.resize(size);
+    for (size_t i = 0; i < size; ++i) {
+        uint32_t reversed = 0;
+        for (size_t b = 0; b < bits; ++b) {
+            reversed |= ((i >> b) & 1u) << (bits - 1 - b);
+        }
+        bitReverse_[i] = reversed;
+    }
+
+    twiddleRe_.assign(size > 1 ? size - 1 : 0, 0.0f);
+    twiddleIm_.assign(twiddleRe_.size(), 0.0f);
+    const double pi = 3.14159265358979323846;
+    for (size_t half = 1; half < size; half *= 2) {
+        for (size_t k = 0; k < half; ++k) {
+            double angle = -pi * k / half;
+            twiddleRe_[half - 1 + k] = static_cast<float>(std::cos(angle));
+            twiddleIm_[half - 1 + k] = static_cast<float>(std::sin(angle));
+        }
+    }
+}
+
+void ComplexFft::Forward(float* re, float* im) const {
+    for (size_t i = 0; i < size_; ++i) {
+        size_t j = bitReverse_[i];
+        if (j > i) {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+
+    for (size_t half = 1; half < size_; half *= 2) {
+        const float* wRe = &twiddleRe_[half - 1];
+        const float* wIm = &twiddleIm_[half - 1];
+        for (size_t start = 0; start < size_; start += 2 * half) {
+            Butterflies(re + start, im + start, re + start + half, im + start + half, wRe, wIm, half);
+        }
+    }
+}
+
+void ComplexFft::Inverse(float* re, float* im) const {
+    // ifft(x) = conj(fft(conj(x))) / N; swapping re/im conjugates both ways
+    Forward(im, re);
+    float scale = 1.0f / size_;
+    for (size_t i = 0; i < size_; ++i) {
+        re[i] *= scale;
+        im[i] *= scale;
+    }
+}
+
+void PowerSpectrum::Configure(size_t size) {
+    fft_.Configure(size);
+    re_.resize(size);
+    im_.resize(size);
+}
+
+void PowerSpectrum::Compute(const float* frame, float* power) {
+    std::copy(frame, frame + fft_.Size(), re_.begin());
+    std::fill(im_.begin(), im_.end(), 0.0f);
+    fft_.Forward(re_.data(), im_.data());
+
+    size_t bins = Bins();
+    for (size_t k = 0; k < bins; ++k) {
+        power[k] = re_[k] * re_[k] + im_[k] * im_[k];
+    }
+}
+
+const char* SimdName() {
+#if defined(DPET_DSP_AVX)
+    return "AVX";
+#elif defined(DPET_DSP_SSE)
+    return "SSE2";
+#elif defined(DPET_DSP_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace Dsp
+} // namespace DesktopPet
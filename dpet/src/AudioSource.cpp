@@ -0,0 +1,214 @@
+#include "../include/AudioSource.h"
+#include "miniaudio/miniaudio.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+
+namespace DesktopPet {
+
+namespace {
+
+constexpr int kBlockMs = 10;             // Paced sources deliver a block every 10 ms, like a device period
+constexpr int kNullSampleRate = 16000;
+
+} // namespace
+
+AudioSourceConfig ParseAudioSource(const std::string& spec) {
+    AudioSourceConfig config;
+    if (spec.empty() || spec == "device") {
+        config.type = AudioSourceType::Device;
+    } else if (spec == "null") {
+        config.type = AudioSourceType::Null;
+    } else {
+        config.type = AudioSourceType::File;
+        config.path = spec;
+    }
+    return config;
+}
+
+std::unique_ptr<AudioSource> AudioSource::Create(const AudioSourceConfig& config) {
+    switch (config.type) {
+        case AudioSourceType::File: return std::make_unique<FileAudioSource>(config.path, config.loop);
+        case AudioSourceType::Null: return std::make_unique<NullAudioSource>();
+        default: return std::make_unique<DeviceAudioSource>();
+    }
+}
+
+// ============================================================================
+// DeviceAudioSource
+// ============================================================================
+
+DeviceAudioSource::~DeviceAudioSource() {
+    if (device_) {
+        ma_device_uninit(device_);
+        delete device_;
+        device_ = nullptr;
+    }
+}
+
+bool DeviceAudioSource::Open(int sampleRate, int channels, Callback callback, void* user) {
+    callback_ = callback;
+    user_ = user;
+
+    device_ = new ma_device();
+    ma_device_config deviceConfig = ma_device_config_init(ma_device_type_capture);
+    deviceConfig.capture.format = ma_format_f32;
+    deviceConfig.capture.channels = static_cast<ma_uint32>(channels);
+    deviceConfig.sampleRate = static_cast<ma_uint32>(sampleRate);
+    deviceConfig.dataCallback = DataCallback;
+    deviceConfig.pUserData = this;
+
+    if (ma_device_init(NULL, &deviceConfig, device_) != MA_SUCCESS) {
+        std::cerr << "[AudioSource] Capture device init failed" << std::endl;
+        delete device_;
+        device_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool DeviceAudioSource::Start() {
+    if (ma_device_start(device_) != MA_SUCCESS) {
+        std::cerr << "[AudioSource] Failed to start capture device" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void DeviceAudioSource::Stop() {
+    ma_device_stop(device_);
+}
+
+int DeviceAudioSource::SampleRate() const {
+    return device_ ? static_cast<int>(device_->sampleRate) : 0;
+}
+
+int DeviceAudioSource::Channels() const {
+    return device_ ? static_cast<int>(device_->capture.channels) : 0;
+}
+
+std::string DeviceAudioSource::Describe() const {
+    return device_ ? std::string("device \"") + device_->capture.name + "\"" : "device";
+}
+
+void DeviceAudioSource::DataCallback(ma_device* device, void* output, const void* input, unsigned int frameCount) {
+    DeviceAudioSource* self = static_cast<DeviceAudioSource*>(device->pUserData);
+    self->callback_(self->user_, static_cast<const float*>(input), frameCount);
+    (void)output;
+}
+
+// ============================================================================
+// PacedAudioSource
+// ============================================================================
+
+PacedAudioSource::~PacedAudioSource() {
+    Stop();
+}
+
+bool PacedAudioSource::Start() {
+    if (running_) {
+        return true;
+    }
+    block_.resize(static_cast<size_t>(sampleRate_) * kBlockMs / 1000 * channels_);
+    running_ = true;
+    thread_ = std::thread(&PacedAudioSource::Run, this);
+    return true;
+}
+
+void PacedAudioSource::Stop() {
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void PacedAudioSource::Run() {
+    size_t frames = block_.size() / channels_;
+    auto period = std::chrono::microseconds(static_cast<int64_t>(frames) * 1000000 / sampleRate_);
+    auto next = std::chrono::steady_clock::now();
+    while (running_) {
+        // A block is due once its audio would have been captured
+        next += period;
+        std::this_thread::sleep_until(next);
+        Fill(block_.data(), frames);
+        callback_(user_, block_.data(), static_cast<unsigned int>(frames));
+    }
+}
+
+// ============================================================================
+// FileAudioSource
+// ============================================================================
+
+bool FileAudioSource::Open(int sampleRate, int channels, Callback callback, void* user) {
+    SetCallback(callback, user);
+
+    ma_decoder_config decoderConfig = ma_decoder_config_init(ma_format_f32, static_cast<ma_uint32>(channels),
+                                                             static_cast<ma_uint32>(sampleRate));
+    ma_decoder decoder;
+    if (ma_decoder_init_file(path_.c_str(), &decoderConfig, &decoder) != MA_SUCCESS) {
+        std::cerr << "[AudioSource] Cannot open " << path_ << std::endl;
+        return false;
+    }
+    sampleRate_ = static_cast<int>(decoder.outputSampleRate);
+    channels_ = static_cast<int>(decoder.outputChannels);
+
+    samples_.clear();
+    std::vector<float> buffer(4096 * channels_);
+    ma_uint64 framesRead = 0;
+    while (ma_decoder_read_pcm_frames(&decoder, buffer.data(), 4096, &framesRead) == MA_SUCCESS && framesRead > 0) {
+        samples_.insert(samples_.end(), buffer.begin(), buffer.begin() + framesRead * channels_);
+    }
+    ma_decoder_uninit(&decoder);
+
+    if (samples_.empty()) {
+        std::cerr << "[AudioSource] " << path_ << " has no audio" << std::endl;
+        return false;
+    }
+    position_ = 0;
+    finished_ = false;
+    return true;
+}
+
+std::string FileAudioSource::Describe() const {
+    return "file \"" + path_ + "\" (" + std::to_string(samples_.size() / channels_ / sampleRate_) + " s"
+           + (loop_ ? ", looped)" : ")");
+}
+
+void FileAudioSource::Fill(float* out, size_t frameCount) {
+    size_t totalFrames = samples_.size() / channels_;
+    size_t filled = 0;
+    while (filled < frameCount) {
+        if (position_ >= totalFrames) {
+            if (!finished_.exchange(true, std::memory_order_acq_rel)) {
+                std::cout << "[AudioSource] Replay of " << path_ << " finished" << std::endl;
+            }
+            if (!loop_) {
+                std::fill(out + filled * channels_, out + frameCount * channels_, 0.0f);
+                return;
+            }
+            position_ = 0;
+        }
+        size_t n = std::min(frameCount - filled, totalFrames - position_);
+        std::copy(samples_.data() + position_ * channels_, samples_.data() + (position_ + n) * channels_,
+                  out + filled * channels_);
+        position_ += n;
+        filled += n;
+    }
+}
+
+// ============================================================================
+// NullAudioSource
+// ============================================================================
+
+bool NullAudioSource::Open(int sampleRate, int channels, Callback callback, void* user) {
+    SetCallback(callback, user);
+    sampleRate_ = sampleRate > 0 ? sampleRate : kNullSampleRate;
+    channels_ = channels > 0 ? channels : 1;
+    return true;
+}
+
+void NullAudioSource::Fill(float* out, size_t frameCount) {
+    std::fill(out, out + frameCount * channels_, 0.0f);
+}
+
+} // namespace DesktopPet
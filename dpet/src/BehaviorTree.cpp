@@ -0,0 +1,320 @@
+#include "../include/BehaviorTree.h"
+#include <iostream>
+#include <random>
+
+namespace DesktopPet {
+
+namespace {
+
+std::mt19937& Rng() {
+    static std::mt19937 rng(std::random_device{}());
+    return rng;
+}
+
+} // namespace
+
+// ============================================================================
+// Node base
+// ============================================================================
+
+BTStatus BTNode::Tick(BTContext& ctx) {
+    if (!running_) {
+        OnEnter(ctx);
+    }
+    BTStatus status = Update(ctx);
+    running_ = (status == BTStatus::Running);
+    return status;
+}
+
+void BTNode::Abort() {
+    if (running_) {
+        OnAbort();
+        running_ = false;
+    }
+}
+
+// ============================================================================
+// Composites
+// ============================================================================
+
+void BTComposite::OnAbort() {
+    for (auto& child : children_) {
+        child->Abort();
+    }
+    current_ = 0;
+}
+
+BTStatus BTSequence::Update(BTContext& ctx) {
+    while (current_ < children_.size()) {
+        BTStatus status = children_[current_]->Tick(ctx);
+        if (status != BTStatus::Success) {
+            return status;
+        }
+        ++current_;
+    }
+    return BTStatus::Success;
+}
+
+BTStatus BTSelector::Update(BTContext& ctx) {
+    while (current_ < children_.size()) {
+        BTStatus status = children_[current_]->Tick(ctx);
+        if (status != BTStatus::Failure) {
+            return status;
+        }
+        ++current_;
+    }
+    return BTStatus::Failure;
+}
+
+BTStatus BTPriority::Update(BTContext& ctx) {
+    for (size_t i = 0; i < children_.size(); ++i) {
+        BTStatus status = children_[i]->Tick(ctx);
+        if (status == BTStatus::Failure) {
+            continue;
+        }
+
+        // A higher-priority branch took over: interrupt the old one
+        if (current_ > i && current_ < children_.size()) {
+            children_[current_]->Abort();
+        }
+        current_ = i;
+        return status;
+    }
+    return BTStatus::Failure;
+}
+
+// ============================================================================
+// Decorators
+// ============================================================================
+
+BTStatus BTInverter::Update(BTContext& ctx) {
+    BTStatus status = child_->Tick(ctx);
+    if (status == BTStatus::Success) {
+        return BTStatus::Failure;
+    }
+    if (status == BTStatus::Failure) {
+        return BTStatus::Success;
+    }
+    return status;
+}
+
+BTStatus BTRepeat::Update(BTContext& ctx) {
+    BTStatus status = child_->Tick(ctx);
+    if (status != BTStatus::Success) {
+        return status;
+    }
+
+    ++done_;
+    if (count_ >= 0 && done_ >= count_) {
+        return BTStatus::Success;
+    }
+    // Start the next iteration on the next tick
+    return BTStatus::Running;
+}
+
+BTStatus BTCooldown::Update(BTContext& ctx) {
+    if (!child_->IsRunning() && ctx.blackboard->GetTime() < readyAt_) {
+        return BTStatus::Failure;
+    }
+
+    BTStatus status = child_->Tick(ctx);
+    if (status != BTStatus::Running) {
+        readyAt_ = ctx.blackboard->GetTime() + seconds_;
+    }
+    return status;
+}
+
+// ============================================================================
+// Leaves
+// ============================================================================
+
+BTStatus BTWait::Update(BTContext& ctx) {
+    elapsed_ += ctx.deltaTime;
+    return elapsed_ >= seconds_ ? BTStatus::Success : BTStatus::Running;
+}
+
+BTStatus BTFlag::Update(BTContext& ctx) {
+    return ctx.blackboard->ConsumeFlag(name_) ? BTStatus::Success : BTStatus::Failure;
+}
+
+BTStatus BTChance::Update(BTContext& ctx) {
+    (void)ctx;
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    return dist(Rng()) < probability_ ? BTStatus::Success : BTStatus::Failure;
+}
+
+BTStatus BTSay::Update(BTContext& ctx) {
+    if (lines_.empty()) {
+        return BTStatus::Failure;
+    }
+    std::uniform_int_distribution<size_t> dist(0, lines_.size() - 1);
+    const std::string& line = lines_[dist(Rng())];
+    if (ctx.eventQueue) {
+        ctx.eventQueue->push(AppEvent(EventType::SHOW_BUBBLE, line));
+        if (voice_) {
+            ctx.eventQueue->push(AppEvent(EventType::SPEAK, line));
+        }
+    }
+    return BTStatus::Success;
+}
+
+BTStatus BTExpression::Update(BTContext& ctx) {
+    if (ctx.eventQueue) {
+        ctx.eventQueue->push(AppEvent(EventType::UI_UPDATE, expression_));
+    }
+    return BTStatus::Success;
+}
+
+BTStatus BTLuaAction::Update(BTContext& ctx) {
+    sol::protected_function_result result = func_(ctx.deltaTime);
+    if (!result.valid()) {
+        sol::error err = result;
+        std::cerr << "[BehaviorTree] Lua action error: " << err.what() << std::endl;
+        return BTStatus::Failure;
+    }
+
+    sol::object value = result.get<sol::object>();
+    if (value.is<bool>()) {
+        return value.as<bool>() ? BTStatus::Success : BTStatus::Failure;
+    }
+    if (value.is<std::string>() && value.as<std::string>() == "running") {
+        return BTStatus::Running;
+    }
+    return BTStatus::Success;
+}
+
+// ============================================================================
+// BehaviorTree
+// ============================================================================
+
+BTNodePtr BehaviorTree::Build(const sol::table& spec, std::string& error) {
+    std::string type = spec.get_or<std::string>("type", "");
+
+    auto buildChild = [&error](const sol::table& node) -> BTNodePtr {
+        sol::optional<sol::table> child = node["child"];
+        if (!child) {
+            error = "decorator without child";
+            return nullptr;
+        }
+        return Build(*child, error);
+    };
+
+    if (type == "sequence" || type == "selector" || type == "priority") {
+        std::unique_ptr<BTComposite> composite;
+        if (type == "sequence") {
+            composite = std::make_unique<BTSequence>();
+        } else if (type == "selector") {
+            composite = std::make_unique<BTSelector>();
+        } else {
+            composite = std::make_unique<BTPriority>();
+        }
+
+        sol::optional<sol::table> children = spec["children"];
+        if (!children) {
+            error = type + " without children";
+            return nullptr;
+        }
+        for (size_t i = 1; i <= children->size(); ++i) {
+            sol::optional<sol::table> childSpec = (*children)[i];
+            if (!childSpec) {
+                error = type + " child " + std::to_string(i) + " is not a node";
+                return nullptr;
+            }
+            BTNodePtr child = Build(*childSpec, error);
+            if (!child) {
+                return nullptr;
+            }
+            composite->AddChild(std::move(child));
+        }
+        return composite;
+    }
+
+    if (type == "inverter" || type == "repeat" || type == "cooldown") {
+        BTNodePtr child = buildChild(spec);
+        if (!child) {
+            return nullptr;
+        }
+        if (type == "inverter") {
+            return std::make_unique<BTInverter>(std::move(child));
+        }
+        if (type == "repeat") {
+            return std::make_unique<BTRepeat>(std::move(child), spec.get_or("count", -1));
+        }
+        return std::make_unique<BTCooldown>(std::move(child), spec.get_or("seconds", 0.0f));
+    }
+
+    if (type == "wait") {
+        return std::make_unique<BTWait>(spec.get_or("seconds", 0.0f));
+    }
+    if (type == "flag") {
+        return std::make_unique<BTFlag>(spec.get_or<std::string>("name", ""));
+    }
+    if (type == "chance") {
+        return std::make_unique<BTChance>(spec.get_or("p", 0.5f));
+    }
+    if (type == "say") {
+        std::vector<std::string> lines;
+        sol::object text = spec["text"];
+        if (text.is<std::string>()) {
+            lines.push_back(text.as<std::string>());
+        } else if (text.is<sol::table>()) {
+            sol::table list = text.as<sol::table>();
+            for (size_t i = 1; i <= list.size(); ++i) {
+                lines.push_back(list.get<std::string>(i));
+            }
+        }
+        return std::make_unique<BTSay>(std::move(lines), spec.get_or("voice", false));
+    }
+    if (type == "expression") {
+        return std::make_unique<BTExpression>(spec.get_or<std::string>("name", "idle"));
+    }
+    if (type == "action") {
+        sol::optional<sol::protected_function> func = spec["fn"];
+        if (!func) {
+            error = "action without function";
+            return nullptr;
+        }
+        return std::make_unique<BTLuaAction>(*func);
+    }
+
+    error = "unknown node type '" + type + "'";
+    return nullptr;
+}
+
+void BehaviorTree::SetRoot(BTNodePtr root) {
+    if (root_) {
+        root_->Abort();
+    }
+    root_ = std::move(root);
+    blackboard_.Clear();
+}
+
+BTNodePtr BehaviorTree::ReleaseRoot() {
+    if (root_) {
+        root_->Abort();
+    }
+    return std::move(root_);
+}
+
+void BehaviorTree::Clear() {
+    SetRoot(nullptr);
+}
+
+void BehaviorTree::Tick(float deltaTime, ThreadSafeQueue<AppEvent>* eventQueue) {
+    if (!root_) {
+        return;
+    }
+
+    blackboard_.Advance(deltaTime);
+
+    BTContext ctx;
+    ctx.deltaTime = deltaTime;
+    ctx.blackboard = &blackboard_;
+    ctx.eventQueue = eventQueue;
+    root_->Tick(ctx);
+
+    // Stimuli are one-shot: anything no guard looked at this frame is dropped
+    blackboard_.Clear();
+}
+
+} // namespace DesktopPet
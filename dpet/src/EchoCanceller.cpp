@@ -0,0 +1,236 @@
+#include "../include/EchoCanceller.h"
+#include "../include/AudioDsp.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#ifdef DPET_HAVE_SPEEXDSP
+#include <speex/speex_echo.h>
+#endif
+
+namespace DesktopPet {
+
+namespace {
+
+constexpr float kStepSize = 0.3f;            // NLMS mu
+constexpr float kRegularization = 1e-5f;     // Per tap, keeps quiet references from blowing up the step
+constexpr float kGeigelThreshold = 0.6f;     // Echo is assumed at least ~4 dB below the reference
+constexpr float kActiveReference = 1e-3f;    // Reference peak below which nothing is playing
+constexpr int kDoubleTalkHoldFrames = 5;
+constexpr float kDoubleTalkRatio = 4.0f;     // Residual/mic energy this far above its baseline = near-end speech
+constexpr float kMinBaseline = 0.01f;        // -20 dB: don't expect more cancellation than this
+constexpr float kBaselineTracking = 0.05f;
+constexpr float kBaselineDrift = 0.002f;
+constexpr float kCopyRatio = 0.8f;           // Background must beat the output filter by ~1 dB
+constexpr float kResetRatio = 8.0f;          // Background diverged: restart it from the output filter
+
+#ifdef DPET_HAVE_SPEEXDSP
+int16_t ToPcm16(float sample) {
+    return static_cast<int16_t>(std::max(-1.0f, std::min(1.0f, sample)) * 32767.0f);
+}
+#endif
+
+float PeakOf(const float* data, size_t count) {
+    float peak = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        peak = std::max(peak, std::fabs(data[i]));
+    }
+    return peak;
+}
+
+} // namespace
+
+EchoCanceller::EchoCanceller(int sampleRate, int frameMs, int tailMs)
+    : sampleRate_(sampleRate),
+      frameSize_(static_cast<size_t>(sampleRate) * frameMs / 1000),
+      taps_(static_cast<size_t>(sampleRate) * tailMs / 1000) {
+    background_.assign(taps_, 0.0f);
+    foreground_.assign(taps_, 0.0f);
+    history_.assign(taps_ * 2, 0.0f);
+    referencePeaks_.assign((taps_ + frameSize_ - 1) / frameSize_ + 1, 0.0f);
+    padMic_.resize(frameSize_);
+    padRef_.resize(frameSize_);
+    padOut_.resize(frameSize_);
+    framePositions_.resize(frameSize_);
+    frameEnergies_.resize(frameSize_);
+
+#ifdef DPET_HAVE_SPEEXDSP
+    SpeexEchoState* state = speex_echo_state_init(static_cast<int>(frameSize_), static_cast<int>(taps_));
+    speex_echo_ctl(state, SPEEX_ECHO_SET_SAMPLING_RATE, &sampleRate_);
+    speex_ = state;
+    micPcm_.resize(frameSize_);
+    refPcm_.resize(frameSize_);
+    outPcm_.resize(frameSize_);
+#endif
+}
+
+EchoCanceller::~EchoCanceller() {
+#ifdef DPET_HAVE_SPEEXDSP
+    if (speex_) {
+        speex_echo_state_destroy(static_cast<SpeexEchoState*>(speex_));
+    }
+#endif
+}
+
+const char* EchoCanceller::BackendName() const {
+    return speex_ ? "SpeexDSP" : "NLMS";
+}
+
+void EchoCanceller::Reset() {
+    std::fill(background_.begin(), background_.end(), 0.0f);
+    std::fill(foreground_.begin(), foreground_.end(), 0.0f);
+    backgroundEnergy_ = 0.0f;
+    foregroundEnergy_ = 0.0f;
+    residualBaseline_ = 1.0f;
+    std::fill(history_.begin(), history_.end(), 0.0f);
+    std::fill(referencePeaks_.begin(), referencePeaks_.end(), 0.0f);
+    position_ = 0;
+    historyEnergy_ = 0.0f;
+    holdFrames_ = 0;
+#ifdef DPET_HAVE_SPEEXDSP
+    if (speex_) {
+        speex_echo_state_reset(static_cast<SpeexEchoState*>(speex_));
+    }
+#endif
+}
+
+void EchoCanceller::Process(const float* mic, const float* reference, float* out, size_t count) {
+    size_t offset = 0;
+    for (; offset + frameSize_ <= count; offset += frameSize_) {
+        ProcessFrame(mic + offset, reference + offset, out + offset);
+    }
+
+    size_t rest = count - offset;
+    if (rest > 0) {
+        std::fill(padMic_.begin(), padMic_.end(), 0.0f);
+        std::fill(padRef_.begin(), padRef_.end(), 0.0f);
+        std::copy(mic + offset, mic + count, padMic_.begin());
+        std::copy(reference + offset, reference + count, padRef_.begin());
+        ProcessFrame(padMic_.data(), padRef_.data(), padOut_.data());
+        std::copy(padOut_.begin(), padOut_.begin() + rest, out + offset);
+    }
+}
+
+void EchoCanceller::ProcessFrame(const float* mic, const float* reference, float* out) {
+    auto start = std::chrono::steady_clock::now();
+
+    // Geigel double-talk detector: near-end speech is louder than any echo
+    // the recent reference could have produced
+    referencePeaks_[peakIndex_] = PeakOf(reference, frameSize_);
+    peakIndex_ = (peakIndex_ + 1) % referencePeaks_.size();
+    float referencePeak = *std::max_element(referencePeaks_.begin(), referencePeaks_.end());
+    bool referenceActive = referencePeak > kActiveReference;
+    bool doubleTalk = referenceActive && PeakOf(mic, frameSize_) > kGeigelThreshold * referencePeak;
+
+#ifdef DPET_HAVE_SPEEXDSP
+    if (speex_) {
+        for (size_t i = 0; i < frameSize_; ++i) {
+            micPcm_[i] = ToPcm16(mic[i]);
+            refPcm_[i] = ToPcm16(reference[i]);
+        }
+        speex_echo_cancellation(static_cast<SpeexEchoState*>(speex_), micPcm_.data(), refPcm_.data(), outPcm_.data());
+        for (size_t i = 0; i < frameSize_; ++i) {
+            out[i] = outPcm_[i] / 32768.0f;
+        }
+    } else
+#endif
+    {
+        doubleTalk = ProcessFrameNlms(mic, reference, out, referenceActive, doubleTalk);
+    }
+
+    if (referenceActive) {
+        if (doubleTalk) {
+            ++doubleTalkFrames_;
+        } else {
+            echoInEnergy_ += Dsp::Dot(mic, mic, frameSize_);
+            echoOutEnergy_ += Dsp::Dot(out, out, frameSize_);
+        }
+    }
+
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    ++frames_;
+    totalUs_ += us;
+    maxUs_ = std::max(maxUs_, us);
+}
+
+bool EchoCanceller::ProcessFrameNlms(const float* mic, const float* reference, float* out,
+                                     bool referenceActive, bool doubleTalk) {
+    // Pass 1: shift the reference in and cancel with the output filter.
+    // The history energy is recomputed once per frame so it cannot drift.
+    historyEnergy_ = Dsp::Dot(&history_[position_], &history_[position_], taps_);
+    float micEnergy = 0.0f;
+    float residualEnergy = 0.0f;
+    for (size_t n = 0; n < frameSize_; ++n) {
+        float oldest = history_[position_ + taps_ - 1];
+        position_ = (position_ == 0 ? taps_ : position_) - 1;
+        history_[position_] = reference[n];
+        history_[position_ + taps_] = reference[n];
+        historyEnergy_ = std::max(0.0f, historyEnergy_ + reference[n] * reference[n] - oldest * oldest);
+        framePositions_[n] = position_;
+        frameEnergies_[n] = historyEnergy_;
+
+        float error = mic[n] - Dsp::Dot(foreground_.data(), &history_[position_], taps_);
+        out[n] = error;
+        micEnergy += mic[n] * mic[n];
+        residualEnergy += error * error;
+    }
+    if (!referenceActive) {
+        holdFrames_ = 0;
+        return false;
+    }
+
+    // Once the output filter cancels well, a jump in the residual means the
+    // user is talking; the slow drift on the baseline lets a changed echo
+    // path (not speech) eventually be re-learned
+    float ratio = residualEnergy / (micEnergy + 1e-9f);
+    if (doubleTalk || ratio > kDoubleTalkRatio * residualBaseline_) {
+        holdFrames_ = kDoubleTalkHoldFrames;
+        residualBaseline_ += kBaselineDrift * (ratio - residualBaseline_);
+    } else if (holdFrames_ > 0) {
+        --holdFrames_;
+    } else {
+        residualBaseline_ += kBaselineTracking * (ratio - residualBaseline_);
+    }
+    residualBaseline_ = std::max(residualBaseline_, kMinBaseline);
+    if (holdFrames_ > 0) {
+        return true;
+    }
+
+    // Pass 2: adapt the background filter over the same samples
+    const float floor = kRegularization * taps_;
+    float backgroundEnergy = 0.0f;
+    for (size_t n = 0; n < frameSize_; ++n) {
+        const float* x = &history_[framePositions_[n]];
+        float error = mic[n] - Dsp::Dot(background_.data(), x, taps_);
+        backgroundEnergy += error * error;
+        Dsp::MixAdd(background_.data(), x, taps_, kStepSize * error / (frameEnergies_[n] + floor));
+    }
+
+    // Two-path update: the output filter only takes the background weights
+    // once they cancel better, so a missed double-talk frame cannot
+    // corrupt the output directly
+    backgroundEnergy_ = 0.5f * backgroundEnergy_ + backgroundEnergy;
+    foregroundEnergy_ = 0.5f * foregroundEnergy_ + residualEnergy;
+    if (backgroundEnergy_ < kCopyRatio * foregroundEnergy_) {
+        foreground_ = background_;
+        foregroundEnergy_ = backgroundEnergy_;
+    } else if (backgroundEnergy_ > kResetRatio * foregroundEnergy_) {
+        background_ = foreground_;
+        backgroundEnergy_ = foregroundEnergy_;
+    }
+    return false;
+}
+
+EchoCanceller::Stats EchoCanceller::GetStats() const {
+    Stats stats;
+    stats.frames = frames_;
+    stats.doubleTalkFrames = doubleTalkFrames_;
+    stats.avgFrameUs = frames_ > 0 ? totalUs_ / frames_ : 0.0;
+    stats.maxFrameUs = maxUs_;
+    if (echoOutEnergy_ > 0.0 && echoInEnergy_ > 0.0) {
+        stats.erleDb = static_cast<float>(10.0 * std::log10(echoInEnergy_ / echoOutEnergy_));
+    }
+    return stats;
+}
+
+} // namespace DesktopPet
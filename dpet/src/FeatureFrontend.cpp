@@ -0,0 +1,156 @@
+#include "../include/FeatureFrontend.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace DesktopPet {
+
+namespace {
+
+constexpr int kFrameMs = 25;
+constexpr int kShiftMs = 10;
+constexpr size_t kFftSize = 512;
+constexpr float kPreEmphasis = 0.97f;
+constexpr float kLowHz = 20.0f;
+constexpr float kHighHzBelowNyquist = 400.0f;
+constexpr float kFloor = 1e-10f;
+
+float HzToMel(float hz) {
+    return 1127.0f * std::log(1.0f + hz / 700.0f);
+}
+
+float MelToHz(float mel) {
+    return 700.0f * (std::exp(mel / 1127.0f) - 1.0f);
+}
+
+} // namespace
+
+FeatureFrontend::FeatureFrontend(int sampleRate, size_t ringFrames)
+    : sampleRate_(sampleRate),
+      frameLength_(static_cast<size_t>(sampleRate) * kFrameMs / 1000),
+      frameShift_(static_cast<size_t>(sampleRate) * kShiftMs / 1000),
+      ring_(ringFrames) {
+    fft_.Configure(kFftSize);
+    pending_.resize(frameLength_);
+    frame_.assign(kFftSize, 0.0f);
+    power_.resize(fft_.Bins());
+
+    // Povey window (Hann to the power 0.85), as in Kaldi/sherpa-onnx fbank
+    const double pi = 3.14159265358979323846;
+    window_.resize(frameLength_);
+    double windowEnergy = 0.0;
+    for (size_t i = 0; i < frameLength_; ++i) {
+        double hann = 0.5 - 0.5 * std::cos(2.0 * pi * i / (frameLength_ - 1));
+        window_[i] = static_cast<float>(std::pow(hann, 0.85));
+        windowEnergy += window_[i] * window_[i];
+    }
+    // Scale so a band's summed power is the mean square of the signal in it
+    powerScale_ = static_cast<float>(2.0 / (kFftSize * windowEnergy));
+
+    float lowMel = HzToMel(kLowHz);
+    float highMel = HzToMel(sampleRate / 2.0f - kHighHzBelowNyquist);
+    float melStep = (highMel - lowMel) / (FeatureFrame::kMelBins + 1);
+    float binHz = static_cast<float>(sampleRate) / kFftSize;
+    filters_.resize(FeatureFrame::kMelBins);
+    centresHz_.resize(FeatureFrame::kMelBins);
+    for (size_t m = 0; m < FeatureFrame::kMelBins; ++m) {
+        float left = lowMel + m * melStep;
+        float centre = left + melStep;
+        float right = centre + melStep;
+        centresHz_[m] = MelToHz(centre);
+
+        MelFilter& filter = filters_[m];
+        filter.firstBin = 0;
+        for (size_t k = 1; k < kFftSize / 2; ++k) {
+            float mel = HzToMel(k * binHz);
+            if (mel <= left || mel >= right) {
+                continue;
+            }
+            if (filter.weights.empty()) {
+                filter.firstBin = k;
+            }
+            // Bins inside the triangle are contiguous
+            filter.weights.resize(k - filter.firstBin + 1, 0.0f);
+            filter.weights.back() = mel <= centre ? (mel - left) / (centre - left) : (right - mel) / (right - centre);
+        }
+    }
+}
+
+void FeatureFrontend::Reset() {
+    pendingCount_ = 0;
+}
+
+void FeatureFrontend::Accept(const float* samples, size_t count, int64_t endNs) {
+    auto start = std::chrono::steady_clock::now();
+    const double nsPerSample = 1e9 / sampleRate_;
+
+    size_t consumed = 0;
+    while (consumed < count) {
+        size_t n = std::min(count - consumed, frameLength_ - pendingCount_);
+        std::copy(samples + consumed, samples + consumed + n, pending_.begin() + pendingCount_);
+        pendingCount_ += n;
+        consumed += n;
+        if (pendingCount_ < frameLength_) {
+            break;
+        }
+        ComputeFrame(pending_.data(), endNs - static_cast<int64_t>((count - consumed) * nsPerSample));
+        std::copy(pending_.begin() + frameShift_, pending_.end(), pending_.begin());
+        pendingCount_ = frameLength_ - frameShift_;
+    }
+
+    computeMs_ += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    samplesProcessed_ += count;
+}
+
+void FeatureFrontend::ComputeFrame(const float* samples, int64_t endNs) {
+    float mean = 0.0f;
+    for (size_t i = 0; i < frameLength_; ++i) {
+        mean += samples[i];
+    }
+    mean /= frameLength_;
+
+    float energy = 0.0f;
+    float previous = samples[0] - mean;
+    for (size_t i = 0; i < frameLength_; ++i) {
+        float x = samples[i] - mean;
+        energy += x * x;
+        frame_[i] = (x - kPreEmphasis * previous) * window_[i];
+        previous = x;
+    }
+    // frame_ beyond frameLength_ stays zero (padding)
+
+    fft_.Compute(frame_.data(), power_.data());
+
+    FeatureFrame& out = ring_.Next();
+    out.index = ring_.WriteIndex();
+    out.endNs = endNs;
+    out.energyDb = 10.0f * std::log10(energy / frameLength_ + kFloor);
+    for (size_t m = 0; m < FeatureFrame::kMelBins; ++m) {
+        const MelFilter& filter = filters_[m];
+        float bandPower = Dsp::Dot(filter.weights.data(), &power_[filter.firstBin], filter.weights.size());
+        out.mel[m] = std::log(std::max(bandPower * powerScale_, kFloor));
+    }
+    ring_.Commit();
+}
+
+void FeatureFrontend::BandRange(float lowHz, float highHz, size_t& first, size_t& last) const {
+    first = std::lower_bound(centresHz_.begin(), centresHz_.end(), lowHz) - centresHz_.begin();
+    last = std::lower_bound(centresHz_.begin(), centresHz_.end(), highHz) - centresHz_.begin();
+}
+
+double FeatureFrontend::CpuPercent() const {
+    double audioMs = samplesProcessed_ * 1000.0 / sampleRate_;
+    return audioMs > 0.0 ? 100.0 * computeMs_ / audioMs : 0.0;
+}
+
+void FeatureFrontend::PrintStats() const {
+    if (samplesProcessed_ == 0) {
+        return;
+    }
+    std::cout << "[FeatureFrontend] " << ring_.WriteIndex() << " frames ("
+              << samplesProcessed_ / sampleRate_ << " s), CPU " << CpuPercent() << "% of one core ("
+              << Dsp::SimdName() << ")" << std::endl;
+}
+
+} // namespace DesktopPet
@@ -0,0 +1,150 @@
+#include "../include/KeywordSpotter.h"
+#include "sherpa-onnx/c-api/c-api.h"
+#include <iostream>
+#include <filesystem>
+#include <chrono>
+#include <cstring>
+
+namespace fs = std::filesystem;
+
+namespace DesktopPet {
+
+namespace {
+
+constexpr int REPORT_INTERVAL_SECONDS = 300;
+
+/**
+ * @brief Find "<prefix>*.onnx" in dir, preferring the int8 export (cheaper to run continuously)
+ */
+std::string FindModelFile(const std::string& dir, const std::string& prefix) {
+    std::string fallback;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind(prefix, 0) != 0 || entry.path().extension() != ".onnx") {
+            continue;
+        }
+        if (name.find(".int8.") != std::string::npos) {
+            return entry.path().string();
+        }
+        fallback = entry.path().string();
+    }
+    return fallback;
+}
+
+} // namespace
+
+KeywordSpotter::~KeywordSpotter() {
+    if (stream_) {
+        SherpaOnnxDestroyOnlineStream(stream_);
+        stream_ = nullptr;
+    }
+    if (spotter_) {
+        SherpaOnnxDestroyKeywordSpotter(spotter_);
+        spotter_ = nullptr;
+    }
+}
+
+bool KeywordSpotter::Init(const KwsConfig& config) {
+    std::cout << "[KeywordSpotter] Loading KWS model from " << config.modelDir << std::endl;
+    const std::string& dir = config.modelDir;
+
+    // Strings must outlive SherpaOnnxCreateKeywordSpotter
+    std::string encoder = FindModelFile(dir, "encoder");
+    std::string decoder = FindModelFile(dir, "decoder");
+    std::string joiner = FindModelFile(dir, "joiner");
+    std::string tokens = dir + "/tokens.txt";
+    std::string keywords = config.keywordsFile.empty() ? dir + "/keywords.txt" : config.keywordsFile;
+
+    if (encoder.empty() || decoder.empty() || joiner.empty() || !fs::exists(tokens) || !fs::exists(keywords)) {
+        std::cerr << "[KeywordSpotter] Model, tokens or keywords file missing in " << dir << std::endl;
+        return false;
+    }
+
+    SherpaOnnxKeywordSpotterConfig kwsConfig;
+    memset(&kwsConfig, 0, sizeof(kwsConfig));
+
+    kwsConfig.feat_config.sample_rate = config.sampleRate;
+    kwsConfig.feat_config.feature_dim = 80;
+    kwsConfig.model_config.transducer.encoder = encoder.c_str();
+    kwsConfig.model_config.transducer.decoder = decoder.c_str();
+    kwsConfig.model_config.transducer.joiner = joiner.c_str();
+    kwsConfig.model_config.tokens = tokens.c_str();
+    kwsConfig.model_config.num_threads = config.numThreads;
+    kwsConfig.model_config.provider = "cpu";
+    kwsConfig.model_config.debug = 0;
+    kwsConfig.max_active_paths = 4;
+    kwsConfig.num_trailing_blanks = 1;
+    kwsConfig.keywords_score = config.keywordsScore;
+    kwsConfig.keywords_threshold = config.keywordsThreshold;
+    kwsConfig.keywords_file = keywords.c_str();
+
+    spotter_ = SherpaOnnxCreateKeywordSpotter(&kwsConfig);
+    if (!spotter_) {
+        std::cerr << "[KeywordSpotter] KWS model load failed" << std::endl;
+        return false;
+    }
+    stream_ = SherpaOnnxCreateKeywordStream(spotter_);
+
+    sampleRate_ = config.sampleRate;
+    nextReportSamples_ = static_cast<size_t>(REPORT_INTERVAL_SECONDS) * sampleRate_;
+    std::cout << "[KeywordSpotter] KWS loaded (keywords: " << keywords << ")" << std::endl;
+    return true;
+}
+
+std::string KeywordSpotter::Accept(const float* samples, size_t count) {
+    if (!spotter_ || count == 0) {
+        return "";
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::string keyword;
+
+    SherpaOnnxOnlineStreamAcceptWaveform(stream_, sampleRate_, samples, static_cast<int32_t>(count));
+    while (SherpaOnnxIsKeywordStreamReady(spotter_, stream_)) {
+        SherpaOnnxDecodeKeywordStream(spotter_, stream_);
+        const SherpaOnnxKeywordResult* result = SherpaOnnxGetKeywordResult(spotter_, stream_);
+        if (result && result->keyword && result->keyword[0] != '\0') {
+            keyword = result->keyword;
+            // Must reset after a hit or the same keyword fires again
+            SherpaOnnxResetKeywordStream(spotter_, stream_);
+            ++detections_;
+        }
+        SherpaOnnxDestroyKeywordResult(result);
+        if (!keyword.empty()) {
+            break;
+        }
+    }
+
+    computeMs_ += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    samplesProcessed_ += count;
+    if (samplesProcessed_ >= nextReportSamples_) {
+        nextReportSamples_ += static_cast<size_t>(REPORT_INTERVAL_SECONDS) * sampleRate_;
+        PrintStats();
+    }
+    return keyword;
+}
+
+void KeywordSpotter::Reset() {
+    if (!spotter_) {
+        return;
+    }
+    // A fresh stream also drops queued feature frames
+    SherpaOnnxDestroyOnlineStream(stream_);
+    stream_ = SherpaOnnxCreateKeywordStream(spotter_);
+}
+
+double KeywordSpotter::CpuPercent() const {
+    double audioMs = samplesProcessed_ * 1000.0 / sampleRate_;
+    return audioMs > 0.0 ? 100.0 * computeMs_ / audioMs : 0.0;
+}
+
+void KeywordSpotter::PrintStats() const {
+    if (samplesProcessed_ == 0) {
+        return;
+    }
+    std::cout << "[KeywordSpotter] " << samplesProcessed_ / sampleRate_ << " s listened, "
+              << detections_ << " wake words, CPU " << CpuPercent() << "% of one core" << std::endl;
+}
+
+} // namespace DesktopPet
@@ -0,0 +1,211 @@
+#include "../include/LuaAllocator.h"
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+namespace DesktopPet {
+
+namespace {
+
+// Size classes tuned for Lua objects: small strings, table nodes, closures,
+// upvalues and short arrays dominate; everything above 512 bytes is rare.
+constexpr size_t kSizeClasses[] = {16, 32, 48, 64, 80, 96, 128, 160, 192, 256, 320, 384, 512};
+
+} // namespace
+
+LuaAllocator::LuaAllocator() {
+    for (size_t blockSize : kSizeClasses) {
+        Pool pool;
+        pool.blockSize = blockSize;
+        pools_.push_back(pool);
+    }
+
+    // Precompute size -> pool index so lookups are a single table read
+    classLookup_.resize(kMaxSmallSize / kGranularity + 1);
+    int index = 0;
+    for (size_t slot = 0; slot < classLookup_.size(); ++slot) {
+        size_t size = slot * kGranularity;
+        while (pools_[index].blockSize < size) {
+            ++index;
+        }
+        classLookup_[slot] = static_cast<int8_t>(index);
+    }
+}
+
+LuaAllocator::~LuaAllocator() {
+    for (void* slab : slabs_) {
+        std::free(slab);
+    }
+    slabs_.clear();
+}
+
+void* LuaAllocator::Alloc(void* ud, void* ptr, size_t osize, size_t nsize) {
+    LuaAllocator* self = static_cast<LuaAllocator*>(ud);
+
+    if (nsize == 0) {
+        if (ptr) {
+            self->Free(ptr, osize);
+        }
+        return nullptr;
+    }
+
+    // When ptr is NULL, osize encodes the object type, not a size
+    if (!ptr) {
+        return self->Allocate(nsize);
+    }
+
+    return self->Reallocate(ptr, osize, nsize);
+}
+
+void LuaAllocator::ResetCounters() {
+    stats_.allocCount = 0;
+    stats_.freeCount = 0;
+    stats_.reallocCount = 0;
+    stats_.poolHits = 0;
+    stats_.largeAllocs = 0;
+    stats_.slabRefills = 0;
+    stats_.failedAllocs = 0;
+    stats_.peakBytes = stats_.bytesInUse;
+}
+
+int LuaAllocator::PoolIndex(size_t size) const {
+    if (size > kMaxSmallSize) {
+        return -1;
+    }
+    return classLookup_[(size + kGranularity - 1) / kGranularity];
+}
+
+bool LuaAllocator::RefillPool(Pool& pool) {
+    char* slab = static_cast<char*>(std::malloc(kSlabSize));
+    if (!slab) {
+        return false;
+    }
+    slabs_.push_back(slab);
+    stats_.reservedBytes += kSlabSize;
+    stats_.slabRefills++;
+
+    // Thread the new blocks onto the free list
+    size_t count = kSlabSize / pool.blockSize;
+    for (size_t i = count; i > 0; --i) {
+        FreeBlock* block = reinterpret_cast<FreeBlock*>(slab + (i - 1) * pool.blockSize);
+        block->next = pool.freeList;
+        pool.freeList = block;
+    }
+    return true;
+}
+
+void* LuaAllocator::AllocateFromPool(int index) {
+    Pool& pool = pools_[index];
+    if (!pool.freeList && !RefillPool(pool)) {
+        return nullptr;
+    }
+
+    FreeBlock* block = pool.freeList;
+    pool.freeList = block->next;
+    stats_.poolHits++;
+    return block;
+}
+
+void* LuaAllocator::Allocate(size_t size) {
+    if (limit_ && stats_.bytesInUse + size > limit_) {
+        stats_.failedAllocs++;
+        return nullptr;
+    }
+
+    void* ptr = nullptr;
+    int index = PoolIndex(size);
+    if (index >= 0) {
+        ptr = AllocateFromPool(index);
+    } else {
+        ptr = std::malloc(size);
+        stats_.largeAllocs++;
+    }
+
+    if (!ptr) {
+        return nullptr;
+    }
+
+    stats_.allocCount++;
+    stats_.bytesInUse += size;
+    stats_.peakBytes = std::max(stats_.peakBytes, stats_.bytesInUse);
+    return ptr;
+}
+
+void LuaAllocator::Free(void* ptr, size_t size) {
+    int index = PoolIndex(size);
+    if (index >= 0) {
+        FreeBlock* block = static_cast<FreeBlock*>(ptr);
+        block->next = pools_[index].freeList;
+        pools_[index].freeList = block;
+    } else {
+        std::free(ptr);
+    }
+
+    stats_.freeCount++;
+    stats_.bytesInUse -= size;
+}
+
+void* LuaAllocator::Reallocate(void* ptr, size_t osize, size_t nsize) {
+    // Lua assumes shrinking never fails, so only growth is checked
+    if (limit_ && nsize > osize && stats_.bytesInUse + (nsize - osize) > limit_) {
+        stats_.failedAllocs++;
+        return nullptr;
+    }
+
+    stats_.reallocCount++;
+
+    int oldIndex = PoolIndex(osize);
+    int newIndex = PoolIndex(nsize);
+
+    void* result = nullptr;
+    if (oldIndex >= 0 && oldIndex == newIndex) {
+        // Still fits in the same size class
+        result = ptr;
+    } else if (oldIndex < 0 && newIndex < 0) {
+        result = std::realloc(ptr, nsize);
+        if (!result && nsize < osize) {
+            // A shrink must not fail: keep the old, larger block
+            result = ptr;
+        }
+        if (!result) {
+            return nullptr;
+        }
+    } else {
+        // Moving between a pool and malloc, or between pools
+        if (newIndex >= 0) {
+            result = AllocateFromPool(newIndex);
+        } else {
+            result = std::malloc(nsize);
+            stats_.largeAllocs++;
+        }
+        if (!result && nsize < osize) {
+            // A shrink must not fail: the old block is big enough. Lua frees
+            // it later with the new size, so it joins that size class; a
+            // malloc block is kept with the slabs so it is still released
+            if (oldIndex < 0) {
+                slabs_.push_back(ptr);
+            }
+            stats_.bytesInUse = stats_.bytesInUse - osize + nsize;
+            return ptr;
+        }
+        if (!result) {
+            return nullptr;
+        }
+
+        std::memcpy(result, ptr, std::min(osize, nsize));
+
+        if (oldIndex >= 0) {
+            FreeBlock* block = static_cast<FreeBlock*>(ptr);
+            block->next = pools_[oldIndex].freeList;
+            pools_[oldIndex].freeList = block;
+        } else {
+            std::free(ptr);
+        }
+    }
+
+    stats_.bytesInUse = stats_.bytesInUse - osize + nsize;
+    stats_.peakBytes = std::max(stats_.peakBytes, stats_.bytesInUse);
+    return result;
+}
+
+} // namespace DesktopPet
@@ -0,0 +1,230 @@
+#include "../include/LuaProfiler.h"
+#include <lua.hpp>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace DesktopPet {
+
+namespace {
+
+// Registry key used to find the profiler from inside the hook
+const char kRegistryKey = 0;
+
+constexpr int kMaxStackDepth = 64;
+
+std::string FrameName(const lua_Debug& ar) {
+    if (ar.what && std::string(ar.what) == "main") {
+        return std::string("<main> ") + ar.short_src;
+    }
+    std::string name = ar.name ? ar.name : "<anon>";
+    if (ar.what && std::string(ar.what) == "C") {
+        return name + " [C]";
+    }
+    return name + " " + ar.short_src + ":" + std::to_string(ar.linedefined);
+}
+
+std::vector<std::pair<std::string, double>> TopEntries(
+        const std::unordered_map<std::string, double>& totals, size_t topN) {
+    std::vector<std::pair<std::string, double>> sorted(totals.begin(), totals.end());
+    std::sort(sorted.begin(), sorted.end(),
+              [](const auto& a, const auto& b) { return a.second > b.second; });
+    if (sorted.size() > topN) {
+        sorted.resize(topN);
+    }
+    return sorted;
+}
+
+} // namespace
+
+LuaProfiler::LuaProfiler(int instructionInterval)
+    : instructionInterval_(instructionInterval) {
+}
+
+LuaProfiler::~LuaProfiler() {
+    Stop();
+}
+
+void LuaProfiler::Start(lua_State* L, Mode mode) {
+    Stop();
+    state_ = L;
+
+    lua_pushlightuserdata(L, this);
+    lua_rawsetp(L, LUA_REGISTRYINDEX, &kRegistryKey);
+
+    if (mode == Mode::Line) {
+        lua_sethook(L, &LuaProfiler::Hook, LUA_MASKLINE, 0);
+    } else {
+        lua_sethook(L, &LuaProfiler::Hook, LUA_MASKCOUNT, instructionInterval_);
+    }
+
+    // Started from inside Lua (sys.profile), so a slice is already open; its
+    // entry was recorded by BeginSlice and is charged if no hook fires
+    lastSample_ = std::chrono::steady_clock::now();
+}
+
+void LuaProfiler::Stop() {
+    if (!state_) {
+        return;
+    }
+
+    lua_sethook(state_, nullptr, 0, 0);
+    lua_pushnil(state_);
+    lua_rawsetp(state_, LUA_REGISTRYINDEX, &kRegistryKey);
+    state_ = nullptr;
+}
+
+void LuaProfiler::Reset() {
+    stacks_.clear();
+    functions_.clear();
+    lines_.clear();
+    currentStack_.clear();
+    currentFunction_.clear();
+    currentLine_.clear();
+}
+
+void LuaProfiler::BeginSlice(const char* entry, const char* detail) {
+    // Recorded even while stopped: sys.profile starts the profiler inside a slice
+    inSlice_ = true;
+    sliceEntry_ = entry;
+    sliceDetail_ = detail;
+    currentStack_.clear();
+    currentFunction_.clear();
+    currentLine_.clear();
+    lastSample_ = std::chrono::steady_clock::now();
+}
+
+void LuaProfiler::EndSlice() {
+    if (state_ && inSlice_) {
+        // In count mode a slice shorter than the instruction interval never
+        // hits the hook; charge it to the entry point so short per-frame
+        // handlers still show up
+        if (currentStack_.empty() && sliceEntry_) {
+            currentStack_ = sliceEntry_;
+            if (sliceDetail_) {
+                currentStack_ += ' ';
+                currentStack_ += sliceDetail_;
+            }
+            currentFunction_ = currentStack_;
+        }
+        Charge(std::chrono::steady_clock::now());
+    }
+    inSlice_ = false;
+    sliceEntry_ = nullptr;
+    sliceDetail_ = nullptr;
+}
+
+void LuaProfiler::Hook(lua_State* L, lua_Debug* ar) {
+    (void)ar;
+    lua_rawgetp(L, LUA_REGISTRYINDEX, &kRegistryKey);
+    LuaProfiler* self = static_cast<LuaProfiler*>(lua_touserdata(L, -1));
+    lua_pop(L, 1);
+
+    if (self && self->inSlice_) {
+        self->Sample(L);
+    }
+}
+
+void LuaProfiler::Charge(std::chrono::steady_clock::time_point now) {
+    double micros = std::chrono::duration<double, std::micro>(now - lastSample_).count();
+    lastSample_ = now;
+
+    if (currentStack_.empty()) {
+        return;
+    }
+
+    Entry& stack = stacks_[currentStack_];
+    stack.samples++;
+    stack.micros += micros;
+
+    Entry& function = functions_[currentFunction_];
+    function.samples++;
+    function.micros += micros;
+
+    // Unsampled slices have no line
+    if (!currentLine_.empty()) {
+        Entry& line = lines_[currentLine_];
+        line.samples++;
+        line.micros += micros;
+    }
+}
+
+void LuaProfiler::Sample(lua_State* L) {
+    auto now = std::chrono::steady_clock::now();
+
+    // Time since the previous hook belongs to what was running then
+    bool firstInSlice = currentStack_.empty();
+    if (!firstInSlice) {
+        Charge(now);
+    }
+
+    // Walk from the running function (level 0) to the outermost caller
+    std::vector<std::string> frames;
+    lua_Debug info;
+    for (int level = 0; level < kMaxStackDepth && lua_getstack(L, level, &info); ++level) {
+        lua_getinfo(L, "Sln", &info);
+        frames.push_back(FrameName(info));
+        if (level == 0) {
+            currentFunction_ = frames.back();
+            currentLine_ = std::string(info.short_src) + ":" + std::to_string(info.currentline);
+        }
+    }
+
+    currentStack_.clear();
+    for (auto it = frames.rbegin(); it != frames.rend(); ++it) {
+        if (!currentStack_.empty()) {
+            currentStack_ += ';';
+        }
+        currentStack_ += *it;
+    }
+
+    // Time from slice entry up to the first hook goes to the first stack seen
+    if (firstInSlice) {
+        Charge(now);
+    }
+}
+
+bool LuaProfiler::DumpFolded(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+
+    for (const auto& [stack, entry] : stacks_) {
+        uint64_t micros = static_cast<uint64_t>(entry.micros + 0.5);
+        if (micros > 0) {
+            out << stack << ' ' << micros << '\n';
+        }
+    }
+    return true;
+}
+
+std::string LuaProfiler::Report(size_t topN) const {
+    std::unordered_map<std::string, double> functionTotals;
+    std::unordered_map<std::string, double> lineTotals;
+    double total = 0.0;
+    for (const auto& [name, entry] : functions_) {
+        functionTotals[name] = entry.micros;
+        total += entry.micros;
+    }
+    for (const auto& [name, entry] : lines_) {
+        lineTotals[name] = entry.micros;
+    }
+
+    std::ostringstream ss;
+    ss.setf(std::ios::fixed);
+    ss.precision(1);
+    ss << "Lua profile: " << total / 1000.0 << " ms sampled\n";
+    ss << "  Top functions:\n";
+    for (const auto& [name, micros] : TopEntries(functionTotals, topN)) {
+        ss << "    " << micros / 1000.0 << " ms  " << name << "\n";
+    }
+    ss << "  Top lines:\n";
+    for (const auto& [name, micros] : TopEntries(lineTotals, topN)) {
+        ss << "    " << micros / 1000.0 << " ms  " << name << "\n";
+    }
+    return ss.str();
+}
+
+} // namespace DesktopPet
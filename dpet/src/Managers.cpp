@@ -4,6 +4,10 @@
 #include <chrono>
 #include <thread>
 #include <ctime>
+#include <algorithm>
+#include <iterator>
+#include <cmath>
+#include <random>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -12,13 +16,57 @@
 // Include ASR and LLM headers
 #define MINIAUDIO_IMPLEMENTATION
 #include "miniaudio/miniaudio.h"
-#include "sherpa-onnx/c-api/c-api.h"
 #include "llama.h"
 
 namespace DesktopPet {
 
 constexpr int MAX_CONTEXT_TOKENS = 1800;
 
+// Barge-in detection (capture callback)
+constexpr float BARGE_IN_MIN_RMS = 0.02f;       // Absolute speech floor (about -34 dBFS)
+constexpr float BARGE_IN_ECHO_MARGIN = 1.5f;    // Mic level must exceed this x pet output level
+constexpr int BARGE_IN_ONSET_MS = 120;          // Sustained speech before interrupting
+constexpr int BARGE_IN_HANGOVER_MS = 60;        // Short dips inside a word don't reset the onset
+constexpr int BARGE_IN_END_SILENCE_MS = 800;    // Silence that ends the interrupting utterance
+constexpr int WAKE_WORD_NO_SPEECH_MS = 4000;    // Give up if nothing is said after the wake word
+constexpr float PLAYBACK_LEVEL_DECAY_MS = 200.0f;
+
+// Capture
+constexpr int PREROLL_MS = 500;                 // Audio kept from before a recording is triggered
+constexpr size_t CAPTURE_CHUNK = 1600;          // Samples per front-end/keyword-spotter call (100 ms)
+constexpr int CAPTURE_RING_MS = 2000;           // Native-rate capture queued for the audio thread (outlasts a transcription)
+constexpr int CAPTURE_PROCESS_INTERVAL_MS = 50; // Live-audio processing keeps up with capture while recording
+
+// Voice activity on the shared feature frames (speech band, dB after pre-emphasis)
+constexpr float VAD_LOW_HZ = 300.0f;
+constexpr float VAD_HIGH_HZ = 3400.0f;
+constexpr float VAD_MARGIN_DB = 9.0f;           // Above the noise floor
+constexpr float VAD_MIN_SPEECH_DB = -50.0f;     // Never call quieter frames speech
+constexpr float VAD_INITIAL_FLOOR_DB = -70.0f;
+constexpr float VAD_FLOOR_RISE_DB = 0.01f;      // Per 10 ms frame, so speech barely lifts the floor
+constexpr int REFERENCE_SLACK_MS = 20;          // Allowed reference jitter before dropping the excess
+
+// ASR
+constexpr int ASR_WARMUP_MS = 3000;             // Synthetic audio decoded at load, about a short utterance
+
+// Join segment transcripts; a space only between two Latin-script words
+static void AppendTranscript(std::string& text, const char* part) {
+    if (!part || !*part) {
+        return;
+    }
+    unsigned char last = text.empty() ? ' ' : static_cast<unsigned char>(text.back());
+    unsigned char first = static_cast<unsigned char>(*part);
+    if (last < 0x80 && last != ' ' && first < 0x80 && first != ' ') {
+        text += ' ';
+    }
+    text += part;
+}
+
+static int64_t SteadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 // ============================================================================
 // UIManager Implementation
 // ============================================================================
@@ -270,12 +318,19 @@ void AIEngine::ThreadLoop() {
         AppEvent event = eventOpt.value();
         
         if (event.type == EventType::AUDIO_INPUT || event.type == EventType::AI_THINK) {
+            // Number the turn as soon as it is taken, so a barge-in from here
+            // on cancels it even before generation starts
+            uint64_t turn = turn_.fetch_add(1) + 1;
             std::cout << "[AIEngine] Processing: " << event.payload << std::endl;
             
             // Use real LLM
-            std::string response = ChatWithLLM(event.payload);
+            std::string response = ChatWithLLM(event.payload, turn);
             
             std::cout << "[AIEngine] LLM response: " << response << std::endl;
+            if (lastReplyCancelled_) {
+                // The user talked over the pet; their new utterance follows
+                continue;
+            }
             
             // Escape single quotes in response for Lua
             std::string escapedResponse = response;
@@ -302,11 +357,27 @@ void AIEngine::ThreadLoop() {
     std::cout << "[AIEngine] Thread loop ended" << std::endl;
 }
 
-std::string AIEngine::ChatWithLLM(const std::string& userInput) {
+void AIEngine::CancelGeneration() {
+    // Latch the current turn; the AI thread compares it with the turn it
+    // is on, so nothing depends on when the cancel arrives
+    cancelRequestNs_ = SteadyNowNs();
+    cancelledTurn_ = turn_.load();
+}
+
+std::string AIEngine::ChatWithLLM(const std::string& userInput, uint64_t turn) {
+    lastReplyCancelled_ = false;
     if (!llama_model_ || !llama_context_ || !context_manager_) {
         return "[Error: LLM not initialized]";
     }
     
+    auto cancelled = [this, turn]() { return cancelledTurn_.load(std::memory_order_relaxed) >= turn; };
+    if (cancelled()) {
+        // Talked over before generation started: skip the prompt entirely
+        lastReplyCancelled_ = true;
+        std::cout << "[AIEngine] Turn cancelled before generation" << std::endl;
+        return "";
+    }
+    
     // Get formatted prompt with sliding window history
     std::string fullPrompt = context_manager_->GetPromptString(userInput);
     
@@ -344,6 +415,11 @@ std::string AIEngine::ChatWithLLM(const std::string& userInput) {
     
     // Token-by-token generation
     while (n_generated < max_tokens) {
+        if (cancelled()) {
+            lastReplyCancelled_ = true;
+            break;
+        }
+        
         llama_token new_token = llama_sampler_sample(sampler_chain, llama_context_, -1);
         llama_sampler_accept(sampler_chain, new_token);
         
@@ -360,6 +436,16 @@ std::string AIEngine::ChatWithLLM(const std::string& userInput) {
             response.append(token_text);
             std::cout << token_text << std::flush;
             
+            // Stream the piece to Lua subscribers (events.on("TOKEN_DELTA")) and TTS
+            if (token_text.rfind("<|", 0) != 0) {
+                if (outputQueue_) {
+                    outputQueue_->push(AppEvent(EventType::TOKEN_DELTA, token_text));
+                }
+                if (onToken_) {
+                    onToken_(token_text);
+                }
+            }
+            
             // Check for Qwen end marker
             if (response.find("<|im_end|>") != std::string::npos) {
                 break;
@@ -378,15 +464,28 @@ std::string AIEngine::ChatWithLLM(const std::string& userInput) {
     llama_sampler_free(sampler_chain);
     std::cout << std::endl;
     
+    if (lastReplyCancelled_) {
+        std::cout << "[AIEngine] Generation cancelled after " << n_generated << " tokens ("
+                  << (SteadyNowNs() - cancelRequestNs_) / 1e6 << " ms after the request)" << std::endl;
+    }
+    
+    if (onReplyEnd_) {
+        onReplyEnd_();
+    }
+    
     // Clean up response
     size_t pos = response.find("<|im_end|>");
     if (pos != std::string::npos) {
         response = response.substr(0, pos);
     }
     
-    // Add to sliding window history (auto-truncates old messages)
-    context_manager_->AddMessage("user", userInput);
-    context_manager_->AddMessage("assistant", response);
+    // Add to sliding window history (auto-truncates old messages). A reply
+    // cut off by barge-in was never heard in full; keep it out of the
+    // history so later turns aren't conditioned on half a sentence
+    if (!lastReplyCancelled_) {
+        context_manager_->AddMessage("user", userInput);
+        context_manager_->AddMessage("assistant", response);
+    }
     
     return response;
 }
@@ -411,6 +510,10 @@ void AIEngine::CleanupLLM() {
 // ScriptRunner Implementation
 // ============================================================================
 
+ScriptRunner::ScriptRunner()
+    : lua_(sol::default_at_panic, &LuaAllocator::Alloc, &allocator_) {
+}
+
 bool ScriptRunner::Init(ThreadSafeQueue<AppEvent>* eventQueue) {
     eventQueue_ = eventQueue;
     
@@ -419,6 +522,8 @@ bool ScriptRunner::Init(ThreadSafeQueue<AppEvent>* eventQueue) {
                            sol::lib::table, sol::lib::os);
         
         BindFunctions();
+        BindBehaviorTree();
+        BindEvents();
         
         initialized_ = true;
         std::cout << "[ScriptRunner] Initialized" << std::endl;
@@ -449,6 +554,35 @@ void ScriptRunner::BindFunctions() {
         std::cout << "[Lua] pet.setExpression: " << expr << std::endl;
     };
     
+    pet["showMessage"] = [this](const std::string& message) {
+        if (eventQueue_) {
+            eventQueue_->push(AppEvent(EventType::SHOW_BUBBLE, message));
+        }
+    };
+    
+    // pet.playSound(name[, gain]) triggers a preloaded sound effect directly
+    // (not via the event queue, which would add up to a frame of latency)
+    pet["playSound"] = [this](const std::string& name, sol::optional<float> gain) -> bool {
+        if (!audioManager_ || !audioManager_->PlayEffect(name, gain.value_or(1.0f))) {
+            std::cerr << "[Lua] pet.playSound: sound not loaded: " << name << std::endl;
+            return false;
+        }
+        return true;
+    };
+    
+    // pet.speak: bubble plus TTS; scripted lines are cached on disk
+    pet["speak"] = [this](const std::string& message) {
+        std::cout << "[Lua] pet.speak: " << message << std::endl;
+        if (eventQueue_) {
+            eventQueue_->push(AppEvent(EventType::SHOW_BUBBLE, message));
+            eventQueue_->push(AppEvent(EventType::SPEAK, message));
+        }
+    };
+    
+    pet["log"] = [](const std::string& message) {
+        std::cout << "[Lua] " << message << std::endl;
+    };
+    
     // Create sys namespace
     auto sys = lua_["sys"].get_or_create<sol::table>();
     
@@ -470,6 +604,173 @@ void ScriptRunner::BindFunctions() {
         strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", localtime(&time_t));
         return buffer;
     };
+    
+    // pet.getTime mirrors sys.getTime for scripts written against PetAPI
+    pet["getTime"] = sys["getTime"];
+    
+    // sys.profile(true[, "line"]) starts sampling, sys.profile(false) stops
+    // and prints the top functions/lines
+    sys["profile"] = [this](bool enable, sol::optional<std::string> mode) {
+        LuaProfiler::Mode profileMode = (mode && *mode == "line")
+            ? LuaProfiler::Mode::Line : LuaProfiler::Mode::Count;
+        SetProfiling(enable, profileMode);
+    };
+    
+    // sys.profileDump(path) writes folded stacks for flamegraph.pl
+    sys["profileDump"] = [this](const std::string& path) -> bool {
+        bool ok = profiler_.DumpFolded(path);
+        std::cout << "[ScriptRunner] Profile dump " << (ok ? "written to " : "failed: ") << path << std::endl;
+        return ok;
+    };
+}
+
+void ScriptRunner::SetProfiling(bool enable, LuaProfiler::Mode mode) {
+    if (enable) {
+        profiler_.Reset();
+        profiler_.Start(lua_.lua_state(), mode);
+        std::cout << "[ScriptRunner] Profiler started ("
+                  << (mode == LuaProfiler::Mode::Line ? "line" : "count") << " mode)" << std::endl;
+    } else if (profiler_.IsRunning()) {
+        profiler_.Stop();
+        std::cout << "[ScriptRunner] Profiler stopped" << std::endl;
+        std::cout << profiler_.Report() << std::flush;
+    }
+}
+
+void ScriptRunner::BindBehaviorTree() {
+    // Node constructors are plain Lua tables; bt.run turns the spec into a
+    // native tree once, after which ticking does not touch the interpreter
+    // except for bt.action leaves on the active branch.
+    lua_.script(R"(
+        bt = {}
+        function bt.sequence(children) return { type = "sequence", children = children } end
+        function bt.selector(children) return { type = "selector", children = children } end
+        function bt.priority(children) return { type = "priority", children = children } end
+        function bt.inverter(child) return { type = "inverter", child = child } end
+        function bt.loop(child, count) return { type = "repeat", child = child, count = count } end
+        function bt.cooldown(seconds, child) return { type = "cooldown", seconds = seconds, child = child } end
+        function bt.wait(seconds) return { type = "wait", seconds = seconds } end
+        function bt.flag(name) return { type = "flag", name = name } end
+        function bt.chance(p) return { type = "chance", p = p } end
+        function bt.say(text) return { type = "say", text = text } end
+        function bt.speak(text) return { type = "say", text = text, voice = true } end
+        function bt.expression(name) return { type = "expression", name = name } end
+        function bt.action(fn) return { type = "action", fn = fn } end
+    )");
+    
+    auto bt = lua_["bt"].get<sol::table>();
+    
+    bt["run"] = [this](const sol::table& spec) -> bool {
+        std::string error;
+        BTNodePtr root = BehaviorTree::Build(spec, error);
+        if (!root) {
+            std::cerr << "[ScriptRunner] bt.run: " << error << std::endl;
+            return false;
+        }
+        ReplaceBehavior(std::move(root));
+        std::cout << "[ScriptRunner] Behavior tree installed" << std::endl;
+        return true;
+    };
+    
+    bt["stop"] = [this]() {
+        ReplaceBehavior(nullptr);
+    };
+    
+    bt["setFlag"] = [this](const std::string& name) {
+        behavior_.GetBlackboard().SetFlag(name);
+    };
+}
+
+void ScriptRunner::BindEvents() {
+    auto events = lua_["events"].get_or_create<sol::table>();
+    
+    // events.on(type, fn) -> id; fn(payload, typeName) runs for each event
+    events["on"] = [this](const std::string& typeName, sol::protected_function handler) -> int {
+        EventType type;
+        if (!ParseEventType(typeName, type)) {
+            std::cerr << "[ScriptRunner] events.on: unknown event type " << typeName << std::endl;
+            return 0;
+        }
+        
+        Subscription subscription;
+        subscription.id = nextSubscriptionId_++;
+        subscription.handler = std::move(handler);
+        subscription.owner = currentChunk_;
+        int id = subscription.id;
+        
+        if (dispatching_) {
+            pendingSubscriptions_.emplace_back(type, std::move(subscription));
+        } else {
+            subscriptions_[static_cast<size_t>(type)].push_back(std::move(subscription));
+        }
+        return id;
+    };
+    
+    // events.off(id) removes a handler returned by events.on
+    events["off"] = [this](int id) {
+        pendingUnsubscriptions_.push_back(id);
+        if (!dispatching_) {
+            FlushPendingSubscriptions();
+        }
+    };
+}
+
+void ScriptRunner::FlushPendingSubscriptions() {
+    for (auto& [type, subscription] : pendingSubscriptions_) {
+        subscriptions_[static_cast<size_t>(type)].push_back(std::move(subscription));
+    }
+    pendingSubscriptions_.clear();
+    
+    for (int id : pendingUnsubscriptions_) {
+        for (auto& handlers : subscriptions_) {
+            handlers.erase(std::remove_if(handlers.begin(), handlers.end(),
+                [id](const Subscription& s) { return s.id == id; }), handlers.end());
+        }
+    }
+    pendingUnsubscriptions_.clear();
+}
+
+void ScriptRunner::Dispatch(const AppEvent& event) {
+    size_t index = static_cast<size_t>(event.type);
+    if (!initialized_ || index >= EVENT_TYPE_COUNT || subscriptions_[index].empty()) {
+        return;
+    }
+    
+    const char* typeName = EventTypeName(event.type);
+    
+    dispatching_ = true;
+    profiler_.BeginSlice("events.on", typeName);
+    for (auto& subscription : subscriptions_[index]) {
+        sol::protected_function_result result = subscription.handler(event.payload, typeName);
+        if (!result.valid()) {
+            sol::error err = result;
+            std::cerr << "[ScriptRunner] " << typeName << " handler error: " << err.what() << std::endl;
+        }
+    }
+    profiler_.EndSlice();
+    dispatching_ = false;
+    
+    if (!pendingSubscriptions_.empty() || !pendingUnsubscriptions_.empty()) {
+        FlushPendingSubscriptions();
+    }
+}
+
+void ScriptRunner::TickBehavior(float deltaTime) {
+    if (!behavior_.HasRoot()) {
+        return;
+    }
+    profiler_.BeginSlice("bt.tick");
+    behavior_.Tick(deltaTime, eventQueue_);
+    profiler_.EndSlice();
+}
+
+void ScriptRunner::ReplaceBehavior(BTNodePtr root) {
+    // A reloading chunk may still fail: keep the tree it replaces until then
+    if (reloading_ && !treeReplaced_) {
+        replacedTree_ = behavior_.ReleaseRoot();
+        treeReplaced_ = true;
+    }
+    behavior_.SetRoot(std::move(root));
 }
 
 bool ScriptRunner::RunScript(const std::string& code) {
@@ -478,10 +779,13 @@ bool ScriptRunner::RunScript(const std::string& code) {
         return false;
     }
     
+    profiler_.BeginSlice("<script>");
     try {
         lua_.script(code);
+        profiler_.EndSlice();
         return true;
     } catch (const sol::error& e) {
+        profiler_.EndSlice();
         std::cerr << "[ScriptRunner] Execution error: " << e.what() << std::endl;
         return false;
     }
@@ -493,98 +797,519 @@ bool ScriptRunner::LoadFile(const std::string& path) {
         return false;
     }
     
+    std::string previousChunk = currentChunk_;
+    currentChunk_ = path;
+    profiler_.BeginSlice("<main>", path.c_str());
     try {
         lua_.script_file(path);
+        profiler_.EndSlice();
+        currentChunk_ = previousChunk;
+        if (std::find(loadedFiles_.begin(), loadedFiles_.end(), path) == loadedFiles_.end()) {
+            loadedFiles_.push_back(path);
+        }
         std::cout << "[ScriptRunner] Loaded file: " << path << std::endl;
         return true;
     } catch (const sol::error& e) {
+        profiler_.EndSlice();
+        currentChunk_ = previousChunk;
         std::cerr << "[ScriptRunner] File load error: " << e.what() << std::endl;
         return false;
     }
 }
 
+bool ScriptRunner::EnableHotReload() {
+    if (loadedFiles_.empty()) {
+        return false;
+    }
+    
+    return watcher_.Start(loadedFiles_, [this](CompiledScript&& script) {
+        std::lock_guard<std::mutex> lock(reloadMutex_);
+        pendingReloads_.push_back(std::move(script));
+        reloadReady_ = true;
+    });
+}
+
+void ScriptRunner::PollReload() {
+    if (!reloadReady_) {
+        return;
+    }
+    
+    std::vector<CompiledScript> scripts;
+    {
+        std::lock_guard<std::mutex> lock(reloadMutex_);
+        scripts.swap(pendingReloads_);
+        reloadReady_ = false;
+    }
+    
+    for (const auto& script : scripts) {
+        ApplyReload(script);
+    }
+}
+
+bool ScriptRunner::ApplyReload(const CompiledScript& script) {
+    if (!script.error.empty()) {
+        std::cerr << "[ScriptRunner] Reload rejected, keeping old code: " << script.error << std::endl;
+        return false;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    
+    sol::load_result chunk = lua_.load(script.bytecode, "@" + script.path, sol::load_mode::binary);
+    if (!chunk.valid()) {
+        sol::error err = chunk;
+        std::cerr << "[ScriptRunner] Reload load error: " << err.what() << std::endl;
+        return false;
+    }
+    
+    // State handed to the new code's onReload
+    sol::object oldState = lua_["state"];
+    sol::protected_function saveState = lua_["onSaveState"];
+    if (saveState.valid()) {
+        sol::protected_function_result saved = saveState();
+        if (saved.valid()) {
+            oldState = saved.get<sol::object>();
+        }
+    }
+    
+    // Snapshot everything the chunk may replace
+    sol::table globals = lua_.globals();
+    sol::table snapshot = lua_.create_table();
+    for (const auto& entry : globals) {
+        snapshot[entry.first] = entry.second;
+    }
+    // Only this file's handlers are replaced; other files keep theirs
+    auto ownedByChunk = [&script](const Subscription& s) { return s.owner == script.path; };
+    std::array<std::vector<Subscription>, EVENT_TYPE_COUNT> oldSubscriptions;
+    for (size_t i = 0; i < EVENT_TYPE_COUNT; ++i) {
+        auto& handlers = subscriptions_[i];
+        auto owned = std::stable_partition(handlers.begin(), handlers.end(),
+            [&](const Subscription& s) { return !ownedByChunk(s); });
+        std::move(owned, handlers.end(), std::back_inserter(oldSubscriptions[i]));
+        handlers.erase(owned, handlers.end());
+    }
+    
+    currentChunk_ = script.path;
+    reloading_ = true;
+    treeReplaced_ = false;
+    sol::protected_function run = chunk;
+    profiler_.BeginSlice("<main>", script.path.c_str());
+    sol::protected_function_result result = run();
+    profiler_.EndSlice();
+    currentChunk_.clear();
+    reloading_ = false;
+    BTNodePtr oldTree = std::move(replacedTree_);
+    
+    if (!result.valid()) {
+        sol::error err = result;
+        std::cerr << "[ScriptRunner] Reload failed, rolled back: " << err.what() << std::endl;
+        
+        std::vector<sol::object> added;
+        for (const auto& entry : globals) {
+            if (snapshot[entry.first].get_type() == sol::type::lua_nil) {
+                added.push_back(entry.first);
+            }
+        }
+        for (const auto& key : added) {
+            globals[key] = sol::lua_nil;
+        }
+        for (const auto& entry : snapshot) {
+            globals[entry.first] = entry.second;
+        }
+        for (size_t i = 0; i < EVENT_TYPE_COUNT; ++i) {
+            auto& handlers = subscriptions_[i];
+            handlers.erase(std::remove_if(handlers.begin(), handlers.end(), ownedByChunk), handlers.end());
+            std::move(oldSubscriptions[i].begin(), oldSubscriptions[i].end(), std::back_inserter(handlers));
+        }
+        if (treeReplaced_) {
+            behavior_.SetRoot(std::move(oldTree));
+        }
+        return false;
+    }
+    
+    CallFunction("onReload", oldState);
+    
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "[ScriptRunner] Reloaded " << script.path << " in " << elapsed << " ms" << std::endl;
+    return true;
+}
+
 // ============================================================================
 // AudioManager Implementation
 // ============================================================================
 
-// Global audio buffer for callback
-static std::vector<float> g_audio_buffer_global;
+// Recorded audio at SAMPLE_RATE (pool chunks, attached in InitializeRecognizer),
+// appended by the audio thread as it converts the capture
+static PooledAudio g_audio_buffer_global;
 static std::mutex g_audio_mutex_global;
 static std::atomic<bool> g_recording_global(false);
+static PooledAudio g_reference_buffer_global;  // Echo reference, same length as the audio buffer
+static std::vector<float> g_reference_block_global;   // Callback scratch for one reference block
+static std::atomic<uint32_t> g_capture_session_global(0);  // Bumped for every new recording
+static uint32_t g_buffered_session_global = 0;             // Audio thread only
+
+/**
+ * @brief The last PREROLL_MS of audio captured while not recording
+ *
+ * The capture device runs all the time; a new recording starts with this
+ * audio, so the first syllable spoken before the trigger is not lost.
+ */
+struct PreRollBuffer {
+    explicit PreRollBuffer(size_t capacity) : mic(capacity), reference(capacity) {}
+    
+    void Push(const float* micBlock, const float* referenceBlock, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            mic[position] = micBlock[i];
+            reference[position] = referenceBlock ? referenceBlock[i] : 0.0f;
+            position = (position + 1) % mic.size();
+        }
+        filled = std::min(filled + count, mic.size());
+    }
+    
+    /**
+     * @brief Replace the recording buffers with the pre-roll, oldest first
+     */
+    void MoveTo(PooledAudio& micOut, PooledAudio& referenceOut, bool withReference) {
+        size_t start = (position + mic.size() - filled) % mic.size();
+        size_t first = std::min(filled, mic.size() - start);
+        micOut.Clear();
+        referenceOut.Clear();
+        micOut.Append(&mic[start], first);
+        micOut.Append(&mic[0], filled - first);
+        if (withReference) {
+            referenceOut.Append(&reference[start], first);
+            referenceOut.Append(&reference[0], filled - first);
+        }
+        filled = 0;
+    }
+    
+    std::vector<float> mic;
+    std::vector<float> reference;
+    size_t position = 0;
+    size_t filled = 0;
+};
+static PreRollBuffer g_preroll_global(SAMPLE_RATE * PREROLL_MS / 1000);
 
-void AudioManager::AudioCallback(ma_device* pDevice, void* pOutput, 
-                                 const void* pInput, unsigned int frameCount) {
-    if (!g_recording_global) return;
+void AudioManager::AudioCallback(void* user, const float* samples, unsigned int frameCount) {
+    AudioManager* self = static_cast<AudioManager*>(user);
+    const float* pInputF = samples;
+    int64_t startNs = SteadyNowNs();
+    
+    // Frames stay at the device rate and channel count; the audio thread
+    // converts them (ProcessCapture). Whole blocks only, so frames stay aligned
+    size_t sampleCount = static_cast<size_t>(frameCount) * self->captureChannels_;
+    bool recording = g_recording_global;
+    if (SpscRing<float>* capture = self->activeCaptureRing_.load(std::memory_order_acquire)) {
+        if (capture->WriteAvailable() >= sampleCount) {
+            capture->Write(pInputF, sampleCount);
+        } else {
+            self->captureOverruns_.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (!recording && capture->ReadAvailable() >= self->captureSignalSamples_) {
+            self->audioEvent_.Signal();
+        }
+    }
+    
+    // The level gate doesn't care about rate or channel layout
+    self->DetectVoice(pInputF, static_cast<unsigned int>(sampleCount), self->monitoring_.load(std::memory_order_relaxed));
+    
+    // Pair the block with what was played meanwhile; consumed on every
+    // block so the lag, and the echo path the canceller learns, stays steady.
+    // The reference is at SAMPLE_RATE: take as much as this block becomes
+    if (SpscRing<float>* reference = self->activeReference_.load(std::memory_order_acquire)) {
+        uint64_t scaled = static_cast<uint64_t>(frameCount) * SAMPLE_RATE + self->referenceRemainder_;
+        size_t count = static_cast<size_t>(scaled / self->captureRate_);
+        self->referenceRemainder_ = scaled % self->captureRate_;
+        
+        size_t slack = SAMPLE_RATE * REFERENCE_SLACK_MS / 1000;
+        size_t available = reference->ReadAvailable();
+        if (available > count + 2 * slack) {
+            reference->Skip(available - count - slack);
+        }
+        g_reference_block_global.resize(count);
+        size_t read = reference->Read(g_reference_block_global.data(), count);
+        std::fill(g_reference_block_global.begin() + read, g_reference_block_global.end(), 0.0f);
+        self->pairedReferenceRing_->Write(g_reference_block_global.data(), count);
+    }
+    
+    // Callback cost; the rate/channel conversion is no longer part of it
+    int64_t elapsedNs = SteadyNowNs() - startNs;
+    self->callbackCount_.fetch_add(1, std::memory_order_relaxed);
+    self->callbackNsTotal_.fetch_add(elapsedNs, std::memory_order_relaxed);
+    if (elapsedNs > self->callbackNsMax_.load(std::memory_order_relaxed)) {
+        self->callbackNsMax_.store(elapsedNs, std::memory_order_relaxed);
+    }
+    self->lastCaptureNs_.store(startNs, std::memory_order_release);
+}
+
+void AudioManager::StoreCapture(const float* samples, size_t count) {
+    // The reference the callback paired with these samples
+    const float* referenceBlock = nullptr;
+    if (activeReference_.load(std::memory_order_acquire)) {
+        referenceChunk_.resize(count);
+        size_t read = pairedReferenceRing_->Read(referenceChunk_.data(), count);
+        std::fill(referenceChunk_.begin() + read, referenceChunk_.end(), 0.0f);
+        referenceBlock = referenceChunk_.data();
+    }
     
-    const float* pInputF = (const float*)pInput;
     std::lock_guard<std::mutex> lock(g_audio_mutex_global);
+    if (!g_recording_global) {
+        g_preroll_global.Push(samples, referenceBlock, count);
+        return;
+    }
     
-    for (unsigned int i = 0; i < frameCount; ++i) {
-        g_audio_buffer_global.push_back(pInputF[i]);
+    // First block of a new recording: start from the pre-roll
+    uint32_t session = g_capture_session_global.load(std::memory_order_acquire);
+    if (session != g_buffered_session_global) {
+        g_buffered_session_global = session;
+        g_preroll_global.MoveTo(g_audio_buffer_global, g_reference_buffer_global, referenceBlock != nullptr);
+    }
+    
+    // Pool chunks only, no allocation; a recording longer than the pool was sized for is cut off
+    g_audio_buffer_global.Append(samples, count);
+    if (referenceBlock) {
+        g_reference_buffer_global.Append(referenceBlock, count);
     }
-    (void)pOutput;
 }
 
-AudioManager::~AudioManager() {
-    Stop();
-    CleanupRecognizer();
+void AudioManager::DetectVoice(const float* samples, unsigned int sampleCount, bool monitoring) {
+    if (sampleCount == 0 || !monitoring || g_recording_global) {
+        return;
+    }
+    float rms = std::sqrt(Dsp::Dot(samples, samples, sampleCount) / sampleCount);
+    int64_t now = SteadyNowNs();
+    
+    // Speakers leak into the microphone: the user must be clearly louder
+    // than whatever the pet is playing right now
+    float threshold = std::max(BARGE_IN_MIN_RMS,
+                               BARGE_IN_ECHO_MARGIN * playbackLevel_.load(std::memory_order_relaxed));
+    if (rms > threshold) {
+        if (pendingOnsetNs_ == 0) {
+            pendingOnsetNs_ = now;
+        }
+        lastLoudNs_ = now;
+    } else if (pendingOnsetNs_ != 0 && now - lastLoudNs_ > BARGE_IN_HANGOVER_MS * 1000000LL) {
+        pendingOnsetNs_ = 0;
+    }
     
-    if (audio_device_) {
-        ma_device_uninit(audio_device_);
-        delete audio_device_;
-        audio_device_ = nullptr;
+    if (pendingOnsetNs_ != 0 && now - pendingOnsetNs_ >= BARGE_IN_ONSET_MS * 1000000LL) {
+        // Silence the pet from the next playback period and keep recording
+        voiceOnsetNs_.store(pendingOnsetNs_, std::memory_order_relaxed);
+        bargeInNs_.store(now, std::memory_order_relaxed);
+        lastVoiceNs_.store(now, std::memory_order_relaxed);
+        silencedNs_.store(0, std::memory_order_relaxed);
+        outputMuted_.store(true, std::memory_order_release);
+        g_capture_session_global++;
+        g_recording_global = true;
+        bargeInDetected_.store(true, std::memory_order_release);
+        audioEvent_.Signal();
+        pendingOnsetNs_ = 0;
     }
 }
 
-bool AudioManager::InitializeRecognizer(const std::string& modelDir) {
-    std::cout << "[AudioManager] Initializing ASR..." << std::endl;
-    std::cout << "[AudioManager]   Model dir: " << modelDir << std::endl;
+void AudioManager::PlaybackCallback(ma_device* pDevice, void* pOutput, 
+                                    const void* pInput, unsigned int frameCount) {
+    AudioManager* self = static_cast<AudioManager*>(pDevice->pUserData);
+    float* out = static_cast<float*>(pOutput);
+    
+    size_t read = 0;
+    if (self->outputMuted_.load(std::memory_order_acquire)) {
+        // Barge-in: drop whatever speech is left
+        self->playbackRing_->Discard();
+        int64_t expected = 0;
+        self->silencedNs_.compare_exchange_strong(expected, SteadyNowNs(), std::memory_order_relaxed);
+    } else {
+        read = self->playbackRing_->Read(out, frameCount);
+    }
+    std::fill(out + read, out + frameCount, 0.0f);
     
-    SherpaOnnxOfflineRecognizerConfig config;
-    memset(&config, 0, sizeof(config));
+    // Speech ran out: the audio thread may stop listening for barge-in
+    bool playing = read > 0;
+    if (self->playbackActive_ && !playing) {
+        self->NotifySpeakingChanged();
+    }
+    self->playbackActive_ = playing;
     
-    std::string modelPath = modelDir + "/model.onnx";
-    std::string tokensPath = modelDir + "/tokens.txt";
+    if (SoundMixer* mixer = self->activeMixer_.load(std::memory_order_acquire)) {
+        mixer->Mix(out, frameCount);
+    }
     
-    config.model_config.sense_voice.model = modelPath.c_str();
-    config.model_config.sense_voice.language = "auto";
-    config.model_config.sense_voice.use_itn = 1;
-    config.model_config.tokens = tokensPath.c_str();
-    config.model_config.num_threads = 2;
-    config.model_config.provider = "cpu";
-    config.model_config.debug = 0;
+    // Output level for the barge-in echo gate (held, then decaying)
+    float energy = 0.0f;
+    for (unsigned int i = 0; i < frameCount; ++i) {
+        energy += out[i] * out[i];
+    }
+    float rms = frameCount > 0 ? std::sqrt(energy / frameCount) : 0.0f;
+    float decay = std::max(0.0f, 1.0f - frameCount * 1000.0f / (PLAYBACK_LEVEL_DECAY_MS * self->playbackRate_));
+    float level = std::max(rms, self->playbackLevel_.load(std::memory_order_relaxed) * decay);
+    self->playbackLevel_.store(level, std::memory_order_relaxed);
+    
+    // Echo reference at the capture rate (dropped if capture is not reading)
+    if (SpscRing<float>* reference = self->activeReference_.load(std::memory_order_acquire)) {
+        float converted[1024];
+        for (unsigned int offset = 0; offset < frameCount; offset += 256) {
+            unsigned int count = std::min(256u, frameCount - offset);
+            size_t written = self->referenceResampler_.Process(out + offset, count, converted);
+            reference->Write(converted, written);
+        }
+    }
     
-    config.decoding_method = "greedy_search";
-    config.max_active_paths = 4;
+    if (read > 0 && self->awaitingFirstAudio_.load(std::memory_order_acquire)) {
+        self->firstAudioNs_.store(SteadyNowNs(), std::memory_order_relaxed);
+        self->awaitingFirstAudio_.store(false, std::memory_order_release);
+    }
+    (void)pInput;
+}
+
+AudioManager::~AudioManager() {
+    Stop();
+    CleanupRecognizer();
     
-    recognizer_ = SherpaOnnxCreateOfflineRecognizer(&config);
-    if (!recognizer_) {
-        std::cerr << "[AudioManager] ASR model load failed" << std::endl;
+    if (playback_device_) {
+        ma_device_uninit(playback_device_);
+        delete playback_device_;
+        playback_device_ = nullptr;
+    }
+    
+    captureSource_.reset();
+    
+    // Return the chunks before the pool goes away
+    g_audio_buffer_global = PooledAudio();
+    g_reference_buffer_global = PooledAudio();
+}
+
+bool AudioManager::InitializeRecognizer(const std::string& modelDir) {
+    AsrConfig config;
+    config.modelDir = modelDir;
+    return InitializeRecognizer(config);
+}
+
+bool AudioManager::InitializeRecognizer(const AsrConfig& config) {
+    if (!LoadRecognizer(config)) {
         return false;
     }
     
-    std::cout << "[AudioManager] ASR loaded successfully" << std::endl;
+    // Initialize audio capture
+    // 0 = the source's own channel count and rate, so the device layer
+    // doesn't resample inside the callback; ProcessCapture converts instead
+    auto source = AudioSource::Create(sourceConfig_);
+    if (!source->Open(nativeCapture_ ? 0 : SAMPLE_RATE, nativeCapture_ ? 0 : CHANNELS, AudioCallback, this)) {
+        std::cerr << "[AudioManager] Audio capture init failed" << std::endl;
+        return false;
+    }
+    captureSource_ = std::move(source);
+    captureRate_ = captureSource_->SampleRate();
+    captureChannels_ = captureSource_->Channels();
+    if (captureRate_ != SAMPLE_RATE) {
+        captureResampler_.Configure(captureRate_, SAMPLE_RATE);
+    }
     
-    // Initialize audio device
-    audio_device_ = new ma_device();
-    ma_device_config deviceConfig = ma_device_config_init(ma_device_type_capture);
-    deviceConfig.capture.format = ma_format_f32;
-    deviceConfig.capture.channels = CHANNELS;
-    deviceConfig.sampleRate = SAMPLE_RATE;
-    deviceConfig.dataCallback = AudioCallback;
-    deviceConfig.pUserData = nullptr;
+    // Capture storage for the longest recording plus pre-roll, for the mic,
+    // the echo reference, the echo-cancelled copy and the utterance in ASR
+    size_t recordingSamples = static_cast<size_t>(recording_seconds_ + 1) * SAMPLE_RATE
+                              + SAMPLE_RATE * PREROLL_MS / 1000;
+    size_t chunksPerStream = (recordingSamples + AudioChunkPool::kChunkSamples - 1) / AudioChunkPool::kChunkSamples;
+    capturePool_ = std::make_unique<AudioChunkPool>(4 * chunksPerStream, captureEncoding_);
+    {
+        std::lock_guard<std::mutex> lock(g_audio_mutex_global);
+        g_audio_buffer_global = PooledAudio(capturePool_.get());
+        g_reference_buffer_global = PooledAudio(capturePool_.get());
+        g_reference_block_global.reserve(SAMPLE_RATE / 10);
+    }
+    asrInput_.reserve(recordingSamples);
+    
+    // Live audio: capture callback -> captureRing_ (device format) -> audio
+    // thread converts, stores and runs the front-end
+    frontend_ = std::make_unique<FeatureFrontend>(SAMPLE_RATE);
+    frontend_->BandRange(VAD_LOW_HZ, VAD_HIGH_HZ, vadFirstBand_, vadLastBand_);
+    vadReader_ = frontend_->Frames().NewReader();
+    noiseFloorDb_ = VAD_INITIAL_FLOOR_DB;
+    size_t nativeChunkFrames = (CAPTURE_CHUNK * captureRate_ + SAMPLE_RATE - 1) / SAMPLE_RATE;
+    nativeChunk_.resize(nativeChunkFrames * captureChannels_);
+    convertedChunk_.resize(captureResampler_.MaxOutput(nativeChunkFrames));
+    referenceChunk_.reserve(convertedChunk_.size());
+    captureSignalSamples_ = nativeChunk_.size();
+    captureRing_ = std::make_unique<SpscRing<float>>(
+        static_cast<size_t>(captureRate_) * captureChannels_ * CAPTURE_RING_MS / 1000);
+    activeCaptureRing_.store(captureRing_.get(), std::memory_order_release);
+    
+    std::cout << "[AudioManager] Audio capture initialized (" << captureSource_->Describe() << ", "
+              << captureRate_ << " Hz, " << captureChannels_ << " ch, " << capturePool_->ChunkCount() << " capture chunks, "
+              << capturePool_->StorageBytes() / 1024 << " KB " << SampleEncodingName(captureEncoding_) << ")" << std::endl;
+    return true;
+}
+
+bool AudioManager::LoadRecognizer(const std::string& modelDir) {
+    AsrConfig config;
+    config.modelDir = modelDir;
+    return LoadRecognizer(config);
+}
+
+bool AudioManager::LoadRecognizer(const AsrConfig& config) {
+    std::cout << "[AudioManager] Initializing ASR..." << std::endl;
+    std::cout << "[AudioManager]   Model dir: " << config.modelDir << std::endl;
     
-    if (ma_device_init(NULL, &deviceConfig, audio_device_) != MA_SUCCESS) {
-        std::cerr << "[AudioManager] Audio device init failed" << std::endl;
-        delete audio_device_;
-        audio_device_ = nullptr;
+    AsrConfig asrConfig = config;
+    asrConfig.sampleRate = SAMPLE_RATE;
+    auto asr = std::make_unique<AsrEngine>();
+    if (!asr->Init(asrConfig)) {
+        std::cerr << "[AudioManager] ASR model load failed" << std::endl;
         return false;
     }
+    asr_ = std::move(asr);
     
-    std::cout << "[AudioManager] Audio device initialized" << std::endl;
+    std::cout << "[AudioManager] ASR loaded successfully (" << asr_->GetConfig().name << ")" << std::endl;
+    if (recognizerWarmup_) {
+        WarmUpRecognizer();
+    }
+    PrepareStreams();
     return true;
 }
 
+void AudioManager::WarmUpRecognizer() {
+    // Quiet noise rather than silence, so the encoder sees a full-length input
+    std::vector<float> noise(SAMPLE_RATE * ASR_WARMUP_MS / 1000);
+    std::mt19937 rng(1);
+    std::normal_distribution<float> dist(0.0f, 0.01f);
+    for (float& x : noise) {
+        x = dist(rng);
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::string> texts;
+    if (!asr_->Transcribe({{noise.data(), noise.size()}}, texts)) {
+        return;
+    }
+    warmupMs_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "[AudioManager] ASR warm-up: " << warmupMs_ << " ms for " << ASR_WARMUP_MS << " ms of audio" << std::endl;
+}
+
+void AudioManager::PrepareStreams() {
+    if (asr_) {
+        asr_->PrepareStreams(segmentedDecoding_ ? pauseSplitter_.Config().maxSegments : 1);
+    }
+}
+
+void AudioManager::PrintAsrStats() const {
+    if (asrCalls_ == 0) {
+        return;
+    }
+    std::cout << "[AudioManager] ASR: first transcription " << firstAsrMs_ << " ms (RTF " << firstAsrRtf_ << ")";
+    if (asrCalls_ > 1) {
+        std::cout << ", later avg " << laterAsrMsTotal_ / (asrCalls_ - 1) << " ms (RTF "
+                  << laterAsrRtfTotal_ / (asrCalls_ - 1) << ") over " << asrCalls_ - 1;
+    }
+    std::cout << (recognizerWarmup_ ? ", warm-up " + std::to_string(static_cast<int>(warmupMs_)) + " ms" : ", no warm-up")
+              << std::endl;
+}
+
+std::string AudioManager::TranscribeSamples(const float* samples, size_t count) {
+    AudioChunkPool pool((count + AudioChunkPool::kChunkSamples - 1) / AudioChunkPool::kChunkSamples, captureEncoding_);
+    PooledAudio audio(&pool);
+    audio.Append(samples, count);
+    PrepareStreams();  // As a recording would have
+    return TranscribeAudio(std::move(audio));
+}
+
 void AudioManager::Start(ThreadSafeQueue<AppEvent>* outputQueue) {
     if (running_) {
         std::cout << "[AudioManager] Already running" << std::endl;
@@ -595,6 +1320,9 @@ void AudioManager::Start(ThreadSafeQueue<AppEvent>* outputQueue) {
     running_ = true;
     
     thread_ = std::thread(&AudioManager::ThreadLoop, this);
+    if (tts_) {
+        ttsThread_ = std::thread(&AudioManager::SynthesisLoop, this);
+    }
     std::cout << "[AudioManager] Started" << std::endl;
 }
 
@@ -604,10 +1332,18 @@ void AudioManager::Stop() {
     running_ = false;
     recording_ = false;
     g_recording_global = false;
+    speechQueue_.shutdown();
+    audioEvent_.Signal();
     
     if (thread_.joinable()) {
         thread_.join();
     }
+    if (ttsThread_.joinable()) {
+        ttsThread_.join();
+    }
+    if (mixer_) {
+        mixer_->PrintStats();
+    }
     
     std::cout << "[AudioManager] Stopped" << std::endl;
 }
@@ -615,10 +1351,13 @@ void AudioManager::Stop() {
 void AudioManager::ThreadLoop() {
     std::cout << "[AudioManager] Thread loop started" << std::endl;
     
+    // Capture runs for the whole session so recordings can start with the pre-roll
+    SetCaptureRunning(true);
+    
     while (running_) {
-        // Wait for recording trigger
         if (trigger_recording_) {
             trigger_recording_ = false;
+            monitoring_ = false;
             std::string text = RecordAndTranscribe();
             
             if (!text.empty()) {
@@ -627,116 +1366,799 @@ void AudioManager::ThreadLoop() {
             }
         }
         
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));  // Faster response
+        if (bargeInEnabled_) {
+            if (bargeInDetected_.exchange(false)) {
+                HandleBargeIn();
+            } else {
+                UpdateMonitoring();
+            }
+        }
+        
+        // Converts new capture into the pre-roll and the live detectors
+        ListenForWakeWord();
+        
+        // Sleep until a trigger, barge-in, change in speaking state or new capture
+        if (running_ && !trigger_recording_ && !bargeInDetected_) {
+            audioEvent_.Wait();
+        }
     }
     
+    SetCaptureRunning(false);
+    PrintCaptureStats();
+    PrintAsrStats();
+    if (frontend_) {
+        frontend_->PrintStats();
+    }
+    if (keywordSpotter_) {
+        keywordSpotter_->PrintStats();
+    }
     std::cout << "[AudioManager] Thread loop ended" << std::endl;
 }
 
+bool AudioManager::SetCaptureRunning(bool run) {
+    if (run == captureRunning_) {
+        return true;
+    }
+    if (run) {
+        if (!captureSource_->Start()) {
+            return false;
+        }
+    } else {
+        captureSource_->Stop();
+    }
+    captureRunning_ = run;
+    return true;
+}
+
+bool AudioManager::EnableWakeWord(const KwsConfig& config) {
+    if (!captureSource_) {
+        std::cout << "[AudioManager] Wake word needs the microphone" << std::endl;
+        return false;
+    }
+    
+    auto spotter = std::make_unique<KeywordSpotter>();
+    KwsConfig kwsConfig = config;
+    kwsConfig.sampleRate = SAMPLE_RATE;
+    if (!spotter->Init(kwsConfig)) {
+        return false;
+    }
+    keywordSpotter_ = std::move(spotter);
+    std::cout << "[AudioManager] Wake word enabled" << std::endl;
+    return true;
+}
+
+std::string AudioManager::ProcessCapture() {
+    if (!captureRing_) {
+        return "";
+    }
+    size_t read = 0;
+    while ((read = captureRing_->Read(nativeChunk_.data(), nativeChunk_.size())) > 0) {
+        // The newest sample arrived with the last callback, minus whatever is still queued
+        int64_t now = SteadyNowNs();
+        size_t queued = captureRing_->ReadAvailable();
+        int64_t endNs = lastCaptureNs_.load(std::memory_order_acquire)
+                        - static_cast<int64_t>(queued / captureChannels_ * 1e9 / captureRate_);
+        double deliveryMs = (now - endNs) / 1e6 + read / captureChannels_ * 1000.0 / captureRate_;
+        deliveryMsTotal_ += deliveryMs;
+        deliveryMsMax_ = std::max(deliveryMsMax_, deliveryMs);
+        ++deliveries_;
+        
+        // Downmix in place, then resample to SAMPLE_RATE
+        size_t frames = read / captureChannels_;
+        Dsp::Downmix(nativeChunk_.data(), frames, captureChannels_, nativeChunk_.data());
+        const float* chunk = nativeChunk_.data();
+        size_t count = frames;
+        if (captureRate_ != SAMPLE_RATE) {
+            count = captureResampler_.Process(nativeChunk_.data(), frames, convertedChunk_.data());
+            chunk = convertedChunk_.data();
+        }
+        if (count == 0) {
+            continue;
+        }
+        
+        StoreCapture(chunk, count);
+        frontend_->Accept(chunk, count, endNs);
+        UpdateVoiceActivity();
+        
+        // sherpa-onnx computes its own fbank from the waveform
+        if (keywordSpotter_ && !recording_) {
+            std::string keyword = keywordSpotter_->Accept(chunk, count);
+            if (!keyword.empty()) {
+                return keyword;
+            }
+        }
+    }
+    return "";
+}
+
+void AudioManager::PrintCaptureStats() const {
+    uint64_t callbacks = callbackCount_.load(std::memory_order_relaxed);
+    if (callbacks == 0) {
+        return;
+    }
+    std::cout << "[AudioManager] Capture " << captureRate_ << " Hz x" << captureChannels_
+              << (nativeCapture_ ? " (device native)" : " (converted by the device layer)")
+              << ": callback avg " << callbackNsTotal_.load(std::memory_order_relaxed) / 1e3 / callbacks
+              << " us, max " << callbackNsMax_.load(std::memory_order_relaxed) / 1e3 << " us over "
+              << callbacks << " callbacks, " << captureOverruns_.load(std::memory_order_relaxed) << " overruns" << std::endl;
+    if (deliveries_ > 0) {
+        std::cout << "[AudioManager] Capture -> audio thread: avg " << deliveryMsTotal_ / deliveries_
+                  << " ms, max " << deliveryMsMax_ << " ms (oldest sample of each batch)";
+        if (captureRate_ != SAMPLE_RATE) {
+            std::cout << ", resampler delay " << captureResampler_.Delay() * 1000.0 / SAMPLE_RATE << " ms";
+        }
+        std::cout << std::endl;
+    }
+}
+
+void AudioManager::UpdateVoiceActivity() {
+    while (const FeatureFrame* frame = vadReader_.Read()) {
+        float bandPower = 0.0f;
+        for (size_t m = vadFirstBand_; m < vadLastBand_; ++m) {
+            bandPower += std::exp(frame->mel[m]);
+        }
+        float levelDb = 10.0f * std::log10(bandPower + 1e-10f);
+        
+        // The floor follows drops at once and rises slowly, so it tracks
+        // the room noise rather than the speech on top of it
+        noiseFloorDb_ = levelDb < noiseFloorDb_ ? levelDb : noiseFloorDb_ + VAD_FLOOR_RISE_DB;
+        if (levelDb > std::max(noiseFloorDb_ + VAD_MARGIN_DB, VAD_MIN_SPEECH_DB)) {
+            lastVoiceNs_.store(frame->endNs, std::memory_order_relaxed);
+        }
+    }
+}
+
+void AudioManager::ListenForWakeWord() {
+    std::string keyword = ProcessCapture();
+    if (keyword.empty()) {
+        return;
+    }
+    
+    std::cout << "[AudioManager] Wake word: " << keyword << std::endl;
+    monitoring_ = false;
+    std::string text = RecordAndTranscribe(RecordMode::UntilPause);
+    if (!text.empty()) {
+        std::cout << "[AudioManager] Transcribed: " << text << std::endl;
+        outputQueue_->push(AppEvent(EventType::AUDIO_INPUT, text));
+    }
+}
+
+void AudioManager::EnableBargeIn(std::function<void()> onBargeIn) {
+    if (!captureSource_) {
+        std::cout << "[AudioManager] Barge-in needs the microphone" << std::endl;
+        return;
+    }
+    onBargeIn_ = std::move(onBargeIn);
+    bargeInEnabled_ = true;
+    std::cout << "[AudioManager] Barge-in enabled" << std::endl;
+}
+
+void AudioManager::NotifySpeakingChanged() {
+    // Only the barge-in monitor cares; otherwise don't wake the audio thread
+    if (bargeInEnabled_) {
+        audioEvent_.Signal();
+    }
+}
+
+bool AudioManager::IsSpeaking() const {
+    return replyActive_ || synthesizing_ || !speechQueue_.empty() ||
+           (playbackRing_ && playbackRing_->ReadAvailable() > 0);
+}
+
+void AudioManager::UpdateMonitoring() {
+    bool speaking = IsSpeaking();
+    if (speaking && !monitoring_ && !recording_) {
+        monitoring_ = captureRunning_;
+    } else if (!speaking && monitoring_) {
+        monitoring_ = false;
+    }
+}
+
+void AudioManager::HandleBargeIn() {
+    int64_t detectedNs = bargeInNs_;
+    monitoring_ = false;
+    
+    // Drop the rest of the interrupted turn: queued sentences, the sentence
+    // being synthesized and whatever the AI thread still streams
+    speechEpoch_++;
+    speechQueue_.clear();
+    if (replyActive_) {
+        discardReply_ = true;
+    }
+    awaitingFirstAudio_ = false;
+    turnStartNs_ = 0;
+    
+    if (onBargeIn_) {
+        onBargeIn_();
+    }
+    int64_t cancelledNs = SteadyNowNs();
+    
+    int64_t silencedNs = silencedNs_;
+    std::cout << "[AudioManager] Barge-in: speech onset -> detected "
+              << (detectedNs - voiceOnsetNs_) / 1e6 << " ms, detected -> output silenced ";
+    if (silencedNs != 0) {
+        std::cout << (silencedNs - detectedNs) / 1e6 << " ms";
+    } else {
+        std::cout << "n/a";
+    }
+    std::cout << ", detected -> turn cancelled " << (cancelledNs - detectedNs) / 1e6 << " ms" << std::endl;
+    
+    std::string text = RecordAndTranscribe(RecordMode::Continue);
+    if (!text.empty()) {
+        std::cout << "[AudioManager] Transcribed: " << text << std::endl;
+        outputQueue_->push(AppEvent(EventType::AUDIO_INPUT, text));
+    }
+}
+
 void AudioManager::TriggerRecording() {
     trigger_recording_ = true;
+    audioEvent_.Signal();
 }
 
 void AudioManager::StopRecording() {
     recording_ = false;
+    audioEvent_.Signal();
 }
 
-std::string AudioManager::RecordAndTranscribe() {
-    if (!audio_device_) {
+std::string AudioManager::RecordAndTranscribe(RecordMode mode) {
+    if (!captureSource_) {
         std::cerr << "[AudioManager] Audio device not initialized" << std::endl;
         return "";
     }
     
-    // Clear buffer
-    {
-        std::lock_guard<std::mutex> lock(g_audio_mutex_global);
-        g_audio_buffer_global.clear();
+    if (mode == RecordMode::Continue) {
+        // The capture callback already started this recording at the speech onset
+        std::cout << "[AudioManager] Recording interruption... (until pause)" << std::endl;
+        g_recording_global = true;
+        recording_ = true;
+    } else {
+        if (!SetCaptureRunning(true)) {
+            return "";
+        }
+        
+        if (mode == RecordMode::UntilPause) {
+            std::cout << "[AudioManager] Recording... (until pause)" << std::endl;
+        } else {
+            std::cout << "[AudioManager] Recording... (press SPACE again or wait " 
+                      << recording_seconds_ << "s)" << std::endl;
+        }
+        
+        // The device is already running: the next capture block starts the
+        // new recording with the pre-roll instead of waiting for a restart
+        {
+            std::lock_guard<std::mutex> lock(g_audio_mutex_global);
+            g_audio_buffer_global.Clear();
+            g_reference_buffer_global.Clear();
+            g_capture_session_global++;
+            g_recording_global = true;
+        }
+        recording_ = true;
     }
     
-    std::cout << "[AudioManager] Recording... (press SPACE again or wait " 
-              << recording_seconds_ << "s)" << std::endl;
-    
-    g_recording_global = true;
-    recording_ = true;
-    
-    if (ma_device_start(audio_device_) != MA_SUCCESS) {
-        std::cerr << "[AudioManager] Failed to start audio device" << std::endl;
-        return "";
+    // Streams for the transcription are made now, while the user speaks
+    PrepareStreams();
+    
+    // Record for N seconds or until manually stopped; echo cancellation and
+    // conditioning keep up with capture so little is left at the end
+    PooledAudio cleaned(capturePool_.get());
+    bool processing = echoCanceller_ || conditioner_;
+    recordingProcessed_ = 0;
+    conditionerSkip_ = 0;
+    if (conditioner_) {
+        conditioner_->Reset();
+        conditionerSkip_ = conditioner_->Latency();
     }
-    
-    // Record for N seconds or until manually stopped
-    auto start_time = std::chrono::steady_clock::now();
+    int64_t startNs = SteadyNowNs();
+    int64_t limitNs = startNs + recording_seconds_ * 1000000000LL;
     while (recording_ && running_) {
-        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-            std::chrono::steady_clock::now() - start_time).count();
-        if (elapsed >= recording_seconds_) {
+        ProcessCapture();
+        if (processing) {
+            ProcessRecording(cleaned, false);
+        }
+        int64_t now = SteadyNowNs();
+        if (now >= limitNs) {
             break;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));  // Faster check
+        
+        // Sleep until the earliest point the recording could end, or until the
+        // next batch of live audio is due; StopRecording and Stop wake the
+        // thread right away
+        int64_t deadlineNs = limitNs;
+        if (mode != RecordMode::Manual) {
+            // Stop at the first pause; after a wake word, wait a bit for speech to start
+            int64_t lastVoice = lastVoiceNs_;
+            bool heard = mode == RecordMode::Continue || lastVoice > startNs;
+            int64_t endpointNs = heard ? lastVoice + BARGE_IN_END_SILENCE_MS * 1000000LL
+                                       : startNs + WAKE_WORD_NO_SPEECH_MS * 1000000LL;
+            if (now >= endpointNs) {
+                break;
+            }
+            deadlineNs = std::min(deadlineNs, endpointNs);
+        }
+        deadlineNs = std::min<int64_t>(deadlineNs, now + CAPTURE_PROCESS_INTERVAL_MS * 1000000LL);
+        audioEvent_.WaitUntil(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(deadlineNs)));
     }
     
+    // Audio still queued was captured before the stop and belongs to the recording
+    ProcessCapture();
     g_recording_global = false;
     recording_ = false;
-    ma_device_stop(audio_device_);
+    // What was said during the recording is not a wake word
+    if (keywordSpotter_) {
+        keywordSpotter_->Reset();
+    }
     
     std::cout << "[AudioManager] Recording complete" << std::endl;
     
-    // Get audio data
-    std::vector<float> audioData;
-    {
+    // Hand the utterance on without copying it
+    PooledAudio audioData;
+    if (processing) {
+        ProcessRecording(cleaned, true);
+        audioData = std::move(cleaned);
+    } else {
         std::lock_guard<std::mutex> lock(g_audio_mutex_global);
-        audioData = g_audio_buffer_global;
+        audioData = std::move(g_audio_buffer_global);
     }
     
-    if (audioData.empty()) {
+    if (echoCanceller_) {
+        EchoCanceller::Stats stats = echoCanceller_->GetStats();
+        std::cout << "[AudioManager] Echo cancellation (" << echoCanceller_->BackendName() << "): "
+                  << stats.avgFrameUs << " us/frame avg, " << stats.maxFrameUs << " us max, ERLE "
+                  << stats.erleDb << " dB, " << stats.doubleTalkFrames << " double-talk frames" << std::endl;
+    }
+    if (conditioner_) {
+        AudioConditioner::Stats stats = conditioner_->GetStats();
+        std::cout << "[AudioManager] Conditioning: AGC gain " << stats.gainDb << " dB, noise suppression "
+                  << stats.avgSuppressionDb << " dB avg, " << stats.avgBlockUs << " us per "
+                  << stats.blockMs << " ms block (max " << stats.maxBlockUs << " us)" << std::endl;
+    }
+    
+    size_t exhausted = capturePool_->ExhaustedCount();
+    if (exhausted > reportedExhausted_) {
+        std::cout << "[AudioManager] Capture pool ran out; recording was cut short" << std::endl;
+        reportedExhausted_ = exhausted;
+    }
+    
+    if (audioData.Empty()) {
         std::cout << "[AudioManager] No audio data recorded" << std::endl;
         return "";
     }
     
-    float duration = (float)audioData.size() / SAMPLE_RATE;
+    float duration = (float)audioData.Size() / SAMPLE_RATE;
     std::cout << "[AudioManager] Audio duration: " << duration << "s" << std::endl;
     
-    return TranscribeAudio(audioData);
+    return TranscribeAudio(std::move(audioData));
 }
 
-std::string AudioManager::TranscribeAudio(const std::vector<float>& audioData) {
-    if (!recognizer_ || audioData.empty()) {
-        return "";
+void AudioManager::ProcessRecording(PooledAudio& cleaned, bool flush) {
+    size_t end = 0;
+    size_t referenceEnd = 0;
+    {
+        std::lock_guard<std::mutex> lock(g_audio_mutex_global);
+        end = g_audio_buffer_global.Size();
+        referenceEnd = g_reference_buffer_global.Size();
+    }
+    
+    // The conditioner's output starts with its delay line; dropping that
+    // keeps the cleaned audio aligned with the capture
+    auto append = [&](const float* data, size_t count) {
+        size_t skip = std::min(conditionerSkip_, count);
+        conditionerSkip_ -= skip;
+        cleaned.Append(data + skip, count - skip);
+    };
+    
+    // ProcessCapture only appends past the sizes read above, so frames
+    // below them are read from the chunks without holding the lock
+    size_t frameSize = echoCanceller_ ? echoCanceller_->FrameSize() : static_cast<size_t>(SAMPLE_RATE / 100);
+    micFrame_.resize(frameSize);
+    referenceFrame_.resize(frameSize);
+    cleanedFrame_.resize(frameSize);
+    while (recordingProcessed_ < end) {
+        size_t offset = recordingProcessed_;
+        size_t count = std::min(frameSize, end - offset);
+        if (count < frameSize && !flush) {
+            break;
+        }
+        g_audio_buffer_global.CopyTo(offset, count, micFrame_.data());
+        float* frame = micFrame_.data();
+        if (echoCanceller_) {
+            size_t referenceCount = offset < referenceEnd
+                ? g_reference_buffer_global.CopyTo(offset, std::min(count, referenceEnd - offset), referenceFrame_.data())
+                : 0;
+            std::fill(referenceFrame_.begin() + referenceCount, referenceFrame_.begin() + count, 0.0f);
+            echoCanceller_->Process(micFrame_.data(), referenceFrame_.data(), cleanedFrame_.data(), count);
+            frame = cleanedFrame_.data();
+        }
+        if (conditioner_) {
+            conditioner_->Process(frame, frame, count);
+        }
+        append(frame, count);
+        recordingProcessed_ += count;
     }
     
-    const SherpaOnnxOfflineStream* stream = SherpaOnnxCreateOfflineStream(recognizer_);
-    if (!stream) {
-        std::cerr << "[AudioManager] Failed to create stream" << std::endl;
+    if (flush && conditioner_) {
+        // Push the tail out of the delay line
+        std::fill(cleanedFrame_.begin(), cleanedFrame_.end(), 0.0f);
+        for (size_t pushed = 0; pushed < conditioner_->Latency(); pushed += frameSize) {
+            size_t count = std::min(frameSize, conditioner_->Latency() - pushed);
+            conditioner_->Process(cleanedFrame_.data(), micFrame_.data(), count);
+            append(micFrame_.data(), count);
+        }
+    }
+}
+
+std::string AudioManager::TranscribeAudio(PooledAudio audioData) {
+    if (!asr_ || audioData.Empty()) {
         return "";
     }
     
     std::cout << "[AudioManager] Transcribing..." << std::endl;
+    auto start = std::chrono::steady_clock::now();
+    
+    // A stream takes the whole waveform in one call, so the chunks
+    // are gathered into a buffer reserved once for the longest recording
+    asrInput_.resize(audioData.Size());
+    audioData.CopyTo(0, audioData.Size(), asrInput_.data());
+    audioData.Clear();  // Chunks go back to the pool before decoding
+    
+    // A long recording decoded as one stream runs serially on the backend's
+    // threads; cut at pauses, each part is its own stream on its own worker
+    std::vector<SpeechSegment> segments;
+    if (segmentedDecoding_) {
+        segments = pauseSplitter_.Split(asrInput_.data(), asrInput_.size());
+    } else {
+        segments.push_back({0, asrInput_.size()});
+    }
     
-    SherpaOnnxAcceptWaveformOffline(stream, SAMPLE_RATE, audioData.data(), audioData.size());
-    SherpaOnnxDecodeOfflineStream(recognizer_, stream);
-    
-    const SherpaOnnxOfflineRecognizerResult* result = SherpaOnnxGetOfflineStreamResult(stream);
+    std::vector<AsrInput> inputs;
+    for (const SpeechSegment& segment : segments) {
+        inputs.push_back({asrInput_.data() + segment.begin, segment.end - segment.begin});
+    }
+    std::vector<std::string> texts;
     std::string text;
-    if (result && result->text) {
-        text = result->text;
+    if (asr_->Transcribe(inputs, texts, asr_->ConcurrentWorkers(inputs.size()))) {
+        for (const std::string& part : texts) {
+            AppendTranscript(text, part.c_str());
+        }
     }
     
-    SherpaOnnxDestroyOfflineRecognizerResult(result);
-    SherpaOnnxDestroyOfflineStream(stream);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    double rtf = ms / 1000.0 / (static_cast<double>(asrInput_.size()) / SAMPLE_RATE);
+    if (asrCalls_++ == 0) {
+        firstAsrMs_ = ms;
+        firstAsrRtf_ = rtf;
+    } else {
+        laterAsrMsTotal_ += ms;
+        laterAsrRtfTotal_ += rtf;
+    }
+    if (segments.size() > 1) {
+        std::cout << "[AudioManager] Decoded " << asrInput_.size() / SAMPLE_RATE << " s as "
+                  << segments.size() << " segments in " << ms << " ms" << std::endl;
+    }
     
     return text;
 }
 
 void AudioManager::CleanupRecognizer() {
-    if (recognizer_) {
-        SherpaOnnxDestroyOfflineRecognizer(recognizer_);
-        recognizer_ = nullptr;
+    asr_.reset();
+}
+
+bool AudioManager::InitializeTTS(const TtsConfig& config) {
+    std::cout << "[AudioManager] Initializing TTS..." << std::endl;
+    
+    auto tts = std::make_unique<TtsEngine>();
+    if (!tts->Init(config)) {
+        std::cerr << "[AudioManager] TTS model load failed" << std::endl;
+        return false;
+    }
+    
+    if (!InitializePlayback(tts->GetSampleRate())) {
+        return false;
+    }
+    
+    tts_ = std::move(tts);
+    std::cout << "[AudioManager] TTS ready" << std::endl;
+    return true;
+}
+
+bool AudioManager::InitializePlayback(int sampleRate) {
+    if (playback_device_) {
+        if (sampleRate != playbackRate_) {
+            std::cerr << "[AudioManager] Playback already open at " << playbackRate_
+                      << " Hz, cannot switch to " << sampleRate << " Hz" << std::endl;
+            return false;
+        }
+        return true;
+    }
+    
+    // Play at the model rate so synthesized audio needs no resampling
+    playbackRate_ = sampleRate;
+    playbackRing_ = std::make_unique<SpscRing<float>>(static_cast<size_t>(sampleRate) * 4);
+    
+    playback_device_ = new ma_device();
+    ma_device_config deviceConfig = ma_device_config_init(ma_device_type_playback);
+    deviceConfig.playback.format = ma_format_f32;
+    deviceConfig.playback.channels = CHANNELS;
+    deviceConfig.sampleRate = sampleRate;
+    deviceConfig.dataCallback = PlaybackCallback;
+    deviceConfig.pUserData = this;
+    deviceConfig.performanceProfile = ma_performance_profile_low_latency;
+    deviceConfig.periodSizeInMilliseconds = 5;  // Sound effect trigger latency
+    
+    if (ma_device_init(NULL, &deviceConfig, playback_device_) != MA_SUCCESS) {
+        std::cerr << "[AudioManager] Playback device init failed" << std::endl;
+        delete playback_device_;
+        playback_device_ = nullptr;
+        return false;
+    }
+    
+    // Keep the device running (silence when idle) so speech starts without
+    // a device start-up delay
+    if (ma_device_start(playback_device_) != MA_SUCCESS) {
+        std::cerr << "[AudioManager] Failed to start playback device" << std::endl;
+        ma_device_uninit(playback_device_);
+        delete playback_device_;
+        playback_device_ = nullptr;
+        return false;
+    }
+    
+    std::cout << "[AudioManager] Playback device initialized (" << sampleRate << " Hz, period "
+              << playback_device_->playback.internalPeriodSizeInFrames << " frames x "
+              << playback_device_->playback.internalPeriods << ")" << std::endl;
+    return true;
+}
+
+bool AudioManager::InitializeSoundEffects(const std::string& soundDir) {
+    if (!InitializePlayback(playback_device_ ? playbackRate_ : 48000)) {
+        return false;
     }
+    
+    auto mixer = std::make_unique<SoundMixer>(playbackRate_);
+    mixer->LoadDirectory(soundDir);
+    
+    // Fully loaded before the callback can see it
+    mixer_ = std::move(mixer);
+    activeMixer_.store(mixer_.get(), std::memory_order_release);
+    return true;
+}
+
+bool AudioManager::EnableEchoCancellation(int tailMs) {
+    if (!playback_device_ || !captureSource_) {
+        std::cout << "[AudioManager] Echo cancellation needs both playback and capture devices" << std::endl;
+        return false;
+    }
+    
+    echoCanceller_ = std::make_unique<EchoCanceller>(SAMPLE_RATE, 10, tailMs);
+    referenceRing_ = std::make_unique<SpscRing<float>>(SAMPLE_RATE);
+    pairedReferenceRing_ = std::make_unique<SpscRing<float>>(SAMPLE_RATE * CAPTURE_RING_MS / 1000);
+    referenceResampler_.Configure(playbackRate_, SAMPLE_RATE);
+    activeReference_.store(referenceRing_.get(), std::memory_order_release);
+    
+    std::cout << "[AudioManager] Echo cancellation enabled (" << echoCanceller_->BackendName()
+              << ", " << tailMs << " ms tail)" << std::endl;
+    return true;
+}
+
+bool AudioManager::EnableConditioning(const ConditionerConfig& config) {
+    if (!captureSource_) {
+        std::cout << "[AudioManager] Conditioning needs the microphone" << std::endl;
+        return false;
+    }
+    
+    conditioner_ = std::make_unique<AudioConditioner>(SAMPLE_RATE, config);
+    std::cout << "[AudioManager] Input conditioning enabled (high-pass " << (config.highPass ? "on" : "off")
+              << ", noise suppression " << (config.noiseSuppression ? "on" : "off")
+              << ", AGC " << (config.autoGain ? "on" : "off") << ", " << Dsp::SimdName() << ")" << std::endl;
+    return true;
+}
+
+bool AudioManager::PlayEffect(const std::string& name, float gain) {
+    return mixer_ && mixer_->Trigger(name, gain);
+}
+
+void AudioManager::EnableSpeechCache(const std::string& diskDir, const std::string& phraseListPath,
+                                     size_t memoryBytes) {
+    ttsCache_ = std::make_unique<TtsCache>(memoryBytes, diskDir);
+    // Cache entries are per sentence, so split phrases the way Speak does
+    prewarmPhrases_.clear();
+    if (!phraseListPath.empty()) {
+        for (const auto& phrase : LoadPhraseList(phraseListPath)) {
+            for (auto& sentence : SentenceSplitter::Split(phrase)) {
+                prewarmPhrases_.push_back(std::move(sentence));
+            }
+        }
+    }
+    std::cout << "[AudioManager] Speech cache enabled (" << memoryBytes / (1024 * 1024) << " MB, disk: "
+              << (diskDir.empty() ? "off" : diskDir) << ", " << prewarmPhrases_.size()
+              << " phrases to prewarm)" << std::endl;
+}
+
+PcmClipPtr AudioManager::SynthesizeCached(const std::string& text, bool persist, double& synthMs) {
+    synthMs = 0.0;
+    std::string key;
+    if (ttsCache_) {
+        key = TtsCache::MakeKey(tts_->VoiceId(), tts_->GetConfig().speed, text);
+        if (PcmClipPtr clip = ttsCache_->Lookup(key)) {
+            return clip;
+        }
+    }
+    
+    auto synthStart = std::chrono::steady_clock::now();
+    std::vector<float> samples;
+    if (!tts_->Synthesize(text, samples)) {
+        return nullptr;
+    }
+    synthMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - synthStart).count();
+    
+    PcmClipPtr clip = PcmClip::FromSamples(std::move(samples), tts_->GetSampleRate());
+    if (ttsCache_) {
+        ttsCache_->Store(key, clip, persist);
+    }
+    return clip;
+}
+
+void AudioManager::MarkTurnStart() {
+    int64_t expected = 0;
+    turnStartNs_.compare_exchange_strong(expected, SteadyNowNs());
+    // A new turn lifts the barge-in mute
+    outputMuted_.store(false, std::memory_order_release);
 }
 
 void AudioManager::Speak(const std::string& text) {
-    std::cout << "[AudioManager] TTS: " << text << std::endl;
-    // TODO: Implement actual TTS
+    if (!tts_) {
+        std::cout << "[AudioManager] TTS: " << text << std::endl;
+        return;
+    }
+    
+    MarkTurnStart();
+    uint32_t epoch = speechEpoch_;
+    for (auto& sentence : SentenceSplitter::Split(text)) {
+        speechQueue_.push(SpeechItem{std::move(sentence), false, true, epoch});
+    }
+    speechQueue_.push(SpeechItem{"", true, false, epoch});
+    NotifySpeakingChanged();
+}
+
+void AudioManager::FeedSpeech(const std::string& piece) {
+    if (discardReply_) {
+        return;
+    }
+    if (!replyActive_.exchange(true)) {
+        NotifySpeakingChanged();
+    }
+    if (!tts_) {
+        return;
+    }
+    
+    MarkTurnStart();
+    std::vector<std::string> sentences;
+    splitter_.Feed(piece, sentences);
+    uint32_t epoch = speechEpoch_;
+    for (auto& sentence : sentences) {
+        speechQueue_.push(SpeechItem{std::move(sentence), false, false, epoch});
+    }
+}
+
+void AudioManager::FlushSpeech() {
+    replyActive_ = false;
+    NotifySpeakingChanged();
+    if (discardReply_.exchange(false)) {
+        splitter_.Flush();
+        return;
+    }
+    if (!tts_) {
+        return;
+    }
+    
+    std::string rest = splitter_.Flush();
+    uint32_t epoch = speechEpoch_;
+    if (!rest.empty()) {
+        speechQueue_.push(SpeechItem{std::move(rest), false, false, epoch});
+    }
+    speechQueue_.push(SpeechItem{"", true, false, epoch});
+}
+
+void AudioManager::SynthesisLoop() {
+    std::cout << "[AudioManager] Synthesis thread started" << std::endl;
+    
+    bool turnStarted = false;
+    int64_t firstSentenceNs = 0;
+    double firstSynthMs = 0.0;
+    size_t prewarmed = 0;
+    
+    while (running_) {
+        std::optional<SpeechItem> itemOpt;
+        if (prewarmed < prewarmPhrases_.size()) {
+            // Prewarm only while nothing is waiting to be spoken
+            itemOpt = speechQueue_.tryPop();
+            if (!itemOpt.has_value()) {
+                double synthMs = 0.0;
+                SynthesizeCached(prewarmPhrases_[prewarmed++], true, synthMs);
+                if (prewarmed == prewarmPhrases_.size()) {
+                    std::cout << "[AudioManager] Speech cache prewarmed (" << prewarmed << " phrases)" << std::endl;
+                }
+                continue;
+            }
+        } else {
+            itemOpt = speechQueue_.pop();
+            if (!itemOpt.has_value()) {
+                break;
+            }
+        }
+        SpeechItem& item = itemOpt.value();
+        
+        if (item.epoch != speechEpoch_) {
+            // Interrupted by barge-in
+            turnStarted = false;
+            continue;
+        }
+        
+        if (item.endOfTurn) {
+            // Give the callback a moment to pick up the first samples
+            for (int i = 0; i < 200 && turnStarted && awaitingFirstAudio_ && running_; ++i) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+            int64_t turnStart = turnStartNs_.exchange(0);
+            if (turnStarted && turnStart != 0 && !awaitingFirstAudio_) {
+                std::cout << "[AudioManager] Time-to-first-audio: "
+                          << (firstAudioNs_ - turnStart) / 1e6 << " ms (first sentence after "
+                          << (firstSentenceNs - turnStart) / 1e6 << " ms, synthesized in "
+                          << firstSynthMs << " ms)" << std::endl;
+            }
+            turnStarted = false;
+            NotifySpeakingChanged();
+            continue;
+        }
+        
+        if (!turnStarted) {
+            firstSentenceNs = SteadyNowNs();
+        }
+        
+        double synthMs = 0.0;
+        synthesizing_ = true;
+        PcmClipPtr clip = SynthesizeCached(item.text, item.persist, synthMs);
+        if (!clip || clip->SampleRate() != playbackRate_ || item.epoch != speechEpoch_) {
+            synthesizing_ = false;
+            NotifySpeakingChanged();
+            continue;
+        }
+        double audioMs = clip->Size() * 1000.0 / playbackRate_;
+        if (synthMs > 0.0) {
+            std::cout << "[AudioManager] TTS: " << item.text << " (" << synthMs << " ms for "
+                      << audioMs << " ms of audio)" << std::endl;
+        } else {
+            std::cout << "[AudioManager] TTS (cached): " << item.text << std::endl;
+        }
+        
+        if (!turnStarted) {
+            turnStarted = true;
+            firstSynthMs = synthMs;
+            firstAudioNs_ = 0;
+            awaitingFirstAudio_.store(true, std::memory_order_release);
+        }
+        
+        // The ring holds a few seconds; wait for playback to make room.
+        // Written in small chunks so a barge-in stops the sentence mid-way.
+        const size_t chunk = 1024;
+        const float* samples = clip->Data();
+        size_t offset = 0;
+        while (offset < clip->Size() && running_ && item.epoch == speechEpoch_) {
+            offset += playbackRing_->Write(samples + offset, std::min(chunk, clip->Size() - offset));
+            if (offset < clip->Size() && playbackRing_->WriteAvailable() == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+        synthesizing_ = false;
+        NotifySpeakingChanged();
+    }
+    
+    if (ttsCache_) {
+        TtsCache::Stats stats = ttsCache_->GetStats();
+        std::cout << "[AudioManager] Speech cache: " << stats.memoryHits << " memory hits, "
+                  << stats.diskHits << " disk hits, " << stats.misses << " misses, "
+                  << stats.entries << " entries (" << stats.memoryBytes / 1024 << " KB)" << std::endl;
+    }
+    std::cout << "[AudioManager] Synthesis thread ended" << std::endl;
 }
 
 } // namespace DesktopPet
@@ -0,0 +1,67 @@
+#include "../include/PauseSplitter.h"
+#include "../include/AudioDsp.h"
+#include <algorithm>
+#include <cmath>
+
+namespace DesktopPet {
+
+namespace {
+
+constexpr int kFrameMs = 10;
+constexpr float kFloorPercentile = 0.1f;
+constexpr float kMinSpeechDb = -55.0f;  // Never treat quieter frames as speech
+
+} // namespace
+
+PauseSplitter::PauseSplitter(int sampleRate, const SplitConfig& config)
+    : sampleRate_(sampleRate), config_(config) {}
+
+std::vector<SpeechSegment> PauseSplitter::Split(const float* samples, size_t count) const {
+    std::vector<SpeechSegment> segments;
+    if (count < static_cast<size_t>(config_.minRecordingSeconds * sampleRate_) || config_.maxSegments < 2) {
+        segments.push_back({0, count});
+        return segments;
+    }
+
+    size_t frameLength = static_cast<size_t>(sampleRate_) * kFrameMs / 1000;
+    size_t frames = count / frameLength;
+    std::vector<float> levels(frames);
+    for (size_t f = 0; f < frames; ++f) {
+        const float* frame = samples + f * frameLength;
+        levels[f] = 10.0f * std::log10(Dsp::Dot(frame, frame, frameLength) / frameLength + 1e-10f);
+    }
+
+    std::vector<float> sorted(levels);
+    std::nth_element(sorted.begin(), sorted.begin() + static_cast<size_t>(frames * kFloorPercentile), sorted.end());
+    float floorDb = sorted[static_cast<size_t>(frames * kFloorPercentile)];
+    float speechDb = std::max(floorDb + config_.marginDb, kMinSpeechDb);
+
+    // Aim for equal parts, but only cut inside a pause
+    size_t minSegment = static_cast<size_t>(config_.minSegmentSeconds * sampleRate_);
+    size_t target = std::max(minSegment, count / config_.maxSegments);
+    size_t minPauseFrames = static_cast<size_t>(config_.minPauseMs / kFrameMs);
+    size_t start = 0;
+    size_t pauseStart = 0;
+    size_t pauseFrames = 0;
+    for (size_t f = 0; f < frames && segments.size() + 1 < config_.maxSegments; ++f) {
+        if (levels[f] < speechDb) {
+            if (pauseFrames++ == 0) {
+                pauseStart = f;
+            }
+            continue;
+        }
+        // Speech resumes: cut in the middle of the pause that just ended
+        if (pauseFrames >= minPauseFrames) {
+            size_t cut = (pauseStart + pauseFrames / 2) * frameLength;
+            if (cut - start >= target && count - cut >= minSegment) {
+                segments.push_back({start, cut});
+                start = cut;
+            }
+        }
+        pauseFrames = 0;
+    }
+    segments.push_back({start, count});
+    return segments;
+}
+
+} // namespace DesktopPet
@@ -0,0 +1,289 @@
+#include "../include/ScriptWatcher.h"
+#include <lua.hpp>
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace DesktopPet {
+
+namespace {
+
+// Editors write a file in several steps; wait this long for the burst to end
+constexpr int kCoalesceMs = 100;
+
+int BytecodeWriter(lua_State* L, const void* data, size_t size, void* ud) {
+    (void)L;
+    static_cast<std::string*>(ud)->append(static_cast<const char*>(data), size);
+    return 0;
+}
+
+std::string DirectoryOf(const std::string& path) {
+    fs::path parent = fs::path(path).parent_path();
+    return parent.empty() ? std::string(".") : parent.string();
+}
+
+std::string FileNameOf(const std::string& path) {
+    return fs::path(path).filename().string();
+}
+
+#ifndef __linux__
+fs::file_time_type LastWriteTime(const std::string& path) {
+    std::error_code ec;
+    auto time = fs::last_write_time(path, ec);
+    return ec ? fs::file_time_type::min() : time;
+}
+#endif
+
+} // namespace
+
+ScriptWatcher::~ScriptWatcher() {
+    Stop();
+}
+
+CompiledScript ScriptWatcher::Compile(const std::string& path) {
+    CompiledScript result;
+    result.path = path;
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        result.error = "cannot open " + path;
+        return result;
+    }
+    std::string source((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    // Scratch state: only parses and dumps, never runs the chunk
+    lua_State* L = luaL_newstate();
+    if (!L) {
+        result.error = "cannot create Lua state";
+        return result;
+    }
+
+    std::string chunkname = "@" + path;
+    if (luaL_loadbufferx(L, source.data(), source.size(), chunkname.c_str(), "t") != LUA_OK) {
+        const char* message = lua_tostring(L, -1);
+        result.error = message ? message : "unknown syntax error";
+    } else {
+        lua_dump(L, BytecodeWriter, &result.bytecode, 0);
+    }
+
+    lua_close(L);
+    return result;
+}
+
+bool ScriptWatcher::Start(const std::vector<std::string>& paths, Callback onCompiled) {
+    if (running_) {
+        return true;
+    }
+
+    paths_ = paths;
+    onCompiled_ = std::move(onCompiled);
+
+#ifndef __linux__
+    lastWrite_.clear();
+    for (const auto& path : paths_) {
+        lastWrite_.push_back(LastWriteTime(path));
+    }
+#endif
+
+    std::vector<std::string> directories;
+    for (const auto& path : paths_) {
+        std::string dir = DirectoryOf(path);
+        if (std::find(directories.begin(), directories.end(), dir) == directories.end()) {
+            directories.push_back(dir);
+        }
+    }
+
+#if defined(_WIN32)
+    stopEvent_ = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+    for (const auto& dir : directories) {
+        HANDLE handle = FindFirstChangeNotificationA(dir.c_str(), FALSE,
+            FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+        if (handle == INVALID_HANDLE_VALUE) {
+            std::cerr << "[ScriptWatcher] Cannot watch " << dir << std::endl;
+            continue;
+        }
+        changeHandles_.push_back(handle);
+    }
+    if (changeHandles_.empty()) {
+        CloseHandle(stopEvent_);
+        stopEvent_ = nullptr;
+        return false;
+    }
+#elif defined(__linux__)
+    notifyFd_ = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    wakeFd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (notifyFd_ < 0 || wakeFd_ < 0) {
+        std::cerr << "[ScriptWatcher] inotify unavailable" << std::endl;
+        Stop();
+        return false;
+    }
+    for (const auto& dir : directories) {
+        // Watch the directory: editors often save by renaming a temp file
+        int wd = inotify_add_watch(notifyFd_, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        if (wd < 0) {
+            std::cerr << "[ScriptWatcher] Cannot watch " << dir << std::endl;
+            continue;
+        }
+        watchedDirectories_[wd] = dir;
+    }
+    if (watchedDirectories_.empty()) {
+        Stop();
+        return false;
+    }
+#endif
+
+    running_ = true;
+    thread_ = std::thread(&ScriptWatcher::ThreadLoop, this);
+    std::cout << "[ScriptWatcher] Watching " << paths_.size() << " script(s)" << std::endl;
+    return true;
+}
+
+void ScriptWatcher::Stop() {
+    bool wasRunning = running_.exchange(false);
+
+#if defined(_WIN32)
+    if (stopEvent_) {
+        SetEvent(stopEvent_);
+    }
+#elif defined(__linux__)
+    if (wakeFd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t written = write(wakeFd_, &one, sizeof(one));
+        (void)written;
+    }
+#endif
+
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+#if defined(_WIN32)
+    for (void* handle : changeHandles_) {
+        FindCloseChangeNotification(handle);
+    }
+    changeHandles_.clear();
+    if (stopEvent_) {
+        CloseHandle(stopEvent_);
+        stopEvent_ = nullptr;
+    }
+#elif defined(__linux__)
+    watchedDirectories_.clear();
+    if (notifyFd_ >= 0) {
+        close(notifyFd_);
+        notifyFd_ = -1;
+    }
+    if (wakeFd_ >= 0) {
+        close(wakeFd_);
+        wakeFd_ = -1;
+    }
+#endif
+
+    if (wasRunning) {
+        std::cout << "[ScriptWatcher] Stopped" << std::endl;
+    }
+}
+
+void ScriptWatcher::ThreadLoop() {
+    while (running_) {
+        std::vector<std::string> changed = WaitForChanges();
+        for (const auto& path : changed) {
+            if (!running_) {
+                break;
+            }
+            std::cout << "[ScriptWatcher] Recompiling " << path << std::endl;
+            onCompiled_(Compile(path));
+        }
+    }
+}
+
+#if defined(__linux__)
+
+std::vector<std::string> ScriptWatcher::WaitForChanges() {
+    std::vector<std::string> changed;
+    int timeout = -1;  // Sleep until the first event, then coalesce
+
+    while (running_) {
+        pollfd fds[2] = {{notifyFd_, POLLIN, 0}, {wakeFd_, POLLIN, 0}};
+        int ready = poll(fds, 2, timeout);
+        if (ready < 0 || fds[1].revents) {
+            return {};
+        }
+        if (ready == 0) {
+            break;  // Burst is over
+        }
+
+        alignas(inotify_event) char buffer[4096];
+        ssize_t length;
+        while ((length = read(notifyFd_, buffer, sizeof(buffer))) > 0) {
+            for (char* p = buffer; p < buffer + length; ) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+                p += sizeof(inotify_event) + event->len;
+                auto watched = watchedDirectories_.find(event->wd);
+                if (event->len == 0 || watched == watchedDirectories_.end()) {
+                    continue;
+                }
+                // Same file name in another watched directory is a different script
+                for (const auto& path : paths_) {
+                    if (DirectoryOf(path) == watched->second && FileNameOf(path) == event->name &&
+                        std::find(changed.begin(), changed.end(), path) == changed.end()) {
+                        changed.push_back(path);
+                    }
+                }
+            }
+        }
+
+        if (!changed.empty()) {
+            timeout = kCoalesceMs;
+        }
+    }
+    return changed;
+}
+
+#else
+
+std::vector<std::string> ScriptWatcher::WaitForChanges() {
+#if defined(_WIN32)
+    std::vector<HANDLE> handles(changeHandles_.begin(), changeHandles_.end());
+    handles.push_back(stopEvent_);
+    DWORD result = WaitForMultipleObjects(static_cast<DWORD>(handles.size()), handles.data(), FALSE, INFINITE);
+    if (!running_ || result == WAIT_OBJECT_0 + handles.size() - 1 || result == WAIT_FAILED) {
+        return {};
+    }
+    FindNextChangeNotification(handles[result - WAIT_OBJECT_0]);
+
+    // Directory notifications carry no file name: compare timestamps after
+    // the write burst settles
+    std::this_thread::sleep_for(std::chrono::milliseconds(kCoalesceMs));
+#else
+    // No native notification API: poll timestamps
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+#endif
+
+    std::vector<std::string> changed;
+    for (size_t i = 0; i < paths_.size(); ++i) {
+        auto time = LastWriteTime(paths_[i]);
+        if (time != lastWrite_[i]) {
+            lastWrite_[i] = time;
+            changed.push_back(paths_[i]);
+        }
+    }
+    return changed;
+}
+
+#endif
+
+} // namespace DesktopPet
@@ -0,0 +1,163 @@
+#include "../include/SoundMixer.h"
+#include "../include/AudioDsp.h"
+#include "miniaudio/miniaudio.h"
+#include <iostream>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+
+namespace fs = std::filesystem;
+
+namespace DesktopPet {
+
+namespace {
+
+int64_t SteadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+bool SoundMixer::Load(const std::string& name, const std::string& path) {
+    // Decode and convert to mono float at the device rate once, up front
+    ma_decoder_config config = ma_decoder_config_init(ma_format_f32, 1, static_cast<ma_uint32>(sampleRate_));
+    ma_decoder decoder;
+    if (ma_decoder_init_file(path.c_str(), &config, &decoder) != MA_SUCCESS) {
+        std::cerr << "[SoundMixer] Cannot decode " << path << std::endl;
+        return false;
+    }
+
+    std::vector<float> samples;
+    float chunk[4096];
+    ma_uint64 framesRead = 0;
+    while (ma_decoder_read_pcm_frames(&decoder, chunk, 4096, &framesRead) == MA_SUCCESS && framesRead > 0) {
+        samples.insert(samples.end(), chunk, chunk + framesRead);
+    }
+    ma_decoder_uninit(&decoder);
+
+    if (samples.empty()) {
+        std::cerr << "[SoundMixer] Empty sound " << path << std::endl;
+        return false;
+    }
+
+    auto it = names_.find(name);
+    if (it != names_.end()) {
+        sounds_[it->second] = PcmClip::FromSamples(std::move(samples), sampleRate_);
+    } else {
+        names_[name] = static_cast<uint32_t>(sounds_.size());
+        sounds_.push_back(PcmClip::FromSamples(std::move(samples), sampleRate_));
+    }
+    return true;
+}
+
+size_t SoundMixer::LoadDirectory(const std::string& dir) {
+    std::error_code ec;
+    if (!fs::is_directory(dir, ec)) {
+        std::cout << "[SoundMixer] No sound directory " << dir << std::endl;
+        return 0;
+    }
+
+    size_t loaded = 0;
+    size_t bytes = 0;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        std::string ext = entry.path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (ext != ".wav" && ext != ".mp3" && ext != ".flac") {
+            continue;
+        }
+        std::string name = entry.path().stem().string();
+        if (Load(name, entry.path().string())) {
+            bytes += sounds_[names_[name]]->Size() * sizeof(float);
+            ++loaded;
+        }
+    }
+
+    std::cout << "[SoundMixer] Loaded " << loaded << " sounds (" << bytes / 1024 << " KB, "
+              << Dsp::SimdName() << " mixing)" << std::endl;
+    return loaded;
+}
+
+bool SoundMixer::Trigger(const std::string& name, float gain) {
+    auto it = names_.find(name);
+    if (it == names_.end()) {
+        return false;
+    }
+
+    Command command{it->second, gain, SteadyNowNs()};
+    if (commands_.Write(&command, 1) != 1) {
+        ++dropped_;
+        return false;
+    }
+    return true;
+}
+
+void SoundMixer::StartVoice(const Command& command) {
+    const PcmClipPtr& sound = sounds_[command.sound];
+
+    // Free voice, or steal the one that has been playing longest
+    Voice* target = nullptr;
+    for (auto& voice : voices_) {
+        if (!voice.active) {
+            target = &voice;
+            break;
+        }
+    }
+    if (!target) {
+        target = &*std::max_element(voices_.begin(), voices_.end(),
+            [](const Voice& a, const Voice& b) { return a.position < b.position; });
+        stolen_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    target->data = sound->Data();
+    target->size = sound->Size();
+    target->position = 0;
+    target->gain = command.gain;
+    target->active = true;
+
+    int64_t latency = SteadyNowNs() - command.triggerNs;
+    started_.fetch_add(1, std::memory_order_relaxed);
+    latencySumNs_.fetch_add(latency, std::memory_order_relaxed);
+    if (latency > latencyMaxNs_.load(std::memory_order_relaxed)) {
+        latencyMaxNs_.store(latency, std::memory_order_relaxed);
+    }
+}
+
+void SoundMixer::Mix(float* out, size_t frames) {
+    Command command;
+    while (commands_.Read(&command, 1) == 1) {
+        StartVoice(command);
+    }
+
+    bool mixed = false;
+    for (auto& voice : voices_) {
+        if (!voice.active) {
+            continue;
+        }
+        size_t count = std::min(frames, voice.size - voice.position);
+        Dsp::MixAdd(out, voice.data + voice.position, count, voice.gain);
+        voice.position += count;
+        if (voice.position >= voice.size) {
+            voice.active = false;
+        }
+        mixed = true;
+    }
+
+    if (mixed) {
+        Dsp::Clamp(out, frames);
+    }
+}
+
+void SoundMixer::PrintStats() const {
+    uint64_t started = started_.load();
+    if (started == 0) {
+        return;
+    }
+    std::cout << "[SoundMixer] " << started << " sounds played, " << stolen_.load() << " voices stolen, "
+              << dropped_ << " dropped; trigger->mix latency avg "
+              << latencySumNs_.load() / 1e6 / started << " ms, max "
+              << latencyMaxNs_.load() / 1e6 << " ms" << std::endl;
+}
+
+} // namespace DesktopPet
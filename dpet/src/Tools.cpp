@@ -0,0 +1,917 @@
+#include "../include/Tools.h"
+#include "../include/Managers.h"
+#include "../include/EchoCanceller.h"
+#include "../include/KeywordSpotter.h"
+#include "../include/FeatureFrontend.h"
+#include "../include/AudioConditioner.h"
+#include "../include/PauseSplitter.h"
+#include "../include/AudioSource.h"
+#include "../include/AsrBackend.h"
+#include "../include/WavCorpus.h"
+#include "miniaudio/miniaudio.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <cmath>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <unistd.h>
+#endif
+
+namespace DesktopPet {
+namespace Tools {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct ToolCommand {
+    const char* name;
+    const char* usage;
+    std::function<int(const std::vector<std::string>&)> run;
+};
+
+std::string ArgOr(const std::vector<std::string>& args, size_t index, const std::string& fallback) {
+    return index < args.size() ? args[index] : fallback;
+}
+
+// ----------------------------------------------------------------------------
+// bench-lua: run init.lua callbacks at 60 Hz and report frame cost + heap churn
+// ----------------------------------------------------------------------------
+int RunLuaBenchmark(const std::vector<std::string>& args) {
+    std::string scriptPath = ArgOr(args, 0, "scripts/init.lua");
+    int seconds = std::stoi(ArgOr(args, 1, "10"));
+    size_t limitKB = std::stoul(ArgOr(args, 2, "0"));
+    std::string profilePath = ArgOr(args, 3, "");
+
+    ThreadSafeQueue<AppEvent> eventQueue;
+    ScriptRunner runner;
+    runner.SetMemoryLimit(limitKB * 1024);
+    if (!runner.Init(&eventQueue) || !runner.LoadFile(scriptPath)) {
+        return 1;
+    }
+    runner.CallFunction("onInit");
+
+    const int totalFrames = seconds * 60;
+    const auto framePeriod = std::chrono::microseconds(16667);
+    std::vector<double> frameUs;
+    frameUs.reserve(totalFrames);
+
+    runner.ResetAllocCounters();
+    if (!profilePath.empty()) {
+        runner.SetProfiling(true);
+    }
+    std::cout << "[Tools] bench-lua: " << scriptPath << ", " << totalFrames << " frames @ 60 Hz" << std::endl;
+
+    auto nextFrame = Clock::now();
+    for (int frame = 0; frame < totalFrames; ++frame) {
+        auto start = Clock::now();
+
+        runner.CallFunction("onUpdate");
+        if (frame % 30 == 0) {
+            runner.CallFunction("onClick", 250, 250);
+        }
+        if (frame % 120 == 0) {
+            runner.CallFunction("onKeyPress", std::string("T"));
+        }
+
+        frameUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+
+        // Drain events like the main loop would
+        while (eventQueue.tryPop().has_value()) {
+        }
+
+        nextFrame += framePeriod;
+        std::this_thread::sleep_until(nextFrame);
+    }
+
+    if (!profilePath.empty()) {
+        runner.SetProfiling(false);
+        runner.GetProfiler().DumpFolded(profilePath);
+    }
+
+    const LuaAllocStats& stats = runner.GetAllocStats();
+    double total = 0.0;
+    for (double us : frameUs) {
+        total += us;
+    }
+
+    std::cout << "[Tools] Lua time per frame (us): avg=" << total / frameUs.size()
+              << " p50=" << Percentile(frameUs, 0.50)
+              << " p99=" << Percentile(frameUs, 0.99)
+              << " max=" << Percentile(frameUs, 1.0) << std::endl;
+    std::cout << "[Tools] Allocations: " << stats.allocCount
+              << " (" << static_cast<double>(stats.allocCount) / totalFrames << "/frame), frees: " << stats.freeCount
+              << ", reallocs: " << stats.reallocCount << std::endl;
+    std::cout << "[Tools] Pool hits: " << stats.poolHits
+              << ", large (malloc): " << stats.largeAllocs
+              << ", slab refills: " << stats.slabRefills
+              << ", refused by limit: " << stats.failedAllocs << std::endl;
+    std::cout << "[Tools] Heap: in use " << stats.bytesInUse / 1024.0 << " KB, peak "
+              << stats.peakBytes / 1024.0 << " KB, slabs reserved "
+              << stats.reservedBytes / 1024.0 << " KB" << std::endl;
+    return 0;
+}
+
+bool LoadMono(const std::string& path, int sampleRate, std::vector<float>& samples) {
+    if (!LoadWavMono(path, sampleRate, samples)) {
+        std::cerr << "[Tools] Cannot decode " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Resident memory of this process (working set on Windows), 0 if unknown
+ */
+size_t ResidentBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.WorkingSetSize;
+    }
+    return 0;
+#else
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0;
+    size_t resident = 0;
+    if (statm >> pages >> resident) {
+        return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+    return 0;
+#endif
+}
+
+bool SaveMonoWav(const std::string& path, int sampleRate, const std::vector<float>& samples) {
+    ma_encoder_config config = ma_encoder_config_init(ma_encoding_format_wav, ma_format_f32, 1,
+                                                      static_cast<ma_uint32>(sampleRate));
+    ma_encoder encoder;
+    if (ma_encoder_init_file(path.c_str(), &config, &encoder) != MA_SUCCESS) {
+        std::cerr << "[Tools] Cannot write " << path << std::endl;
+        return false;
+    }
+    ma_encoder_write_pcm_frames(&encoder, samples.data(), samples.size(), nullptr);
+    ma_encoder_uninit(&encoder);
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// aec-test: cancel echo offline from a recorded microphone + playback reference pair
+// ----------------------------------------------------------------------------
+int RunEchoTest(const std::vector<std::string>& args) {
+    std::string micPath = args.at(0);
+    std::string referencePath = args.at(1);
+    std::string outPath = ArgOr(args, 2, "");
+    int tailMs = std::stoi(ArgOr(args, 3, "128"));
+
+    std::vector<float> mic;
+    std::vector<float> reference;
+    if (!LoadMono(micPath, SAMPLE_RATE, mic) || !LoadMono(referencePath, SAMPLE_RATE, reference)) {
+        return 1;
+    }
+    reference.resize(mic.size(), 0.0f);
+
+    // Feed 10 ms blocks, as the audio thread does
+    EchoCanceller canceller(SAMPLE_RATE, 10, tailMs);
+    std::vector<float> cleaned(mic.size());
+    size_t block = canceller.FrameSize();
+    auto start = Clock::now();
+    for (size_t offset = 0; offset < mic.size(); offset += block) {
+        size_t count = std::min(block, mic.size() - offset);
+        canceller.Process(mic.data() + offset, reference.data() + offset, cleaned.data() + offset, count);
+    }
+    double elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    double audioMs = mic.size() * 1000.0 / SAMPLE_RATE;
+    EchoCanceller::Stats stats = canceller.GetStats();
+    std::cout << "[Tools] aec-test: " << canceller.BackendName() << ", " << tailMs << " ms tail, "
+              << audioMs / 1000.0 << " s of audio" << std::endl;
+    std::cout << "[Tools] ERLE: " << stats.erleDb << " dB over echo-only frames, "
+              << stats.doubleTalkFrames << "/" << stats.frames << " frames double talk" << std::endl;
+    std::cout << "[Tools] Cost per 10 ms block: avg " << stats.avgFrameUs << " us, max " << stats.maxFrameUs
+              << " us (" << 100.0 * elapsedMs / audioMs << "% of one core)" << std::endl;
+
+    if (!outPath.empty() && !SaveMonoWav(outPath, SAMPLE_RATE, cleaned)) {
+        return 1;
+    }
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+// bench-kws: CPU share of the always-on path, keyword spotter plus the
+// shared feature front-end (file or silence)
+// ----------------------------------------------------------------------------
+int RunKeywordBenchmark(const std::vector<std::string>& args) {
+    KwsConfig config;
+    config.modelDir = args.at(0);
+    std::string wavPath = ArgOr(args, 1, "");
+    int seconds = std::stoi(ArgOr(args, 2, "60"));
+    config.sampleRate = SAMPLE_RATE;
+
+    std::vector<float> audio;
+    if (!wavPath.empty()) {
+        if (!LoadMono(wavPath, SAMPLE_RATE, audio)) {
+            return 1;
+        }
+    } else {
+        audio.assign(static_cast<size_t>(seconds) * SAMPLE_RATE, 0.0f);
+    }
+
+    KeywordSpotter spotter;
+    if (!spotter.Init(config)) {
+        return 1;
+    }
+
+    FeatureFrontend frontend(SAMPLE_RATE);
+
+    // 100 ms chunks, what the audio thread hands over per wakeup
+    const size_t chunk = SAMPLE_RATE / 10;
+    for (size_t offset = 0; offset < audio.size(); offset += chunk) {
+        size_t count = std::min(chunk, audio.size() - offset);
+        frontend.Accept(audio.data() + offset, count, 0);
+        std::string keyword = spotter.Accept(audio.data() + offset, count);
+        if (!keyword.empty()) {
+            std::cout << "[Tools] " << static_cast<double>(offset) / SAMPLE_RATE << " s: " << keyword << std::endl;
+        }
+    }
+    spotter.PrintStats();
+    frontend.PrintStats();
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+// condition: run the input conditioning chain over a file (WAV in, WAV out)
+// ----------------------------------------------------------------------------
+ConditionerConfig ParseStages(const std::string& stages) {
+    ConditionerConfig config;
+    if (stages != "all") {
+        config.highPass = stages.find("hp") != std::string::npos;
+        config.noiseSuppression = stages.find("ns") != std::string::npos;
+        config.autoGain = stages.find("agc") != std::string::npos;
+    }
+    return config;
+}
+
+double LevelDbfs(const std::vector<float>& samples) {
+    double sum = 0.0;
+    for (float s : samples) {
+        sum += static_cast<double>(s) * s;
+    }
+    return 10.0 * std::log10(sum / std::max<size_t>(samples.size(), 1) + 1e-12);
+}
+
+int RunConditionTest(const std::vector<std::string>& args) {
+    std::string inPath = args.at(0);
+    std::string outPath = ArgOr(args, 1, "");
+    ConditionerConfig config = ParseStages(ArgOr(args, 2, "all"));
+
+    std::vector<float> audio;
+    if (!LoadMono(inPath, SAMPLE_RATE, audio)) {
+        return 1;
+    }
+
+    // 10 ms blocks as on the audio thread, then drain the delay line and
+    // drop its head so the output lines up with the input
+    AudioConditioner conditioner(SAMPLE_RATE, config);
+    size_t latency = conditioner.Latency();
+    std::vector<float> padded(audio);
+    padded.resize(audio.size() + latency, 0.0f);
+    const size_t block = SAMPLE_RATE / 100;
+    for (size_t offset = 0; offset < padded.size(); offset += block) {
+        size_t count = std::min(block, padded.size() - offset);
+        conditioner.Process(padded.data() + offset, padded.data() + offset, count);
+    }
+    std::vector<float> conditioned(padded.begin() + latency, padded.end());
+
+    AudioConditioner::Stats stats = conditioner.GetStats();
+    std::cout << "[Tools] condition: " << audio.size() / static_cast<double>(SAMPLE_RATE) << " s, high-pass "
+              << (config.highPass ? "on" : "off") << ", noise suppression " << (config.noiseSuppression ? "on" : "off")
+              << ", AGC " << (config.autoGain ? "on" : "off") << " (" << Dsp::SimdName() << ")" << std::endl;
+    std::cout << "[Tools] Level: in " << LevelDbfs(audio) << " dBFS, out " << LevelDbfs(conditioned)
+              << " dBFS, final AGC gain " << stats.gainDb << " dB, mean suppression "
+              << stats.avgSuppressionDb << " dB" << std::endl;
+    std::cout << "[Tools] Cost per " << stats.blockMs << " ms block: avg " << stats.avgBlockUs << " us, max "
+              << stats.maxBlockUs << " us" << std::endl;
+
+    if (!outPath.empty() && !SaveMonoWav(outPath, SAMPLE_RATE, conditioned)) {
+        return 1;
+    }
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+// bench-condition: per-block cost of the conditioning chain against a CPU
+// budget, on synthetic noise with tone bursts (fails when over budget)
+// ----------------------------------------------------------------------------
+int RunConditionBenchmark(const std::vector<std::string>& args) {
+    int seconds = std::stoi(ArgOr(args, 0, "60"));
+    double budgetPercent = std::stod(ArgOr(args, 1, "2"));
+
+    std::vector<float> audio(static_cast<size_t>(seconds) * SAMPLE_RATE);
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> noise(0.0f, 0.003f);
+    const double pi = 3.14159265358979323846;
+    for (size_t i = 0; i < audio.size(); ++i) {
+        // One second of "speech" (two tones) every three seconds
+        double t = static_cast<double>(i) / SAMPLE_RATE;
+        double tone = 0.05 * std::sin(2 * pi * 220 * t) + 0.03 * std::sin(2 * pi * 1250 * t);
+        bool burst = (i / SAMPLE_RATE) % 3 == 0;
+        audio[i] = (burst ? static_cast<float>(tone) : 0.0f) + noise(rng);
+    }
+
+    AudioConditioner conditioner(SAMPLE_RATE);
+    std::vector<double> blockUs;
+    const size_t block = conditioner.BlockSize();
+    blockUs.reserve(audio.size() / block + 1);
+    for (size_t offset = 0; offset < audio.size(); offset += block) {
+        size_t count = std::min(block, audio.size() - offset);
+        auto start = Clock::now();
+        conditioner.Process(audio.data() + offset, audio.data() + offset, count);
+        blockUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+
+    AudioConditioner::Stats stats = conditioner.GetStats();
+    double blockBudgetUs = stats.blockMs * 1000.0 * budgetPercent / 100.0;
+    double p99 = Percentile(blockUs, 0.99);
+    std::cout << "[Tools] bench-condition: " << seconds << " s, " << stats.blocks << " blocks of "
+              << stats.blockMs << " ms (" << Dsp::SimdName() << ")" << std::endl;
+    std::cout << "[Tools] Per block: avg " << stats.avgBlockUs << " us, p99 " << p99 << " us, max "
+              << stats.maxBlockUs << " us; budget " << blockBudgetUs << " us (" << budgetPercent
+              << "% of one core)" << std::endl;
+    if (stats.avgBlockUs > blockBudgetUs) {
+        std::cerr << "[Tools] Conditioning is over its CPU budget" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+// bench-resample: capture conversion to 16 kHz mono, miniaudio's converter
+// (what runs inside the callback when the device is opened at 16 kHz) against
+// the downmix + polyphase resampler the audio thread uses for native capture
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Level of one frequency in dBFS (Goertzel)
+ */
+double ToneDbfs(const std::vector<float>& samples, double hz, int sampleRate) {
+    const double pi = 3.14159265358979323846;
+    double coeff = 2.0 * std::cos(2.0 * pi * hz / sampleRate);
+    double s1 = 0.0, s2 = 0.0;
+    for (float x : samples) {
+        double s0 = x + coeff * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+    double power = s1 * s1 + s2 * s2 - coeff * s1 * s2;
+    double amplitude = 2.0 * std::sqrt(std::max(power, 0.0)) / std::max<size_t>(samples.size(), 1);
+    return 20.0 * std::log10(amplitude / std::sqrt(2.0) + 1e-12);
+}
+
+int RunResampleBenchmark(const std::vector<std::string>& args) {
+    int inRate = std::stoi(ArgOr(args, 0, "48000"));
+    int channels = std::stoi(ArgOr(args, 1, "2"));
+    int seconds = std::stoi(ArgOr(args, 2, "30"));
+
+    // 1 kHz speech-band tone plus 10 kHz, which aliases to 6 kHz without a proper low-pass
+    const double pi = 3.14159265358979323846;
+    const double aliasHz = 10000.0;
+    const double foldedHz = SAMPLE_RATE - aliasHz;
+    size_t frames = static_cast<size_t>(seconds) * inRate;
+    std::vector<float> input(frames * channels);
+    for (size_t i = 0; i < frames; ++i) {
+        double t = static_cast<double>(i) / inRate;
+        float x = static_cast<float>(0.3 * std::sin(2 * pi * 1000 * t) + 0.3 * std::sin(2 * pi * aliasHz * t));
+        for (int c = 0; c < channels; ++c) {
+            input[i * channels + c] = x;
+        }
+    }
+
+    // 10 ms periods, as a device callback delivers them
+    const size_t period = static_cast<size_t>(inRate) / 100;
+    struct Result {
+        std::vector<double> periodUs;
+        std::vector<float> output;
+    };
+    auto report = [&](const char* name, Result& result) {
+        double total = 0.0;
+        for (double us : result.periodUs) {
+            total += us;
+        }
+        double avg = result.periodUs.empty() ? 0.0 : total / result.periodUs.size();
+        std::cout << "[Tools] " << name << ": avg " << avg << " us, p99 " << Percentile(result.periodUs, 0.99)
+                  << " us per 10 ms (" << avg / 100.0 << "% of one core); 1 kHz "
+                  << ToneDbfs(result.output, 1000.0, SAMPLE_RATE) << " dBFS, alias at " << foldedHz << " Hz "
+                  << ToneDbfs(result.output, foldedHz, SAMPLE_RATE) << " dBFS" << std::endl;
+    };
+
+    Result device;
+    ma_data_converter_config config = ma_data_converter_config_init(
+        ma_format_f32, ma_format_f32, static_cast<ma_uint32>(channels), 1,
+        static_cast<ma_uint32>(inRate), SAMPLE_RATE);
+    ma_data_converter converter;
+    if (ma_data_converter_init(&config, nullptr, &converter) != MA_SUCCESS) {
+        std::cerr << "[Tools] Cannot create the miniaudio converter" << std::endl;
+        return 1;
+    }
+    std::vector<float> out(period + 16);
+    for (size_t offset = 0; offset + period <= frames; offset += period) {
+        ma_uint64 inFrames = period;
+        ma_uint64 outFrames = out.size();
+        auto start = Clock::now();
+        ma_data_converter_process_pcm_frames(&converter, &input[offset * channels], &inFrames, out.data(), &outFrames);
+        device.periodUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        device.output.insert(device.output.end(), out.begin(), out.begin() + outFrames);
+    }
+    ma_data_converter_uninit(&converter, nullptr);
+
+    Result worker;
+    Dsp::PolyphaseResampler resampler;
+    resampler.Configure(inRate, SAMPLE_RATE);
+    std::vector<float> mono(period);
+    out.resize(resampler.MaxOutput(period));
+    for (size_t offset = 0; offset + period <= frames; offset += period) {
+        auto start = Clock::now();
+        Dsp::Downmix(&input[offset * channels], period, channels, mono.data());
+        size_t written = inRate == SAMPLE_RATE ? period : resampler.Process(mono.data(), period, out.data());
+        worker.periodUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        const float* converted = inRate == SAMPLE_RATE ? mono.data() : out.data();
+        worker.output.insert(worker.output.end(), converted, converted + written);
+    }
+
+    std::cout << "[Tools] bench-resample: " << inRate << " Hz x" << channels << " -> " << SAMPLE_RATE
+              << " Hz mono, " << seconds << " s (" << Dsp::SimdName() << ", " << resampler.TapsPerPhase()
+              << " taps per phase, " << resampler.Delay() * 1000.0 / SAMPLE_RATE << " ms delay)" << std::endl;
+    report("miniaudio converter (in callback)", device);
+    report("Downmix + PolyphaseResampler (audio thread)", worker);
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+// asr-parity: transcribe a WAV corpus through each capture storage encoding;
+// the 16-bit encodings must give the same text as float32
+// ----------------------------------------------------------------------------
+double RoundTripSnrDb(const std::vector<float>& audio, SampleEncoding encoding) {
+    AudioChunkPool pool((audio.size() + AudioChunkPool::kChunkSamples - 1) / AudioChunkPool::kChunkSamples, encoding);
+    PooledAudio stored(&pool);
+    stored.Append(audio.data(), audio.size());
+    std::vector<float> decoded(audio.size());
+    stored.CopyTo(0, decoded.size(), decoded.data());
+
+    double signal = 0.0;
+    double noise = 0.0;
+    for (size_t i = 0; i < audio.size(); ++i) {
+        double x = std::max(-1.0f, std::min(1.0f, audio[i]));
+        signal += x * x;
+        noise += (decoded[i] - x) * (decoded[i] - x);
+    }
+    return 10.0 * std::log10((signal + 1e-20) / (noise + 1e-20));
+}
+
+int RunAsrParity(const std::vector<std::string>& args) {
+    std::string modelDir = args.at(0);
+    std::string corpus = args.at(1);
+
+    std::vector<std::string> files = CollectWavFiles(corpus);
+    if (files.empty()) {
+        std::cerr << "[Tools] No .wav files in " << corpus << std::endl;
+        return 1;
+    }
+
+    AudioManager manager;
+    if (!manager.LoadRecognizer(modelDir)) {
+        return 1;
+    }
+
+    const SampleEncoding encodings[] = {SampleEncoding::Int16, SampleEncoding::Companded16};
+    size_t mismatches[2] = {0, 0};
+    double snrSum[2] = {0.0, 0.0};
+    for (const auto& file : files) {
+        std::vector<float> audio;
+        if (!LoadMono(file, SAMPLE_RATE, audio)) {
+            return 1;
+        }
+        manager.SetCaptureEncoding(SampleEncoding::Float32);
+        std::string reference = manager.TranscribeSamples(audio.data(), audio.size());
+
+        for (size_t e = 0; e < 2; ++e) {
+            manager.SetCaptureEncoding(encodings[e]);
+            std::string text = manager.TranscribeSamples(audio.data(), audio.size());
+            snrSum[e] += RoundTripSnrDb(audio, encodings[e]);
+            if (text != reference) {
+                ++mismatches[e];
+                std::cout << "[Tools] " << std::filesystem::path(file).filename().string() << " (" << SampleEncodingName(encodings[e])
+                          << "): \"" << text << "\" vs float32 \"" << reference << "\"" << std::endl;
+            }
+        }
+    }
+
+    std::cout << "[Tools] asr-parity: " << files.size() << " files (" << Dsp::SimdName() << ")" << std::endl;
+    for (size_t e = 0; e < 2; ++e) {
+        std::cout << "[Tools] " << SampleEncodingName(encodings[e]) << ": " << mismatches[e] << " transcripts differ, mean SNR "
+                  << snrSum[e] / files.size() << " dB" << std::endl;
+    }
+    return mismatches[0] + mismatches[1] > 0 ? 1 : 0;
+}
+
+// ----------------------------------------------------------------------------
+// bench-asr-split: decode a long recording whole and split at pauses, compare
+// wall time and text
+// ----------------------------------------------------------------------------
+int RunAsrSplitBenchmark(const std::vector<std::string>& args) {
+    std::string modelDir = args.at(0);
+    std::string path = args.at(1);
+    int runs = std::max(1, std::stoi(ArgOr(args, 2, "3")));
+
+    std::vector<float> audio;
+    if (!LoadMono(path, SAMPLE_RATE, audio)) {
+        return 1;
+    }
+    AudioManager manager;
+    if (!manager.LoadRecognizer(modelDir)) {
+        return 1;
+    }
+
+    PauseSplitter splitter(SAMPLE_RATE);
+    std::vector<SpeechSegment> segments = splitter.Split(audio.data(), audio.size());
+    std::cout << "[Tools] " << audio.size() / static_cast<double>(SAMPLE_RATE) << " s, " << segments.size() << " segments:";
+    for (const SpeechSegment& segment : segments) {
+        std::cout << " [" << segment.begin / static_cast<double>(SAMPLE_RATE) << ", "
+                  << segment.end / static_cast<double>(SAMPLE_RATE) << ")";
+    }
+    std::cout << std::endl;
+
+    std::string texts[2];
+    double bestMs[2] = {0.0, 0.0};
+    for (int mode = 0; mode < 2; ++mode) {
+        manager.SetSegmentedDecoding(mode == 1);
+        manager.TranscribeSamples(audio.data(), audio.size());  // Warm-up
+        for (int run = 0; run < runs; ++run) {
+            auto start = Clock::now();
+            texts[mode] = manager.TranscribeSamples(audio.data(), audio.size());
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            bestMs[mode] = run == 0 ? ms : std::min(bestMs[mode], ms);
+        }
+    }
+
+    double audioMs = audio.size() * 1000.0 / SAMPLE_RATE;
+    std::cout << "[Tools] whole:     " << bestMs[0] << " ms (RTF " << bestMs[0] / audioMs << ")  \"" << texts[0] << "\"" << std::endl;
+    std::cout << "[Tools] segmented: " << bestMs[1] << " ms (RTF " << bestMs[1] / audioMs << ")  \"" << texts[1] << "\"" << std::endl;
+    std::cout << "[Tools] speedup " << bestMs[0] / bestMs[1] << "x (best of " << runs << ", "
+              << std::thread::hardware_concurrency() << " cores)" << std::endl;
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+// replay-session: run the live voice pipeline on a WAV replayed in real time
+// (no sound hardware); transcripts are timed from the start of the replay
+// ----------------------------------------------------------------------------
+int RunReplaySession(const std::vector<std::string>& args) {
+    std::string modelDir = args.at(0);
+    std::string path = args.at(1);
+    std::string kwsDir = ArgOr(args, 2, "");
+
+    std::vector<float> audio;
+    if (!LoadMono(path, SAMPLE_RATE, audio)) {
+        return 1;
+    }
+
+    AudioManager manager;
+    manager.SetAudioSource(ParseAudioSource(path));
+    if (kwsDir.empty()) {
+        // Without a wake word the whole session is one recording; the
+        // capture pool is sized for it at init
+        manager.SetRecordingSeconds(static_cast<int>(audio.size() / SAMPLE_RATE) + 2);
+    }
+    if (!manager.InitializeRecognizer(modelDir)) {
+        return 1;
+    }
+    manager.EnableConditioning();
+    bool wakeWord = false;
+    if (!kwsDir.empty()) {
+        KwsConfig kwsConfig;
+        kwsConfig.modelDir = kwsDir;
+        wakeWord = manager.EnableWakeWord(kwsConfig);
+        if (!wakeWord) {
+            return 1;
+        }
+    }
+
+    ThreadSafeQueue<AppEvent> events;
+    auto start = Clock::now();
+    manager.Start(&events);
+    if (!wakeWord) {
+        manager.TriggerRecording();
+    }
+
+    // Run until the file has played, nothing is being recorded and the
+    // last transcript had time to arrive
+    const auto settle = std::chrono::seconds(5);
+    Clock::time_point finishedAt{};
+    Clock::time_point idleSince = Clock::now();
+    int transcripts = 0;
+    double lastTranscriptSec = 0.0;
+    while (true) {
+        while (auto event = events.tryPop()) {
+            if (event->type != EventType::AUDIO_INPUT) {
+                continue;
+            }
+            double sec = std::chrono::duration<double>(Clock::now() - start).count();
+            std::cout << "[Tools] " << sec << " s: \"" << event->payload << "\"" << std::endl;
+            lastTranscriptSec = sec;
+            ++transcripts;
+            idleSince = Clock::now();
+        }
+        if (manager.AudioSourceFinished()) {
+            if (finishedAt == Clock::time_point{}) {
+                finishedAt = Clock::now();
+                if (!wakeWord) {
+                    manager.StopRecording();
+                }
+            }
+            if (manager.IsRecording()) {
+                idleSince = Clock::now();
+            } else if (Clock::now() - std::max(idleSince, finishedAt) > settle) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    manager.Stop();
+
+    double finishedSec = std::chrono::duration<double>(finishedAt - start).count();
+    std::cout << "[Tools] replay-session: " << transcripts << " transcripts, replay ended at " << finishedSec << " s";
+    if (transcripts > 0) {
+        std::cout << ", last transcript " << (lastTranscriptSec - finishedSec) * 1000.0 << " ms after the end";
+    }
+    std::cout << std::endl;
+    return transcripts > 0 ? 0 : 1;
+}
+
+// ----------------------------------------------------------------------------
+// bench-asr-warmup: first-transcription latency with and without the load-time
+// warm-up, against the steady state
+// ----------------------------------------------------------------------------
+int RunAsrWarmupBenchmark(const std::vector<std::string>& args) {
+    std::string modelDir = args.at(0);
+    std::string path = ArgOr(args, 1, "");
+    int runs = std::max(1, std::stoi(ArgOr(args, 2, "5")));
+
+    std::vector<float> audio;
+    if (!path.empty()) {
+        if (!LoadMono(path, SAMPLE_RATE, audio)) {
+            return 1;
+        }
+    } else {
+        // 4 s of a gliding tone over noise; the text doesn't matter, only the decode
+        std::mt19937 rng(7);
+        std::normal_distribution<float> noise(0.0f, 0.02f);
+        audio.resize(SAMPLE_RATE * 4);
+        double phase = 0.0;
+        for (size_t i = 0; i < audio.size(); ++i) {
+            phase += 2.0 * 3.14159265358979 * (200.0 + 100.0 * i / audio.size()) / SAMPLE_RATE;
+            audio[i] = 0.2f * static_cast<float>(std::sin(phase)) + noise(rng);
+        }
+    }
+
+    auto timeOne = [&](AudioManager& manager) {
+        auto start = Clock::now();
+        manager.TranscribeSamples(audio.data(), audio.size());
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    double coldMs = 0.0;
+    {
+        AudioManager manager;
+        manager.SetRecognizerWarmup(false);
+        auto start = Clock::now();
+        if (!manager.LoadRecognizer(modelDir)) {
+            return 1;
+        }
+        double loadMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        coldMs = timeOne(manager);
+        std::cout << "[Tools] no warm-up: load " << loadMs << " ms, first transcription " << coldMs << " ms" << std::endl;
+    }
+
+    AudioManager manager;
+    auto start = Clock::now();
+    if (!manager.LoadRecognizer(modelDir)) {
+        return 1;
+    }
+    double loadMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    double warmMs = timeOne(manager);
+    std::cout << "[Tools] warm-up:    load " << loadMs << " ms, first transcription " << warmMs << " ms" << std::endl;
+
+    std::vector<double> steady;
+    for (int i = 0; i < runs; ++i) {
+        steady.push_back(timeOne(manager));
+    }
+    double steadyMs = Percentile(steady, 0.5);
+    std::cout << "[Tools] steady state: p50 " << steadyMs << " ms, max " << Percentile(steady, 1.0) << " ms over "
+              << runs << " runs (" << audio.size() / static_cast<double>(SAMPLE_RATE) << " s of audio)" << std::endl;
+    std::cout << "[Tools] first-call penalty: " << coldMs - steadyMs << " ms cold, " << warmMs - steadyMs
+              << " ms after warm-up" << std::endl;
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+// bench-asr: load each backend of an ASR config file and decode the same WAV
+// corpus with it; load time, memory, RTF and per-utterance latency
+// ----------------------------------------------------------------------------
+struct AsrBenchResult {
+    std::string name;
+    std::string type;
+    bool loaded = false;
+    double loadMs = 0.0;
+    double modelMb = 0.0;   // Resident growth from loading
+    double decodeMb = 0.0;  // ... and after decoding (runtime arenas)
+    double firstMs = 0.0;
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    double rtf = 0.0;
+    std::string firstText;
+};
+
+int RunAsrBackendBenchmark(const std::vector<std::string>& args) {
+    std::string configPath = args.at(0);
+    std::string corpus = args.at(1);
+    std::string selection = ArgOr(args, 2, "all");
+    int runs = std::max(1, std::stoi(ArgOr(args, 3, "1")));
+
+    AsrConfigFile configFile;
+    if (!LoadAsrConfigFile(configPath, configFile)) {
+        return 1;
+    }
+    std::vector<AsrConfig> backends;
+    if (selection == "all") {
+        backends = configFile.backends;
+    } else {
+        std::stringstream names(selection);
+        std::string name;
+        while (std::getline(names, name, ',')) {
+            const AsrConfig* config = configFile.Find(name);
+            if (!config) {
+                std::cerr << "[Tools] No [" << name << "] in " << configPath << std::endl;
+                return 1;
+            }
+            backends.push_back(*config);
+        }
+    }
+
+    // Decoded up front, so the corpus is part of every backend's baseline
+    std::vector<std::vector<float>> corpusAudio;
+    double corpusSec = 0.0;
+    for (const auto& file : CollectWavFiles(corpus)) {
+        corpusAudio.emplace_back();
+        if (!LoadMono(file, SAMPLE_RATE, corpusAudio.back())) {
+            return 1;
+        }
+        corpusSec += corpusAudio.back().size() / static_cast<double>(SAMPLE_RATE);
+    }
+    if (corpusAudio.empty()) {
+        std::cerr << "[Tools] No .wav files in " << corpus << std::endl;
+        return 1;
+    }
+
+    std::vector<AsrBenchResult> results;
+    for (AsrConfig config : backends) {
+        AsrBenchResult result;
+        result.name = config.name;
+        result.type = GetAsrBackend(config.type).name;
+        config.sampleRate = SAMPLE_RATE;
+
+        size_t baseline = ResidentBytes();
+        AsrEngine engine;
+        auto start = Clock::now();
+        result.loaded = engine.Init(config);
+        result.loadMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (!result.loaded) {
+            results.push_back(result);
+            continue;
+        }
+        result.modelMb = (static_cast<double>(ResidentBytes()) - baseline) / (1024.0 * 1024.0);
+
+        // One utterance at a time on the configured threads, as the pet decodes
+        std::vector<double> latencies;
+        double decodeMs = 0.0;
+        double decodedSec = 0.0;
+        for (int run = 0; run < runs; ++run) {
+            for (const std::vector<float>& audio : corpusAudio) {
+                std::vector<std::string> texts;
+                auto decodeStart = Clock::now();
+                engine.Transcribe({{audio.data(), audio.size()}}, texts);
+                double ms = std::chrono::duration<double, std::milli>(Clock::now() - decodeStart).count();
+                if (run == 0 && &audio == &corpusAudio.front()) {
+                    // The first decode pays the runtime's lazy setup; kept apart
+                    result.firstMs = ms;
+                    result.firstText = texts.empty() ? "" : texts[0];
+                    continue;
+                }
+                latencies.push_back(ms);
+                decodeMs += ms;
+                decodedSec += audio.size() / static_cast<double>(SAMPLE_RATE);
+            }
+        }
+        if (latencies.empty()) {
+            latencies.push_back(result.firstMs);
+            decodeMs = result.firstMs;
+            decodedSec = corpusSec;
+        }
+        result.p50Ms = Percentile(latencies, 0.50);
+        result.p95Ms = Percentile(latencies, 0.95);
+        result.rtf = decodeMs / 1000.0 / decodedSec;
+        result.decodeMb = (static_cast<double>(ResidentBytes()) - baseline) / (1024.0 * 1024.0);
+        std::cout << "[Tools] " << result.name << ": \"" << result.firstText << "\"" << std::endl;
+        results.push_back(result);
+    }
+
+    std::cout << "[Tools] bench-asr: " << corpusAudio.size() << " files, " << corpusSec << " s of audio, "
+              << runs << " run(s), " << std::thread::hardware_concurrency() << " cores" << std::endl;
+    std::cout << std::left << std::setw(22) << "backend" << std::setw(22) << "type" << std::right
+              << std::setw(9) << "load ms" << std::setw(10) << "model MB" << std::setw(11) << "decode MB"
+              << std::setw(10) << "first ms" << std::setw(9) << "p50 ms" << std::setw(9) << "p95 ms"
+              << std::setw(8) << "RTF" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    bool allLoaded = true;
+    for (const AsrBenchResult& result : results) {
+        std::cout << std::left << std::setw(22) << result.name << std::setw(22) << result.type << std::right;
+        if (!result.loaded) {
+            std::cout << std::setw(9) << "failed" << std::endl;
+            allLoaded = false;
+            continue;
+        }
+        std::cout << std::setw(9) << result.loadMs << std::setw(10) << result.modelMb << std::setw(11) << result.decodeMb
+                  << std::setw(10) << result.firstMs << std::setw(9) << result.p50Ms << std::setw(9) << result.p95Ms
+                  << std::setw(8) << std::setprecision(3) << result.rtf << std::setprecision(1) << std::endl;
+    }
+    std::cout << std::defaultfloat;
+    if (results.size() > 1) {
+        // Freed model memory isn't always returned to the OS, which shrinks
+        // the numbers of backends loaded later
+        std::cout << "[Tools] For exact memory figures, benchmark one backend per run" << std::endl;
+    }
+    return allLoaded ? 0 : 1;
+}
+
+const std::vector<ToolCommand>& Commands() {
+    static const std::vector<ToolCommand> commands = {
+        {"bench-lua", "bench-lua [script] [seconds] [limit_kb] [profile.folded]", RunLuaBenchmark},
+        {"aec-test", "aec-test <mic.wav> <reference.wav> [out.wav] [tail_ms]", RunEchoTest},
+        {"bench-kws", "bench-kws <kws_model_dir> [audio.wav] [seconds_of_silence]", RunKeywordBenchmark},
+        {"condition", "condition <in.wav> [out.wav] [all|hp,ns,agc]", RunConditionTest},
+        {"bench-condition", "bench-condition [seconds] [budget_percent]", RunConditionBenchmark},
+        {"bench-resample", "bench-resample [in_rate] [channels] [seconds]", RunResampleBenchmark},
+        {"asr-parity", "asr-parity <asr_model_dir> <corpus_dir|file.wav|list.txt>", RunAsrParity},
+        {"bench-asr-split", "bench-asr-split <asr_model_dir> <long.wav> [runs]", RunAsrSplitBenchmark},
+        {"bench-asr-warmup", "bench-asr-warmup <asr_model_dir> [audio.wav] [runs]", RunAsrWarmupBenchmark},
+        {"replay-session", "replay-session <asr_model_dir> <session.wav> [kws_model_dir]", RunReplaySession},
+        {"bench-asr", "bench-asr <asr.ini> <corpus_dir|file.wav|list.txt> [all|section,...] [runs]", RunAsrBackendBenchmark},
+    };
+    return commands;
+}
+
+} // namespace
+
+bool IsToolCommand(const std::string& name) {
+    for (const auto& command : Commands()) {
+        if (name == command.name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int Run(const std::vector<std::string>& args) {
+    if (args.empty()) {
+        return 1;
+    }
+
+    for (const auto& command : Commands()) {
+        if (args[0] == command.name) {
+            try {
+                return command.run(std::vector<std::string>(args.begin() + 1, args.end()));
+            } catch (const std::exception& e) {
+                std::cerr << "[Tools] " << command.name << " failed: " << e.what() << std::endl;
+                std::cerr << "[Tools] Usage: " << command.usage << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    std::cerr << "[Tools] Unknown command: " << args[0] << std::endl;
+    return 1;
+}
+
+} // namespace Tools
+} // namespace DesktopPet
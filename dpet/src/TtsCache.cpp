@@ -0,0 +1,336 @@
+#include "../include/TtsCache.h"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <cstdint>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace DesktopPet {
+
+namespace {
+
+constexpr char kMagic[4] = {'D', 'P', 'C', 'M'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kDataAlignment = 16;
+
+// On-disk clip header, followed by the key bytes and (aligned) float samples
+struct ClipHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t sampleRate;
+    uint32_t keyBytes;
+    uint64_t sampleCount;
+    uint64_t reserved;
+};
+
+size_t DataOffset(size_t keyBytes) {
+    size_t offset = sizeof(ClipHeader) + keyBytes;
+    return (offset + kDataAlignment - 1) / kDataAlignment * kDataAlignment;
+}
+
+uint64_t Fnv1a(const std::string& text) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+} // namespace
+
+// ============================================================================
+// MappedFile
+// ============================================================================
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ */
+class MappedFile {
+public:
+    static std::shared_ptr<const MappedFile> Open(const std::string& path) {
+        auto file = std::shared_ptr<MappedFile>(new MappedFile());
+#ifdef _WIN32
+        file->file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file->file_ == INVALID_HANDLE_VALUE) {
+            return nullptr;
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file->file_, &size) || size.QuadPart == 0) {
+            return nullptr;
+        }
+        file->mapping_ = CreateFileMappingA(file->file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!file->mapping_) {
+            return nullptr;
+        }
+        file->data_ = MapViewOfFile(file->mapping_, FILE_MAP_READ, 0, 0, 0);
+        file->size_ = static_cast<size_t>(size.QuadPart);
+#else
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return nullptr;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            close(fd);
+            return nullptr;
+        }
+        void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);  // The mapping keeps the file alive
+        if (data == MAP_FAILED) {
+            return nullptr;
+        }
+        file->data_ = data;
+        file->size_ = static_cast<size_t>(st.st_size);
+#endif
+        return file->data_ ? file : nullptr;
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (data_) {
+            UnmapViewOfFile(data_);
+        }
+        if (mapping_) {
+            CloseHandle(mapping_);
+        }
+        if (file_ != INVALID_HANDLE_VALUE) {
+            CloseHandle(file_);
+        }
+#else
+        if (data_) {
+            munmap(data_, size_);
+        }
+#endif
+    }
+
+    const uint8_t* Data() const { return static_cast<const uint8_t*>(data_); }
+    size_t Size() const { return size_; }
+
+private:
+    MappedFile() = default;
+
+    void* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#endif
+};
+
+// ============================================================================
+// TtsCache
+// ============================================================================
+
+TtsCache::TtsCache(size_t memoryBytes, std::string diskDir)
+    : memoryBudget_(memoryBytes), diskDir_(std::move(diskDir)) {
+    if (!diskDir_.empty()) {
+        std::error_code ec;
+        fs::create_directories(diskDir_, ec);
+        if (ec) {
+            std::cerr << "[TtsCache] Cannot create " << diskDir_ << ", disk store disabled" << std::endl;
+            diskDir_.clear();
+        }
+    }
+}
+
+std::string TtsCache::MakeKey(const std::string& voice, float speed, const std::string& text) {
+    std::string normalized;
+    normalized.reserve(text.size());
+    bool pendingSpace = false;
+    for (char c : text) {
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            pendingSpace = !normalized.empty();
+            continue;
+        }
+        if (pendingSpace) {
+            normalized += ' ';
+            pendingSpace = false;
+        }
+        normalized += c;
+    }
+
+    std::ostringstream key;
+    key << voice << '|' << std::fixed << std::setprecision(2) << speed << '|' << normalized;
+    return key.str();
+}
+
+PcmClipPtr TtsCache::Lookup(const std::string& key) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            ++stats_.memoryHits;
+            return it->second->clip;
+        }
+    }
+
+    // Disk lookup outside the lock: mapping a file may touch the filesystem
+    PcmClipPtr clip = LoadFromDisk(key);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!clip) {
+        ++stats_.misses;
+        return nullptr;
+    }
+    ++stats_.diskHits;
+    InsertLocked(key, clip);
+    return clip;
+}
+
+void TtsCache::Store(const std::string& key, const PcmClipPtr& clip, bool persist) {
+    if (!clip || clip->Size() == 0) {
+        return;
+    }
+    if (persist && !diskDir_.empty()) {
+        SaveToDisk(key, *clip);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    InsertLocked(key, clip);
+}
+
+TtsCache::Stats TtsCache::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.entries = lru_.size();
+    stats.memoryBytes = memoryUsed_;
+    return stats;
+}
+
+void TtsCache::InsertLocked(const std::string& key, const PcmClipPtr& clip) {
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        memoryUsed_ -= it->second->clip->Size() * sizeof(float);
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+
+    lru_.push_front(Entry{key, clip});
+    index_[key] = lru_.begin();
+    memoryUsed_ += clip->Size() * sizeof(float);
+
+    // Evict least recently used; clips still playing stay alive via shared_ptr
+    while (memoryUsed_ > memoryBudget_ && lru_.size() > 1) {
+        Entry& victim = lru_.back();
+        memoryUsed_ -= victim.clip->Size() * sizeof(float);
+        index_.erase(victim.key);
+        lru_.pop_back();
+    }
+}
+
+std::string TtsCache::DiskPath(const std::string& key) const {
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << Fnv1a(key) << ".pcm";
+    return (fs::path(diskDir_) / name.str()).string();
+}
+
+PcmClipPtr TtsCache::LoadFromDisk(const std::string& key) const {
+    if (diskDir_.empty()) {
+        return nullptr;
+    }
+
+    std::shared_ptr<const MappedFile> file = MappedFile::Open(DiskPath(key));
+    if (!file || file->Size() < sizeof(ClipHeader)) {
+        return nullptr;
+    }
+
+    ClipHeader header;
+    memcpy(&header, file->Data(), sizeof(header));
+    size_t offset = DataOffset(header.keyBytes);
+    if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        offset + header.sampleCount * sizeof(float) > file->Size()) {
+        return nullptr;
+    }
+
+    // Hash collision guard: the full key is stored in the file
+    if (header.keyBytes != key.size() ||
+        memcmp(file->Data() + sizeof(ClipHeader), key.data(), key.size()) != 0) {
+        return nullptr;
+    }
+
+    const float* samples = reinterpret_cast<const float*>(file->Data() + offset);
+    return PcmClip::FromMapping(file, samples, static_cast<size_t>(header.sampleCount),
+                                static_cast<int>(header.sampleRate));
+}
+
+bool TtsCache::SaveToDisk(const std::string& key, const PcmClip& clip) const {
+    std::string path = DiskPath(key);
+    std::error_code ec;
+    if (fs::exists(path, ec)) {
+        return true;
+    }
+
+    ClipHeader header;
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.sampleRate = static_cast<uint32_t>(clip.SampleRate());
+    header.keyBytes = static_cast<uint32_t>(key.size());
+    header.sampleCount = clip.Size();
+    header.reserved = 0;
+
+    // Write to a temporary name and rename, so a crash never leaves a
+    // truncated clip under the real name
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "[TtsCache] Cannot write " << tempPath << std::endl;
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(key.data(), key.size());
+        size_t padding = DataOffset(key.size()) - sizeof(header) - key.size();
+        const char zeros[kDataAlignment] = {};
+        out.write(zeros, padding);
+        out.write(reinterpret_cast<const char*>(clip.Data()), clip.Size() * sizeof(float));
+        if (!out) {
+            std::cerr << "[TtsCache] Write failed: " << tempPath << std::endl;
+            return false;
+        }
+    }
+
+    fs::rename(tempPath, path, ec);
+    if (ec) {
+        fs::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// Phrase list
+// ============================================================================
+
+std::vector<std::string> LoadPhraseList(const std::string& path) {
+    std::vector<std::string> phrases;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        size_t begin = line.find_first_not_of(" \t");
+        if (begin == std::string::npos || line[begin] == '#') {
+            continue;
+        }
+        phrases.push_back(line.substr(begin));
+    }
+    return phrases;
+}
+
+} // namespace DesktopPet
@@ -0,0 +1,315 @@
+#include "../include/TtsEngine.h"
+#include "sherpa-onnx/c-api/c-api.h"
+#include <iostream>
+#include <filesystem>
+#include <cstring>
+#include <cctype>
+
+namespace fs = std::filesystem;
+
+namespace DesktopPet {
+
+namespace {
+
+enum class Punct {
+    None,
+    Hard,       // Sentence end
+    Soft,       // Clause end (comma-like)
+    Incomplete  // Need more bytes to decide
+};
+
+struct PunctSequence {
+    const char* bytes;
+    Punct kind;
+};
+
+// Full-width punctuation, UTF-8 encoded
+const PunctSequence kWidePunct[] = {
+    {"\xE3\x80\x82", Punct::Hard},  // 。
+    {"\xEF\xBC\x81", Punct::Hard},  // ！
+    {"\xEF\xBC\x9F", Punct::Hard},  // ？
+    {"\xEF\xBC\x9B", Punct::Hard},  // ；
+    {"\xE2\x80\xA6", Punct::Hard},  // …
+    {"\xEF\xBC\x8C", Punct::Soft},  // ，
+    {"\xE3\x80\x81", Punct::Soft},  // 、
+    {"\xEF\xBC\x9A", Punct::Soft},  // ：
+};
+
+/**
+ * @brief Classify the character at text[i]; len receives its byte length
+ */
+Punct MatchPunct(const std::string& text, size_t i, size_t& len) {
+    unsigned char c = static_cast<unsigned char>(text[i]);
+    len = 1;
+
+    if (c < 0x80) {
+        switch (c) {
+            case '!': case '?': case ';': case '\n':
+                return Punct::Hard;
+            case ',': case ':':
+                return Punct::Soft;
+            case '.':
+                // "3.14" and "e.g" are not sentence ends; wait for the next byte
+                if (i + 1 >= text.size()) {
+                    return Punct::Incomplete;
+                }
+                return std::isspace(static_cast<unsigned char>(text[i + 1])) ? Punct::Hard : Punct::None;
+            default:
+                return Punct::None;
+        }
+    }
+
+    if ((c & 0xF0) == 0xE0) {
+        if (i + 3 > text.size()) {
+            return Punct::Incomplete;
+        }
+        len = 3;
+        for (const auto& punct : kWidePunct) {
+            if (text.compare(i, 3, punct.bytes) == 0) {
+                return punct.kind;
+            }
+        }
+        return Punct::None;
+    }
+
+    // Other UTF-8 lead/continuation bytes
+    if ((c & 0xE0) == 0xC0) {
+        len = 2;
+    } else if ((c & 0xF8) == 0xF0) {
+        len = 4;
+    }
+    return Punct::None;
+}
+
+/**
+ * @brief True if the segment has something to pronounce
+ */
+bool HasSpeakableText(const std::string& text) {
+    for (size_t i = 0; i < text.size(); ) {
+        size_t len = 1;
+        Punct kind = MatchPunct(text, i, len);
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (kind == Punct::None && (c >= 0x80 || std::isalnum(c))) {
+            return true;
+        }
+        i += len;
+    }
+    return false;
+}
+
+std::string Trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+std::string FileIn(const std::string& dir, const std::string& name) {
+    std::string path = dir + "/" + name;
+    return fs::exists(path) ? path : "";
+}
+
+std::string FirstFileIn(const std::string& dir, std::initializer_list<const char*> names) {
+    for (const char* name : names) {
+        std::string path = FileIn(dir, name);
+        if (!path.empty()) {
+            return path;
+        }
+    }
+    return "";
+}
+
+/**
+ * @brief Comma-separated list of the text-normalization FSTs shipped with a model
+ */
+std::string RuleFsts(const std::string& dir) {
+    std::string fsts;
+    for (const char* name : {"phone.fst", "date.fst", "number.fst", "new_heteronym.fst"}) {
+        std::string path = FileIn(dir, name);
+        if (!path.empty()) {
+            fsts += (fsts.empty() ? "" : ",") + path;
+        }
+    }
+    return fsts;
+}
+
+} // namespace
+
+// ============================================================================
+// TtsEngine
+// ============================================================================
+
+TtsEngine::~TtsEngine() {
+    if (tts_) {
+        SherpaOnnxDestroyOfflineTts(tts_);
+        tts_ = nullptr;
+    }
+}
+
+bool TtsEngine::Init(const TtsConfig& config) {
+    std::cout << "[TtsEngine] Loading TTS model from " << config.modelDir << std::endl;
+    config_ = config;
+    const std::string& dir = config.modelDir;
+
+    // Strings must outlive SherpaOnnxCreateOfflineTts
+    std::string model, vocoder, voices, lexicon, tokens, dataDir, dictDir, ruleFsts;
+    tokens = FileIn(dir, "tokens.txt");
+    dataDir = FileIn(dir, "espeak-ng-data");
+    dictDir = FileIn(dir, "dict");
+    ruleFsts = RuleFsts(dir);
+
+    SherpaOnnxOfflineTtsConfig ttsConfig;
+    memset(&ttsConfig, 0, sizeof(ttsConfig));
+
+    switch (config.type) {
+        case TtsModelType::Vits:
+            model = FileIn(dir, "model.onnx");
+            lexicon = FileIn(dir, "lexicon.txt");
+            ttsConfig.model.vits.model = model.c_str();
+            ttsConfig.model.vits.lexicon = lexicon.c_str();
+            ttsConfig.model.vits.tokens = tokens.c_str();
+            ttsConfig.model.vits.data_dir = dataDir.c_str();
+            ttsConfig.model.vits.dict_dir = dictDir.c_str();
+            ttsConfig.model.vits.noise_scale = 0.667f;
+            ttsConfig.model.vits.noise_scale_w = 0.8f;
+            ttsConfig.model.vits.length_scale = 1.0f;
+            break;
+
+        case TtsModelType::Matcha:
+            model = FirstFileIn(dir, {"model-steps-3.onnx", "model.onnx"});
+            vocoder = FirstFileIn(dir, {"vocos-22khz-univ.onnx", "hifigan_v2.onnx", "vocoder.onnx"});
+            lexicon = FileIn(dir, "lexicon.txt");
+            ttsConfig.model.matcha.acoustic_model = model.c_str();
+            ttsConfig.model.matcha.vocoder = vocoder.c_str();
+            ttsConfig.model.matcha.lexicon = lexicon.c_str();
+            ttsConfig.model.matcha.tokens = tokens.c_str();
+            ttsConfig.model.matcha.data_dir = dataDir.c_str();
+            ttsConfig.model.matcha.dict_dir = dictDir.c_str();
+            ttsConfig.model.matcha.noise_scale = 0.667f;
+            ttsConfig.model.matcha.length_scale = 1.0f;
+            break;
+
+        case TtsModelType::Kokoro:
+            model = FileIn(dir, "model.onnx");
+            voices = FileIn(dir, "voices.bin");
+            // Multi-lingual Kokoro ships one lexicon per language
+            for (const char* name : {"lexicon-us-en.txt", "lexicon-zh.txt"}) {
+                std::string path = FileIn(dir, name);
+                if (!path.empty()) {
+                    lexicon += (lexicon.empty() ? "" : ",") + path;
+                }
+            }
+            ttsConfig.model.kokoro.model = model.c_str();
+            ttsConfig.model.kokoro.voices = voices.c_str();
+            ttsConfig.model.kokoro.tokens = tokens.c_str();
+            ttsConfig.model.kokoro.data_dir = dataDir.c_str();
+            ttsConfig.model.kokoro.dict_dir = dictDir.c_str();
+            ttsConfig.model.kokoro.lexicon = lexicon.c_str();
+            ttsConfig.model.kokoro.length_scale = 1.0f;
+            break;
+    }
+
+    if (model.empty() || tokens.empty()) {
+        std::cerr << "[TtsEngine] Model or tokens file missing in " << dir << std::endl;
+        return false;
+    }
+
+    ttsConfig.model.num_threads = config.numThreads;
+    ttsConfig.model.provider = "cpu";
+    ttsConfig.model.debug = 0;
+    ttsConfig.rule_fsts = ruleFsts.c_str();
+    // We feed one sentence per call; let sherpa keep it whole
+    ttsConfig.max_num_sentences = 1;
+
+    tts_ = SherpaOnnxCreateOfflineTts(&ttsConfig);
+    if (!tts_) {
+        std::cerr << "[TtsEngine] TTS model load failed" << std::endl;
+        return false;
+    }
+
+    sampleRate_ = SherpaOnnxOfflineTtsSampleRate(tts_);
+    std::cout << "[TtsEngine] TTS loaded (" << sampleRate_ << " Hz, "
+              << SherpaOnnxOfflineTtsNumSpeakers(tts_) << " speakers)" << std::endl;
+    return true;
+}
+
+std::string TtsEngine::VoiceId() const {
+    return fs::path(config_.modelDir).filename().string() + "#" + std::to_string(config_.speakerId);
+}
+
+bool TtsEngine::Synthesize(const std::string& text, std::vector<float>& samples) {
+    samples.clear();
+    if (!tts_ || text.empty()) {
+        return false;
+    }
+
+    const SherpaOnnxGeneratedAudio* audio =
+        SherpaOnnxOfflineTtsGenerate(tts_, text.c_str(), config_.speakerId, config_.speed);
+    if (!audio) {
+        std::cerr << "[TtsEngine] Synthesis failed: " << text << std::endl;
+        return false;
+    }
+
+    samples.assign(audio->samples, audio->samples + audio->n);
+    SherpaOnnxDestroyOfflineTtsGeneratedAudio(audio);
+    return !samples.empty();
+}
+
+// ============================================================================
+// SentenceSplitter
+// ============================================================================
+
+void SentenceSplitter::Feed(const std::string& piece, std::vector<std::string>& sentences) {
+    pending_ += piece;
+
+    size_t i = scanned_;
+    while (i < pending_.size()) {
+        size_t len = 1;
+        Punct kind = MatchPunct(pending_, i, len);
+        if (kind == Punct::Incomplete) {
+            break;
+        }
+
+        size_t end = i + len;
+        size_t limit = emitted_ == 0 ? firstClauseBytes_ : maxClauseBytes_;
+        if (kind == Punct::Hard || (kind == Punct::Soft && end >= limit)) {
+            Emit(end, sentences);
+            i = 0;
+            continue;
+        }
+        i = end;
+    }
+    scanned_ = i;
+}
+
+std::string SentenceSplitter::Flush() {
+    std::string rest = Trim(pending_);
+    pending_.clear();
+    scanned_ = 0;
+    emitted_ = 0;
+    return HasSpeakableText(rest) ? rest : "";
+}
+
+void SentenceSplitter::Emit(size_t end, std::vector<std::string>& sentences) {
+    std::string sentence = Trim(pending_.substr(0, end));
+    pending_.erase(0, end);
+    if (HasSpeakableText(sentence)) {
+        sentences.push_back(std::move(sentence));
+        ++emitted_;
+    }
+}
+
+std::vector<std::string> SentenceSplitter::Split(const std::string& text) {
+    SentenceSplitter splitter;
+    std::vector<std::string> sentences;
+    splitter.Feed(text, sentences);
+    std::string rest = splitter.Flush();
+    if (!rest.empty()) {
+        sentences.push_back(std::move(rest));
+    }
+    return sentences;
+}
+
+} // namespace DesktopPet
@@ -0,0 +1,75 @@
+#include "../include/Utils.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace DesktopPet {
+
+#ifdef _WIN32
+
+WakeEvent::WakeEvent() {
+    event_ = CreateEventA(nullptr, FALSE, FALSE, nullptr);  // Auto-reset
+}
+
+WakeEvent::~WakeEvent() {
+    if (event_) {
+        CloseHandle(event_);
+    }
+}
+
+void WakeEvent::Signal() {
+    if (!signaled_.exchange(true, std::memory_order_release)) {
+        SetEvent(event_);
+    }
+}
+
+void WakeEvent::Block(int timeoutMs) {
+    WaitForSingleObject(event_, timeoutMs < 0 ? INFINITE : static_cast<DWORD>(timeoutMs));
+}
+
+#else
+
+WakeEvent::WakeEvent() {
+    if (pipe(pipe_) == 0) {
+        for (int fd : pipe_) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+    }
+}
+
+WakeEvent::~WakeEvent() {
+    for (int fd : pipe_) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+}
+
+void WakeEvent::Signal() {
+    if (!signaled_.exchange(true, std::memory_order_release)) {
+        // A full pipe already holds a pending wakeup, so a failed write is fine
+        char byte = 1;
+        ssize_t written = write(pipe_[1], &byte, 1);
+        (void)written;
+    }
+}
+
+void WakeEvent::Block(int timeoutMs) {
+    pollfd fd = {pipe_[0], POLLIN, 0};
+    if (poll(&fd, 1, timeoutMs) > 0) {
+        // Drain: wakeups left over from signals already consumed through the flag
+        char buffer[64];
+        while (read(pipe_[0], buffer, sizeof(buffer)) > 0) {
+        }
+    }
+}
+
+#endif
+
+} // namespace DesktopPet
@@ -0,0 +1,74 @@
+#include "../include/WavCorpus.h"
+#include "miniaudio/miniaudio.h"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+
+namespace DesktopPet {
+
+namespace {
+
+bool HasWavExtension(const std::filesystem::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == ".wav";
+}
+
+} // namespace
+
+std::vector<std::string> CollectWavFiles(const std::string& input) {
+    namespace fs = std::filesystem;
+    std::vector<std::string> files;
+    if (fs::is_directory(input)) {
+        for (const auto& entry : fs::recursive_directory_iterator(input)) {
+            if (entry.is_regular_file() && HasWavExtension(entry.path())) {
+                files.push_back(entry.path().string());
+            }
+        }
+        std::sort(files.begin(), files.end());
+    } else if (HasWavExtension(input)) {
+        files.push_back(input);
+    } else {
+        std::ifstream manifest(input);
+        fs::path base = fs::path(input).parent_path();
+        std::string line;
+        while (std::getline(manifest, line)) {
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            fs::path path(line);
+            files.push_back(path.is_absolute() ? line : (base / path).string());
+        }
+    }
+    return files;
+}
+
+bool LoadWavMono(const std::string& path, int sampleRate, std::vector<float>& samples) {
+    ma_decoder_config config = ma_decoder_config_init(ma_format_f32, 1, static_cast<ma_uint32>(sampleRate));
+    ma_decoder decoder;
+    if (ma_decoder_init_file(path.c_str(), &config, &decoder) != MA_SUCCESS) {
+        return false;
+    }
+    samples.clear();
+    float chunk[4096];
+    ma_uint64 framesRead = 0;
+    while (ma_decoder_read_pcm_frames(&decoder, chunk, 4096, &framesRead) == MA_SUCCESS && framesRead > 0) {
+        samples.insert(samples.end(), chunk, chunk + framesRead);
+    }
+    ma_decoder_uninit(&decoder);
+    return true;
+}
+
+double Percentile(std::vector<double> values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+    return values[std::min(index, values.size() - 1)];
+}
+
+} // namespace DesktopPet
@@ -2,11 +2,41 @@
 // Main entry point
 
 #include "../include/App.h"
+#include "../include/Tools.h"
 #include <iostream>
+#include <string>
 
 int main(int argc, char* argv[]) {
+    // Headless developer tools (benchmarks, offline tests)
+    if (argc > 1 && DesktopPet::Tools::IsToolCommand(argv[1])) {
+        return DesktopPet::Tools::Run(std::vector<std::string>(argv + 1, argv + argc));
+    }
+    
     DesktopPet::App app;
     
+    // --audio-source device|null|<session.wav> [--loop]: replay a recorded
+    // session or run without sound hardware
+    // --asr-config <asr.ini> [--asr-backend <section>]: pick the recognizer
+    DesktopPet::AudioSourceConfig audioSource;
+    std::string asrConfigPath = "config/asr.ini";
+    std::string asrBackend;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--audio-source" && i + 1 < argc) {
+            bool loop = audioSource.loop;
+            audioSource = DesktopPet::ParseAudioSource(argv[++i]);
+            audioSource.loop = loop;
+        } else if (arg == "--loop") {
+            audioSource.loop = true;
+        } else if (arg == "--asr-config" && i + 1 < argc) {
+            asrConfigPath = argv[++i];
+        } else if (arg == "--asr-backend" && i + 1 < argc) {
+            asrBackend = argv[++i];
+        }
+    }
+    app.SetAudioSource(audioSource);
+    app.SetAsrConfig(asrConfigPath, asrBackend);
+    
     if (!app.Init()) {
         std::cerr << "Failed to initialize application" << std::endl;
         return 1;
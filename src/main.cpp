@@ -9,6 +9,12 @@
 #include <ctime>
 #include <regex>
 #include <unordered_map>
+#include <deque>
+#include <condition_variable>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <memory>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -17,19 +23,24 @@
 #define MINIAUDIO_IMPLEMENTATION
 #include "miniaudio.h"
 
-#include "sherpa-onnx/c-api/c-api.h"
+#include "AsrBackend.h"
+#include "AudioSource.h"
+#include "WavCorpus.h"
 #include "llama.h"
 
 constexpr int SAMPLE_RATE = 16000;
 constexpr int CHANNELS = 1;
 constexpr int RECORDING_SECONDS = 20;
+constexpr size_t PIPELINE_QUEUE_DEPTH = 2;            // 流水线阶段间队列容量，满时上游等待
+constexpr size_t MIN_UTTERANCE_SAMPLES = SAMPLE_RATE * 3 / 10;  // 短于 0.3 秒的录音不提交
 
 // 全局变量
 std::atomic<bool> g_recording(false);
 std::vector<float> g_audioBuffer;
 std::mutex g_bufferMutex;
-const SherpaOnnxOfflineRecognizer* g_recognizer = nullptr;
+std::unique_ptr<DesktopPet::AsrEngine> g_asr;  // 识别后端（dpet/config/asr.ini 可选）
 bool g_debugMode = false;
+std::mutex g_consoleMutex;  // 流水线模式下多个线程共用控制台
 
 // LLM 全局变量
 llama_model* g_llama_model = nullptr;
@@ -44,16 +55,46 @@ struct DialogTurn {
 std::vector<DialogTurn> g_dialog_history;
 constexpr int MAX_CONTEXT_TOKENS = 1800;  // 留一些余量，实际上下文是2048
 
-void audio_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount) {
+void audio_callback(void* pUser, const float* pInput, unsigned int frameCount) {
     if (!g_recording) {
         return;
     }
-    const float* pInputF = (const float*)pInput;
     std::lock_guard<std::mutex> lock(g_bufferMutex);
-    for (ma_uint32 i = 0; i < frameCount; ++i) {
-        g_audioBuffer.push_back(pInputF[i]);
+    for (unsigned int i = 0; i < frameCount; ++i) {
+        g_audioBuffer.push_back(pInput[i]);
     }
-    (void)pOutput;
+    (void)pUser;
+}
+
+// 采集输入：默认麦克风；--replay <会话.wav> 用 WAV 文件代替麦克风，每次开始录音都从头
+// 按实时速度送入录音缓冲区，--replay null 送入静音。与 dpet 共用 AudioSource，
+// 没有声卡的机器上也能重复同样的语音会话
+DesktopPet::AudioSourceConfig g_sourceConfig;
+std::unique_ptr<DesktopPet::AudioSource> g_source;
+
+bool IsReplay() {
+    return g_sourceConfig.type == DesktopPet::AudioSourceType::File;
+}
+
+bool OpenCapture() {
+    auto source = DesktopPet::AudioSource::Create(g_sourceConfig);
+    if (!source->Open(SAMPLE_RATE, CHANNELS, audio_callback, nullptr)) {
+        return false;
+    }
+    g_source = std::move(source);
+    return true;
+}
+
+bool StartCapture() {
+    // 回放文件重新打开，从头开始
+    if (IsReplay() && !OpenCapture()) {
+        return false;
+    }
+    return g_source->Start();
+}
+
+void StopCapture() {
+    g_source->Stop();
 }
 
 void SaveAudioToWav(const std::vector<float>& audioData, const std::string& filename) {
@@ -69,38 +110,27 @@ void SaveAudioToWav(const std::vector<float>& audioData, const std::string& file
     }
 }
 
-// 初始化识别器
-bool InitializeRecognizer(const std::string& modelDir) {
-    SherpaOnnxOfflineRecognizerConfig config;
-    memset(&config, 0, sizeof(config));
-    
-    std::string modelPath = modelDir + "/model.onnx";
-    std::string tokensPath = modelDir + "/tokens.txt";
-    
-    config.model_config.sense_voice.model = modelPath.c_str();
-    config.model_config.sense_voice.language = "auto";
-    config.model_config.sense_voice.use_itn = 1;
-    config.model_config.tokens = tokensPath.c_str();
-    config.model_config.num_threads = 2;
-    config.model_config.provider = "cpu";
-    config.model_config.debug = g_debugMode ? 1 : 0;
-    
-    config.decoding_method = "greedy_search";
-    config.max_active_paths = 4;
+// 初始化识别器（后端、线程数、provider 来自 AsrConfig）
+bool InitializeRecognizer(const DesktopPet::AsrConfig& asrConfig) {
+    DesktopPet::AsrConfig config = asrConfig;
+    config.sampleRate = SAMPLE_RATE;
+    config.debug = g_debugMode;
     
     if (g_debugMode) {
         std::cout << "正在加载模型..." << std::endl;
-        std::cout << "  模型: " << modelPath << std::endl;
-        std::cout << "  词表: " << tokensPath << std::endl;
+        std::cout << "  后端: " << config.name << " (" << DesktopPet::GetAsrBackend(config.type).name << ")" << std::endl;
+        std::cout << "  目录: " << config.modelDir << std::endl;
+        std::cout << "  线程: " << config.numThreads << ", provider: " << config.provider << std::endl;
     }
     
     try {
-        g_recognizer = SherpaOnnxCreateOfflineRecognizer(&config);
-        if (g_recognizer) {
+        auto asr = std::make_unique<DesktopPet::AsrEngine>();
+        if (asr->Init(config)) {
+            g_asr = std::move(asr);
             std::cout << "✓ 模型加载成功" << std::endl;
             return true;
         } else {
-            std::cerr << "✗ 模型加载失败 (返回 nullptr)" << std::endl;
+            std::cerr << "✗ 模型加载失败" << std::endl;
             return false;
         }
     } catch (const std::exception& e) {
@@ -114,9 +144,8 @@ bool InitializeRecognizer(const std::string& modelDir) {
 
 // 清理识别器
 void CleanupRecognizer() {
-    if (g_recognizer) {
-        SherpaOnnxDestroyOfflineRecognizer(g_recognizer);
-        g_recognizer = nullptr;
+    if (g_asr) {
+        g_asr.reset();
         if (g_debugMode) {
             std::cout << "识别器已清理" << std::endl;
         }
@@ -222,8 +251,19 @@ void CleanupLLM() {
     }
 }
 
+// 单次 LLM 调用的计时（批处理基准用）
+struct LlmStats {
+    int promptTokens = 0;
+    int generatedTokens = 0;
+    double promptMs = 0.0;    // 处理 prompt（prefill）
+    double generateMs = 0.0;  // 逐 token 生成
+};
+
 // LLM 对话（带对话历史管理）
-std::string ChatWithLLM(const std::string& userInput) {
+// streamOutput 为 false 时不逐 token 输出，由调用方打印完整回复
+// seed 为 0 时使用当前时间作为采样种子；stats 非空时填入计时
+std::string ChatWithLLM(const std::string& userInput, bool streamOutput = true,
+                        uint32_t seed = 0, LlmStats* stats = nullptr) {
     if (!g_llama_model || !g_llama_context) {
         return "[错误: LLM 未初始化]";
     }
@@ -285,9 +325,11 @@ std::string ChatWithLLM(const std::string& userInput) {
     llama_batch batch = llama_batch_get_one(tokens.data(), tokens.size());
     
     // Decode
+    auto promptStart = std::chrono::steady_clock::now();
     if (llama_decode(g_llama_context, batch) != 0) {
         return "[错误: Decode 失败]";
     }
+    auto generateStart = std::chrono::steady_clock::now();
     
     // 生成回复（流式输出，使用 sampler 链）
     std::string response;
@@ -312,7 +354,7 @@ std::string ChatWithLLM(const std::string& userInput) {
     
     // 添加分布采样（使用随机种子）
     llama_sampler_chain_add(sampler_chain, 
-        llama_sampler_init_dist(static_cast<uint32_t>(std::time(nullptr))));
+        llama_sampler_init_dist(seed != 0 ? seed : static_cast<uint32_t>(std::time(nullptr))));
     
     while (n_generated < max_tokens) {
         // 使用 sampler 链进行采样
@@ -334,7 +376,9 @@ std::string ChatWithLLM(const std::string& userInput) {
             response.append(token_text);
             
             // 流式输出：立即显示生成的token
-            std::cout << token_text << std::flush;
+            if (streamOutput) {
+                std::cout << token_text << std::flush;
+            }
             
             // 检查是否生成了结束标记 <|im_end|>
             if (response.find("<|im_end|>") != std::string::npos) {
@@ -368,7 +412,17 @@ std::string ChatWithLLM(const std::string& userInput) {
     // 释放 sampler 链
     llama_sampler_free(sampler_chain);
     
-    std::cout << std::endl;  // 输出换行
+    if (stats) {
+        auto end = std::chrono::steady_clock::now();
+        stats->promptTokens = n_prompt_tokens;
+        stats->generatedTokens = n_generated;
+        stats->promptMs = std::chrono::duration<double, std::milli>(generateStart - promptStart).count();
+        stats->generateMs = std::chrono::duration<double, std::milli>(end - generateStart).count();
+    }
+    
+    if (streamOutput) {
+        std::cout << std::endl;  // 输出换行
+    }
     
     // 移除尾部的 <|im_end|> 标记
     size_t pos = response.find("<|im_end|>");
@@ -384,13 +438,7 @@ std::string ChatWithLLM(const std::string& userInput) {
 
 // 转录音频
 std::string TranscribeAudio(const std::vector<float>& audioData) {
-    if (!g_recognizer || audioData.empty()) {
-        return "";
-    }
-    
-    const SherpaOnnxOfflineStream* stream = SherpaOnnxCreateOfflineStream(g_recognizer);
-    if (!stream) {
-        std::cerr << "✗ 创建流失败" << std::endl;
+    if (!g_asr || audioData.empty()) {
         return "";
     }
     
@@ -398,60 +446,61 @@ std::string TranscribeAudio(const std::vector<float>& audioData) {
         std::cout << "正在转录音频..." << std::endl;
     }
     
-    SherpaOnnxAcceptWaveformOffline(stream, SAMPLE_RATE, audioData.data(), audioData.size());
-    SherpaOnnxDecodeOfflineStream(g_recognizer, stream);
-    
-    const SherpaOnnxOfflineRecognizerResult* result = SherpaOnnxGetOfflineStreamResult(stream);
-    std::string text;
-    if (result && result->text) {
-        text = result->text;
+    std::vector<std::string> texts;
+    if (!g_asr->Transcribe({{audioData.data(), audioData.size()}}, texts)) {
+        std::cerr << "✗ 转录失败" << std::endl;
+        return "";
     }
-    
-    SherpaOnnxDestroyOfflineRecognizerResult(result);
-    SherpaOnnxDestroyOfflineStream(stream);
-    
-    return text;
+    return texts[0];
 }
 
 // 录音并转录
-std::string RecordAndTranscribe(ma_device& device) {
+std::string RecordAndTranscribe() {
     // 清空缓冲区
     {
         std::lock_guard<std::mutex> lock(g_bufferMutex);
         g_audioBuffer.clear();
     }
     
-    std::cout << "\n[录音中] 请说话，最长 " << RECORDING_SECONDS << " 秒（按回车提前结束）..." << std::endl;
+    bool replay = IsReplay();
+    if (replay) {
+        std::cout << "\n[回放中] " << g_sourceConfig.path << "，最长 " << RECORDING_SECONDS << " 秒..." << std::endl;
+    } else {
+        std::cout << "\n[录音中] 请说话，最长 " << RECORDING_SECONDS << " 秒（按回车提前结束）..." << std::endl;
+    }
     std::cout << "========================================" << std::endl;
     
     g_recording = true;
-    if (ma_device_start(&device) != MA_SUCCESS) {
+    if (!StartCapture()) {
+        g_recording = false;
         std::cerr << "✗ 启动音频设备失败" << std::endl;
         return "";
     }
     
-    // 录音 N 秒，或者用户按回车提前结束
+    // 录音 N 秒，或者用户按回车提前结束（回放时到文件结尾为止）
     auto start_time = std::chrono::steady_clock::now();
     bool manual_stop = false;
     
-    // 创建线程检测用户输入
-    std::thread input_thread([&manual_stop]() {
-        std::cin.get();  // 等待用户按回车
-        manual_stop = true;
-    });
-    input_thread.detach();
+    // 创建线程检测用户输入；回放时不读控制台，管道输入的后续命令不会被吞掉
+    if (!replay) {
+        std::thread input_thread([&manual_stop]() {
+            std::cin.get();  // 等待用户按回车
+            manual_stop = true;
+        });
+        input_thread.detach();
+    }
     
     while (g_recording) {
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
         auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
             std::chrono::steady_clock::now() - start_time).count();
-        if (elapsed >= RECORDING_SECONDS || manual_stop) {
+        if (elapsed >= RECORDING_SECONDS || manual_stop || g_source->Finished()) {
             break;
         }
     }
     
     g_recording = false;
-    ma_device_stop(&device);
+    StopCapture();
     
     if (manual_stop) {
         std::cout << "[手动停止录音]" << std::endl;
@@ -480,6 +529,459 @@ std::string RecordAndTranscribe(ma_device& device) {
     return transcription;
 }
 
+// 有界队列：流水线阶段之间传递数据，队列满时阻塞上游（背压）
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity) {}
+    
+    // 放入数据，队列满时等待；队列已关闭返回 false
+    bool Push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+        if (closed_) {
+            return false;
+        }
+        items_.push_back(std::move(item));
+        notEmpty_.notify_one();
+        return true;
+    }
+    
+    // 取出数据，队列空时等待；队列关闭且已取空返回 false
+    bool Pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+        return TakeFront(item);
+    }
+    
+    // 最多等待 timeout，超时或队列关闭且已取空返回 false
+    bool PopFor(T& item, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait_for(lock, timeout, [this] { return closed_ || !items_.empty(); });
+        return TakeFront(item);
+    }
+    
+    // 关闭队列：不再接收新数据，已有数据仍可取出
+    void Close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        notFull_.notify_all();
+        notEmpty_.notify_all();
+    }
+    
+    bool Closed() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return closed_;
+    }
+    
+private:
+    bool TakeFront(T& item) {
+        if (items_.empty()) {
+            return false;
+        }
+        item = std::move(items_.front());
+        items_.pop_front();
+        notFull_.notify_one();
+        return true;
+    }
+    
+    size_t capacity_;
+    bool closed_ = false;
+    std::deque<T> items_;
+    std::mutex mutex_;
+    std::condition_variable notFull_;
+    std::condition_variable notEmpty_;
+};
+
+// 流水线中的一句话
+struct Utterance {
+    int index = 0;
+    std::vector<float> audio;
+    std::string text;
+    std::chrono::steady_clock::time_point submitTime;  // 用户提交（按回车）的时间
+};
+
+// 流水线阶段统计，只由该阶段自己的线程写入
+struct StageStats {
+    const char* name;
+    int items = 0;
+    double busyMs = 0.0;     // 处理数据的时间（采集阶段为提交的录音时长）
+    double blockedMs = 0.0;  // 下游队列满，等待的时间
+};
+
+static double MsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 输入行是否为退出命令（与命令循环一致，只看首字母）
+static bool IsQuitLine(const std::string& line) {
+    size_t first = line.find_first_not_of(" \t\r");
+    return first != std::string::npos && std::tolower(line[first]) == 'q';
+}
+
+static void PrintStage(const StageStats& stage, double wallMs) {
+    std::cout << "  " << stage.name << ": " << stage.items << " 项，利用率 "
+              << 100.0 * stage.busyMs / wallMs << "%，阻塞 "
+              << 100.0 * stage.blockedMs / wallMs << "%" << std::endl;
+}
+
+// 流水线模式：采集 → ASR → LLM 三个阶段各自一个线程，第 N 句的回复生成时
+// 可以继续录制和识别第 N+1 句
+void RunPipeline() {
+    {
+        std::lock_guard<std::mutex> lock(g_bufferMutex);
+        g_audioBuffer.clear();
+        g_audioBuffer.reserve(SAMPLE_RATE * RECORDING_SECONDS);
+    }
+    
+    bool replay = IsReplay();
+    if (replay) {
+        std::cout << "\n[流水线模式] 回放 " << g_sourceConfig.path << "，每 " << RECORDING_SECONDS
+                  << " 秒或文件结束时提交一句" << std::endl;
+    } else {
+        std::cout << "\n[流水线模式] 说完一句按回车提交，回复生成时可以继续说下一句" << std::endl;
+        std::cout << "每句最长 " << RECORDING_SECONDS << " 秒，输入 q 回车结束（未提交的录音将丢弃）" << std::endl;
+    }
+    std::cout << "========================================" << std::endl;
+    
+    g_recording = true;
+    if (!StartCapture()) {
+        g_recording = false;
+        std::cerr << "✗ 启动音频设备失败" << std::endl;
+        return;
+    }
+    
+    BoundedQueue<Utterance> audioQueue(PIPELINE_QUEUE_DEPTH);
+    BoundedQueue<Utterance> textQueue(PIPELINE_QUEUE_DEPTH);
+    StageStats captureStats{"采集"};
+    StageStats asrStats{"ASR"};
+    StageStats llmStats{"LLM"};
+    double latencyMsTotal = 0.0;
+    auto pipelineStart = std::chrono::steady_clock::now();
+    
+    // ASR 阶段
+    std::thread asrThread([&]() {
+        Utterance utterance;
+        while (audioQueue.Pop(utterance)) {
+            auto start = std::chrono::steady_clock::now();
+            utterance.text = TranscribeAudio(utterance.audio);
+            asrStats.busyMs += MsSince(start);
+            asrStats.items++;
+            std::vector<float>().swap(utterance.audio);  // 识别完即释放录音
+            
+            {
+                std::lock_guard<std::mutex> lock(g_consoleMutex);
+                if (utterance.text.empty()) {
+                    std::cout << "[#" << utterance.index << " 转录] (无结果)" << std::endl;
+                } else {
+                    std::cout << "[#" << utterance.index << " 转录] " << utterance.text << std::endl;
+                }
+            }
+            if (utterance.text.empty()) {
+                continue;
+            }
+            
+            auto pushStart = std::chrono::steady_clock::now();
+            if (!textQueue.Push(std::move(utterance))) {
+                break;
+            }
+            asrStats.blockedMs += MsSince(pushStart);
+        }
+        textQueue.Close();
+    });
+    
+    // LLM 阶段
+    std::thread llmThread([&]() {
+        Utterance utterance;
+        while (textQueue.Pop(utterance)) {
+            auto start = std::chrono::steady_clock::now();
+            std::string reply = ChatWithLLM(utterance.text, false);
+            llmStats.busyMs += MsSince(start);
+            llmStats.items++;
+            double latencyMs = MsSince(utterance.submitTime);
+            latencyMsTotal += latencyMs;
+            
+            std::lock_guard<std::mutex> lock(g_consoleMutex);
+            std::cout << "[#" << utterance.index << " 回复] " << reply << std::endl;
+            std::cout << "  (提交后 " << latencyMs / 1000.0 << " 秒完成)" << std::endl;
+        }
+    });
+    
+    // 控制台输入单独读取，采集阶段才能同时检查录音时长上限；回放时不读控制台
+    BoundedQueue<std::string> lines(8);
+    std::thread inputThread;
+    if (!replay) {
+        inputThread = std::thread([&lines]() {
+            std::string line;
+            while (std::getline(std::cin, line)) {
+                bool quit = IsQuitLine(line);
+                lines.Push(line);
+                if (quit) {
+                    break;
+                }
+            }
+            lines.Close();
+        });
+    }
+    
+    // 采集阶段（当前线程）
+    int nextIndex = 1;
+    bool quit = false;
+    while (!quit) {
+        std::string line;
+        bool submitted = lines.PopFor(line, std::chrono::milliseconds(100));
+        if (submitted) {
+            quit = IsQuitLine(line);
+        } else {
+            quit = lines.Closed();
+        }
+        
+        size_t buffered;
+        {
+            std::lock_guard<std::mutex> lock(g_bufferMutex);
+            buffered = g_audioBuffer.size();
+        }
+        bool full = buffered >= static_cast<size_t>(SAMPLE_RATE * RECORDING_SECONDS);
+        bool replayEnded = g_source->Finished();
+        if (quit || (!submitted && !full && !replayEnded)) {
+            continue;
+        }
+        quit = replayEnded;  // 回放结束：提交剩下的录音后退出
+        
+        Utterance utterance;
+        utterance.index = nextIndex;
+        utterance.submitTime = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(g_bufferMutex);
+            utterance.audio.swap(g_audioBuffer);
+            g_audioBuffer.reserve(SAMPLE_RATE * RECORDING_SECONDS);
+        }
+        if (utterance.audio.size() < MIN_UTTERANCE_SAMPLES) {
+            continue;
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(g_consoleMutex);
+            std::cout << "[#" << utterance.index << " 已提交] " << (float)utterance.audio.size() / SAMPLE_RATE << " 秒"
+                      << (full ? "（达到时长上限）" : "") << std::endl;
+        }
+        captureStats.busyMs += utterance.audio.size() * 1000.0 / SAMPLE_RATE;
+        captureStats.items++;
+        nextIndex++;
+        
+        auto pushStart = std::chrono::steady_clock::now();
+        audioQueue.Push(std::move(utterance));
+        captureStats.blockedMs += MsSince(pushStart);
+    }
+    
+    g_recording = false;
+    StopCapture();
+    if (inputThread.joinable()) {
+        inputThread.join();
+    }
+    
+    // 已提交的句子处理完再退出
+    audioQueue.Close();
+    asrThread.join();
+    llmThread.join();
+    
+    double wallMs = MsSince(pipelineStart);
+    std::cout << "========================================" << std::endl;
+    std::cout << "[流水线统计] 总时长 " << wallMs / 1000.0 << " 秒" << std::endl;
+    PrintStage(captureStats, wallMs);
+    PrintStage(asrStats, wallMs);
+    PrintStage(llmStats, wallMs);
+    if (llmStats.items > 0) {
+        std::cout << "  平均端到端延迟（提交 → 回复完成）: " << latencyMsTotal / llmStats.items / 1000.0 << " 秒" << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+// 批处理模式参数（--batch）
+struct BatchOptions {
+    std::string input;                               // WAV 目录、单个 WAV 或清单文件（每行一个路径）
+    std::string output = "batch_results.jsonl";
+    bool withLLM = false;                            // 每条转录再生成一次回复
+    int batchSize = 8;                               // 一次多流解码的文件数
+    uint32_t seed = 42;                              // 固定采样种子，结果可复现
+};
+
+// 批处理中一个文件的结果
+struct BatchItem {
+    std::string path;
+    std::vector<float> audio;
+    double durationSec = 0.0;
+    std::string text;
+    double asrMs = 0.0;    // 所在批次的解码耗时
+    std::string reply;
+    LlmStats llm;
+    std::string error;
+};
+
+static std::string JsonEscape(const std::string& text) {
+    std::string out;
+    for (unsigned char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += static_cast<char>(c);
+                }
+        }
+    }
+    return out;
+}
+
+// 一批文件一起送入识别器（多流解码）
+static void TranscribeBatch(std::vector<BatchItem>& items) {
+    std::vector<DesktopPet::AsrInput> inputs;
+    std::vector<BatchItem*> decoded;
+    for (BatchItem& item : items) {
+        if (!item.error.empty()) {
+            continue;
+        }
+        inputs.push_back({item.audio.data(), item.audio.size()});
+        decoded.push_back(&item);
+    }
+    if (inputs.empty()) {
+        return;
+    }
+    
+    // workers = 0：整批一次解码
+    std::vector<std::string> texts;
+    auto start = std::chrono::steady_clock::now();
+    bool ok = g_asr->Transcribe(inputs, texts, 0);
+    double ms = MsSince(start);
+    
+    for (size_t i = 0; i < decoded.size(); ++i) {
+        if (!ok) {
+            decoded[i]->error = "转录失败";
+            continue;
+        }
+        decoded[i]->text = texts[i];
+        decoded[i]->asrMs = ms;
+    }
+}
+
+static void WriteBatchItem(std::ofstream& out, const BatchItem& item, bool withLLM) {
+    out << "{\"file\":\"" << JsonEscape(item.path) << "\""
+        << ",\"duration_s\":" << item.durationSec
+        << ",\"text\":\"" << JsonEscape(item.text) << "\""
+        << ",\"asr_ms\":" << item.asrMs;
+    if (withLLM) {
+        out << ",\"reply\":\"" << JsonEscape(item.reply) << "\""
+            << ",\"prompt_tokens\":" << item.llm.promptTokens
+            << ",\"generated_tokens\":" << item.llm.generatedTokens
+            << ",\"prompt_ms\":" << item.llm.promptMs
+            << ",\"generate_ms\":" << item.llm.generateMs;
+    }
+    if (!item.error.empty()) {
+        out << ",\"error\":\"" << JsonEscape(item.error) << "\"";
+    }
+    out << "}\n";
+    out.flush();
+}
+
+// 批处理模式：不使用麦克风，转录（可选回复）一组 WAV 文件并报告吞吐与延迟
+int RunBatch(const BatchOptions& options) {
+    std::vector<std::string> files = DesktopPet::CollectWavFiles(options.input);
+    if (files.empty()) {
+        std::cerr << "✗ 未找到 WAV 文件: " << options.input << std::endl;
+        return 1;
+    }
+    std::ofstream out(options.output);
+    if (!out) {
+        std::cerr << "✗ 无法写入结果文件: " << options.output << std::endl;
+        return 1;
+    }
+    std::cout << "[批处理] " << files.size() << " 个文件，每批 " << options.batchSize
+              << " 个，结果写入 " << options.output << std::endl;
+    
+    double audioSec = 0.0;
+    double asrMsTotal = 0.0;
+    int generatedTokens = 0;
+    int promptTokens = 0;
+    double generateMsTotal = 0.0;
+    double promptMsTotal = 0.0;
+    int failed = 0;
+    std::vector<double> asrLatencies, llmLatencies, totalLatencies;
+    auto batchStart = std::chrono::steady_clock::now();
+    
+    for (size_t first = 0; first < files.size(); first += options.batchSize) {
+        size_t count = std::min(files.size() - first, static_cast<size_t>(options.batchSize));
+        std::vector<BatchItem> items(count);
+        for (size_t i = 0; i < count; ++i) {
+            items[i].path = files[first + i];
+            if (!DesktopPet::LoadWavMono(items[i].path, SAMPLE_RATE, items[i].audio) || items[i].audio.empty()) {
+                items[i].error = "无法读取音频";
+                continue;
+            }
+            items[i].durationSec = (double)items[i].audio.size() / SAMPLE_RATE;
+        }
+        
+        TranscribeBatch(items);
+        double batchMs = 0.0;  // 同一批次的文件共用一次解码
+        for (const BatchItem& item : items) {
+            if (item.error.empty()) {
+                audioSec += item.durationSec;
+                asrLatencies.push_back(item.asrMs);
+                batchMs = item.asrMs;
+            }
+        }
+        asrMsTotal += batchMs;
+        
+        for (BatchItem& item : items) {
+            std::vector<float>().swap(item.audio);
+            if (!item.error.empty()) {
+                failed++;
+            } else if (options.withLLM && !item.text.empty()) {
+                // 每个文件独立对话，不受前一个文件影响
+                g_dialog_history.clear();
+                item.reply = ChatWithLLM(item.text, false, options.seed, &item.llm);
+                double llmMs = item.llm.promptMs + item.llm.generateMs;
+                llmLatencies.push_back(llmMs);
+                totalLatencies.push_back(item.asrMs + llmMs);
+                promptTokens += item.llm.promptTokens;
+                generatedTokens += item.llm.generatedTokens;
+                promptMsTotal += item.llm.promptMs;
+                generateMsTotal += item.llm.generateMs;
+            }
+            WriteBatchItem(out, item, options.withLLM);
+            if (g_debugMode || !item.error.empty()) {
+                std::cout << "  " << item.path << ": " << (item.error.empty() ? item.text : item.error) << std::endl;
+            }
+        }
+        std::cout << "[批处理] " << first + count << "/" << files.size() << std::endl;
+    }
+    g_dialog_history.clear();
+    
+    double wallSec = MsSince(batchStart) / 1000.0;
+    std::cout << "========================================" << std::endl;
+    std::cout << "[批处理统计] " << files.size() - failed << " 个文件成功，" << failed << " 个失败，音频 "
+              << audioSec << " 秒，总耗时 " << wallSec << " 秒" << std::endl;
+    if (audioSec > 0.0) {
+        std::cout << "  ASR: RTF " << asrMsTotal / 1000.0 / audioSec << "，延迟 p50 " << DesktopPet::Percentile(asrLatencies, 0.5)
+                  << " ms / p95 " << DesktopPet::Percentile(asrLatencies, 0.95) << " ms（批次解码耗时）" << std::endl;
+    }
+    if (!llmLatencies.empty()) {
+        std::cout << "  LLM: prefill " << promptTokens * 1000.0 / std::max(promptMsTotal, 1e-3) << " tokens/s，生成 "
+                  << generatedTokens * 1000.0 / std::max(generateMsTotal, 1e-3) << " tokens/s" << std::endl;
+        std::cout << "  LLM 延迟 p50 " << DesktopPet::Percentile(llmLatencies, 0.5) << " ms / p95 "
+                  << DesktopPet::Percentile(llmLatencies, 0.95)
+                  << " ms，转录+回复 p50 " << DesktopPet::Percentile(totalLatencies, 0.5) << " ms / p95 "
+                  << DesktopPet::Percentile(totalLatencies, 0.95) << " ms" << std::endl;
+    }
+    return failed == 0 ? 0 : 1;
+}
+
 int main(int argc, char* argv[]) {
     // 设置控制台为 UTF-8 编码，解决中文乱码问题
 #ifdef _WIN32
@@ -489,33 +991,90 @@ int main(int argc, char* argv[]) {
     
     // 解析命令行参数
     std::string modelDir = "F:/ollama/model/SenseVoidSmall-onnx-official";
+    std::string asrConfigPath;
+    std::string asrBackend;
+    std::string llmModelPath = "F:/ollama/model/qwen2.5_7b_q4k/qwen2.5-7b-instruct-q4_k_m-00001-of-00002.gguf";
+    BatchOptions batch;
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
         if (arg == "--debug" || arg == "-d") {
             g_debugMode = true;
+        } else if (arg == "--batch" && hasValue) {
+            // 批处理：--batch <WAV目录|清单> [--out 结果.jsonl] [--llm] [--batch-size N] [--seed N]
+            batch.input = argv[++i];
+        } else if (arg == "--out" && hasValue) {
+            batch.output = argv[++i];
+        } else if (arg == "--llm") {
+            batch.withLLM = true;
+        } else if (arg == "--batch-size" && hasValue) {
+            batch.batchSize = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--seed" && hasValue) {
+            batch.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--llm-model" && hasValue) {
+            llmModelPath = argv[++i];
+        } else if (arg == "--replay" && hasValue) {
+            // 代替麦克风：--replay <会话.wav|null>
+            g_sourceConfig = DesktopPet::ParseAudioSource(argv[++i]);
+        } else if (arg == "--asr-config" && hasValue) {
+            // 识别后端配置：--asr-config <asr.ini> [--asr-backend <节名>]
+            asrConfigPath = argv[++i];
+        } else if (arg == "--asr-backend" && hasValue) {
+            asrBackend = argv[++i];
         } else {
             // 第一个非选项参数作为模型路径
             modelDir = arg;
         }
     }
     
+    // 没有配置文件时使用 SenseVoice + 模型路径
+    DesktopPet::AsrConfig asrConfig;
+    asrConfig.modelDir = modelDir;
+    if (!asrConfigPath.empty()) {
+        DesktopPet::AsrConfigFile asrFile;
+        if (!DesktopPet::LoadAsrConfigFile(asrConfigPath, asrFile)) {
+            return 1;
+        }
+        const DesktopPet::AsrConfig* selected = asrBackend.empty() ? asrFile.Active() : asrFile.Find(asrBackend);
+        if (!selected) {
+            std::cerr << "配置中没有识别后端: " << asrBackend << std::endl;
+            return 1;
+        }
+        asrConfig = *selected;
+    }
+    
     std::cout << "=== Windows 音频采集与转录 Demo ===" << std::endl;
     std::cout << "基于 miniaudio + sherpa-onnx + llama.cpp" << std::endl;
-    std::cout << "模型路径: " << modelDir << std::endl;
+    std::cout << "识别后端: " << asrConfig.name << std::endl;
+    std::cout << "模型路径: " << asrConfig.modelDir << std::endl;
     std::cout << "调试模式: " << (g_debugMode ? "开启" : "关闭") << std::endl;
     std::cout << std::endl;
     
     // 启动时预加载ASR模型
     std::cout << "正在加载ASR模型..." << std::endl;
-    if (!InitializeRecognizer(modelDir)) {
+    if (!InitializeRecognizer(asrConfig)) {
         std::cerr << "ASR模型加载失败，程序退出！" << std::endl;
         return 1;
     }
     std::cout << "ASR模型加载成功！" << std::endl;
     std::cout << std::endl;
     
+    // 批处理模式不需要麦克风，LLM 只在 --llm 时加载
+    if (!batch.input.empty()) {
+        if (batch.withLLM && !InitializeLLM(llmModelPath)) {
+            std::cerr << "LLM模型加载失败，程序退出！" << std::endl;
+            CleanupRecognizer();
+            return 1;
+        }
+        int result = RunBatch(batch);
+        CleanupRecognizer();
+        if (batch.withLLM) {
+            CleanupLLM();
+        }
+        return result;
+    }
+    
     // 初始化 LLM
-    std::string llmModelPath = "F:/ollama/model/qwen2.5_7b_q4k/qwen2.5-7b-instruct-q4_k_m-00001-of-00002.gguf";
     std::cout << "正在加载LLM模型..." << std::endl;
     if (!InitializeLLM(llmModelPath)) {
         std::cerr << "LLM模型加载失败，程序退出！" << std::endl;
@@ -524,37 +1083,27 @@ int main(int argc, char* argv[]) {
     }
     std::cout << std::endl;
     
-    // 初始化音频设备
-    ma_device_config deviceConfig;
-    ma_device device;
-    
-    deviceConfig = ma_device_config_init(ma_device_type_capture);
-    deviceConfig.capture.format = ma_format_f32;
-    deviceConfig.capture.channels = CHANNELS;
-    deviceConfig.sampleRate = SAMPLE_RATE;
-    deviceConfig.dataCallback = audio_callback;
-    deviceConfig.pUserData = nullptr;
-    
+    // 初始化采集输入（回放和静音输入不需要声卡）
     if (g_debugMode) {
-        std::cout << "正在初始化音频设备..." << std::endl;
+        std::cout << "正在初始化音频输入..." << std::endl;
     }
-    if (ma_device_init(NULL, &deviceConfig, &device) != MA_SUCCESS) {
-        std::cerr << "音频设备初始化失败！" << std::endl;
+    if (!OpenCapture()) {
+        std::cerr << "音频输入初始化失败！" << std::endl;
         CleanupRecognizer();
+        CleanupLLM();
         return 1;
     }
-    
+    std::cout << "音频输入: " << g_source->Describe() << std::endl;
     if (g_debugMode) {
-        std::cout << "音频设备初始化成功！" << std::endl;
-        std::cout << "设备名称: " << device.capture.name << std::endl;
-        std::cout << "采样率: " << SAMPLE_RATE << " Hz" << std::endl;
-        std::cout << "声道数: " << CHANNELS << std::endl;
+        std::cout << "采样率: " << g_source->SampleRate() << " Hz" << std::endl;
+        std::cout << "声道数: " << g_source->Channels() << std::endl;
         std::cout << std::endl;
     }
     
     // 显示帮助信息
     std::cout << "命令列表:" << std::endl;
     std::cout << "  t - 开始录音并转录 (录音 " << RECORDING_SECONDS << " 秒)" << std::endl;
+    std::cout << "  p - 流水线模式 (回复生成时可以继续说下一句)" << std::endl;
     std::cout << "  h - 显示帮助信息" << std::endl;
     std::cout << "  q - 退出程序" << std::endl;
     std::cout << std::endl;
@@ -562,7 +1111,7 @@ int main(int argc, char* argv[]) {
     // 命令循环
     bool running = true;
     while (running) {
-        std::cout << "请输入命令 (t/h/q): ";
+        std::cout << "请输入命令 (t/p/h/q): ";
         std::string command;
         std::getline(std::cin, command);
         
@@ -579,7 +1128,7 @@ int main(int argc, char* argv[]) {
         switch (cmd) {
             case 't': {
                 // 执行录音和转录
-                std::string result = RecordAndTranscribe(device);
+                std::string result = RecordAndTranscribe();
                 if (!result.empty()) {
                     std::cout << "\n转录结果:" << std::endl;
                     std::cout << "========================================" << std::endl;
@@ -598,10 +1147,17 @@ int main(int argc, char* argv[]) {
                 break;
             }
             
+            case 'p': {
+                // 流水线模式：采集/ASR 与 LLM 生成重叠
+                RunPipeline();
+                break;
+            }
+            
             case 'h': {
                 // 显示帮助
                 std::cout << "\n命令列表:" << std::endl;
                 std::cout << "  t - 开始录音并转录 (录音 " << RECORDING_SECONDS << " 秒)" << std::endl;
+                std::cout << "  p - 流水线模式 (回复生成时可以继续说下一句)" << std::endl;
                 std::cout << "  h - 显示帮助信息" << std::endl;
                 std::cout << "  q - 退出程序" << std::endl;
                 std::cout << std::endl;
@@ -625,7 +1181,7 @@ int main(int argc, char* argv[]) {
     }
     
     // 清理资源
-    ma_device_uninit(&device);
+    g_source.reset();
     CleanupRecognizer();
     CleanupLLM();
     